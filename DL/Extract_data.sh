@@ -13,8 +13,8 @@ VID="BlowingBubbles"
 
 for qp in "${QPs[@]}";
 do
-    echo | ../bin/TAppEncoderStatic -c ../cfg/encoder_lowdelay_P_main.cfg -c ../cfg/per-sequence/$VID.cfg -q $qp
+    echo | ../bin/TAppEncoderStatic -c ../cfg/encoder_lowdelay_P_main.cfg -c ../cfg/per-sequence/$VID.cfg -q $qp --WriteReconFile=0
     mv SSE.csv SSE_$qp.csv
 done
 
-rm rec.yuv str.bin
+rm str.bin
@@ -91,6 +91,7 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
 #endif
   ("OutputDecodedSEIMessagesFilename",  m_outputDecodedSEIMessagesFilename,    string(""), "When non empty, output decoded SEI messages to the indicated file. If file is '-', then output to stdout\n")
   ("ClipOutputVideoToRec709Range",      m_bClipOutputVideoToRec709Range,  false, "If true then clip output video to the Rec. 709 Range on saving")
+  ("NumThreads",                m_iNumThreads,                         1,          "Number of threads of the in-loop filters (1: serial)")
   ;
 
   po::setDefaults(opts);
@@ -130,6 +131,12 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
     return false;
   }
 
+  if (m_iNumThreads < 1)
+  {
+    fprintf(stderr, "NumThreads must be at least 1\n");
+    return false;
+  }
+
   if ( !cfg_TargetDecLayerIdSetFile.empty() )
   {
     FILE* targetDecLayerIdSetFile = fopen ( cfg_TargetDecLayerIdSetFile.c_str(), "r" );
@@ -609,6 +609,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   Int tmpConstraintChromaFormat;
   Int tmpWeightedPredictionMethod;
   Int tmpFastInterSearchMode;
+  Int tmpZeroBlockDetection;
   Int tmpMotionEstimationSearchMethod;
   Int tmpSliceMode;
   Int tmpSliceSegmentMode;
@@ -663,6 +664,8 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("InputFile,i",                                     m_inputFileName,                             string(""), "Original YUV input file name")
   ("BitstreamFile,b",                                 m_bitstreamFileName,                         string(""), "Bitstream output file name")
   ("ReconFile,o",                                     m_reconFileName,                             string(""), "Reconstructed YUV output file name")
+  ("WriteReconFile",                                  m_bWriteReconFile,                                 true, "0: do not write the reconstructed YUV file, even if ReconFile is set")
+  ("OutputQueueDepth",                                m_iOutputQueueDepth,                                  2, "Number of encoded picture groups queued for writing on a writer thread (0: write right after encoding)")
   ("SourceWidth,-wdt",                                m_iSourceWidth,                                       0, "Source picture width")
   ("SourceHeight,-hgt",                               m_iSourceHeight,                                      0, "Source picture height")
   ("InputBitDepth",                                   m_inputBitDepth[CHANNEL_TYPE_LUMA],                   8, "Bit-depth of input file")
@@ -700,6 +703,9 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("FrameRate,-fr",                                   m_iFrameRate,                                         0, "Frame rate")
   ("FrameSkip,-fs",                                   m_FrameSkip,                                         0u, "Number of frames to skip at start of input YUV")
   ("TemporalSubsampleRatio,-ts",                      m_temporalSubsampleRatio,                            1u, "Temporal sub-sample ratio when reading input YUV")
+  ("InputPrefetchDepth",                              m_iInputPrefetchDepth,                                2, "Number of input frames read ahead on a reader thread while encoding (0: read every frame right before it is encoded)")
+  ("InputMemoryMap",                                  m_bInputMemoryMap,                                 true, "Memory-map the input file and read the frames in place when it is a regular file (0: always read through a file stream)")
+  ("InputStreaming",                                  m_bInputStreaming,                                false, "Read the input forward-only, as from a pipe, and take SourceWidth, SourceHeight, FrameRate, InputChromaFormat and InputBitDepth from a Y4M stream header (implied by InputFile - (stdin) and .y4m files)")
   ("FramesToBeEncoded,f",                             m_framesToBeEncoded,                                  0, "Number of frames to be encoded (default=all)")
   ("ClipInputVideoToRec709Range",                     m_bClipInputVideoToRec709Range,                   false, "If true then clip input video to the Rec. 709 Range on loading when InternalBitDepth is less than MSBExtendedBitDepth")
   ("ClipOutputVideoToRec709Range",                    m_bClipOutputVideoToRec709Range,                  false, "If true then clip output video to the Rec. 709 Range on saving when OutputBitDepth is less than InternalBitDepth")
@@ -756,6 +762,10 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("RestrictMESampling",                              m_bRestrictMESampling,                            false, "Restrict ME Sampling for selective inter motion search")
   ("ClipForBiPredMEEnabled",                          m_bClipForBiPredMeEnabled,                        false, "Enables clipping in the Bi-Pred ME. It is disabled to reduce encoder run-time")
   ("FastMEAssumingSmootherMVEnabled",                 m_bFastMEAssumingSmootherMVEnabled,                true, "Enables fast ME assuming a smoother MV.")
+  ("SEA",                                             m_bUseSEA,                                         true, "Successive elimination in the full-search integer motion estimation (FastSearch=0), same result as the exhaustive search")
+  ("NumMEThreads",                                    m_iNumMEThreads,                                      1, "Number of threads running the uni-directional motion searches of a PU over its reference pictures (1: serial)")
+  ("SADTreeME",                                       m_bUseSADTreeME,                                  false, "Reuse the sub-block distortions of the 2Nx2N integer motion search for the other partition shapes of the CU")
+  ("PyramidME",                                       m_bUsePyramidME,                                  false, "Seed the TZ integer motion search with a 1/2 and 1/4 resolution motion pre-analysis and skip its raster search")
 
   ("HadamardME",                                      m_bUseHADME,                                       true, "Hadamard ME for fractional-pel")
   ("ASR",                                             m_bUseASR,                                        false, "Adaptive motion search range");
@@ -799,6 +809,9 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
 #if T0196_SELECTIVE_RDOQ
   ("SelectiveRDOQ",                                   m_useSelectiveRDOQ,                               false, "Enable selective RDOQ")
 #endif
+  ("FastRDOQ",                                        m_useFastRDOQ,                                    false, "Use the table-driven RDOQ, which skips all-zero coefficient groups and reuses level rates (decisions match the default RDOQ up to floating-point accumulation order)")
+  ("ZeroBlockDetection",                              tmpZeroBlockDetection,   Int(ZERO_BLOCK_DETECTION_OFF), "Skip transform and quantisation of inter residual TUs detected as all-zero. 0:off 1:conservative (bit-exact) 2:aggressive")
+  ("InterResidualCache",                              m_useInterResidualCache,                          false, "Reuse the residual quadtree decision when a CU is tested again with an identical inter residual (same result)")
   ("RDpenalty",                                       m_rdPenalty,                                          0,  "RD-penalty for 32x32 TU for intra in non-intra slices. 0:disabled  1:RD-penalty  2:maximum RD-penalty")
 
   // Deblocking filter parameters
@@ -873,7 +886,11 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("TileColumnWidthArray",                            cfg_ColumnWidth,                        cfg_ColumnWidth, "Array containing tile column width values in units of CTU")
   ("TileRowHeightArray",                              cfg_RowHeight,                            cfg_RowHeight, "Array containing tile row height values in units of CTU")
   ("LFCrossTileBoundaryFlag",                         m_bLFCrossTileBoundaryFlag,                        true, "1: cross-tile-boundary loop filtering. 0:non-cross-tile-boundary loop filtering")
+  ("NumTileThreads",                                  m_iNumTileThreads,                                    1, "Number of threads compressing the tiles of a slice in parallel (1: serial)")
+  ("NumFrameThreads",                                 m_iNumFrameThreads,                                   1, "Number of pictures of a GOP that are compressed in parallel when they do not reference each other (1: serial)")
+  ("NumThreads",                                      m_iNumThreads,                                        0, "Number of threads of the encoder thread pool, shared by the wavefront, tile, frame-parallel and motion estimation jobs (0: the largest of NumWppThreads, NumTileThreads, NumFrameThreads and NumMEThreads)")
   ("WaveFrontSynchro",                                m_entropyCodingSyncEnabledFlag,                   false, "0: entropy coding sync disabled; 1 entropy coding sync enabled")
+  ("NumWppThreads",                                   m_iNumWppThreads,                                     1, "Number of threads compressing the CTU rows of a slice in wavefront order when WaveFrontSynchro is enabled (1: serial)")
   ("ScalingList",                                     m_useScalingListId,                    SCALING_LIST_OFF, "0/off: no scaling list, 1/default: default scaling lists, 2/file: scaling lists specified in ScalingListFile")
   ("ScalingListFile",                                 m_scalingListFileName,                       string(""), "Scaling list file name. Use an empty string to produce help.")
   ("SignHideFlag,-SBH",                               m_signHideFlag,                                    true)
@@ -1086,11 +1103,41 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
     }
   }
 
+  /*
+   * Open a streamed input, whose Y4M stream header overrides the source parameters
+   */
+  const std::string y4mExtension = ".y4m";
+  if ( m_inputFileName == "-" || ( m_inputFileName.size() > y4mExtension.size() && m_inputFileName.compare( m_inputFileName.size() - y4mExtension.size(), y4mExtension.size(), y4mExtension ) == 0 ) )
+  {
+    m_bInputStreaming = true;
+  }
+  if ( m_bInputStreaming )
+  {
+    TVideoIOY4MInfo y4mInfo;
+    if ( m_cTVideoIOYuvInputFile.openStreaming( m_inputFileName, y4mInfo ) )
+    {
+      static const Int chromaFormatNumber[NUM_CHROMA_FORMAT] = { 400, 420, 422, 444 };
+      m_iSourceWidth                       = y4mInfo.width;
+      m_iSourceHeight                      = y4mInfo.height;
+      tmpInputChromaFormat                 = chromaFormatNumber[y4mInfo.chromaFormat];
+      m_inputBitDepth[CHANNEL_TYPE_LUMA  ] = y4mInfo.bitDepth;
+      m_inputBitDepth[CHANNEL_TYPE_CHROMA] = y4mInfo.bitDepth;
+      if ( y4mInfo.frameRateNum > 0 )
+      {
+        m_iFrameRate = ( y4mInfo.frameRateNum + y4mInfo.frameRateDen / 2 ) / y4mInfo.frameRateDen;
+      }
+    }
+  }
+
   /*
    * Set any derived parameters
    */
 
   m_framesToBeEncoded = ( m_framesToBeEncoded + m_temporalSubsampleRatio - 1 ) / m_temporalSubsampleRatio;
+  if (!m_bWriteReconFile)
+  {
+    m_reconFileName.clear();
+  }
   m_adIntraLambdaModifier = cfg_adIntraLambdaModifier.values;
   if(m_isField)
   {
@@ -1201,6 +1248,13 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   }
   m_fastInterSearchMode = FastInterSearchMode(tmpFastInterSearchMode);
 
+  assert(tmpZeroBlockDetection>=0 && tmpZeroBlockDetection<NUMBER_OF_ZERO_BLOCK_DETECTION_MODES);
+  if (tmpZeroBlockDetection<0 || tmpZeroBlockDetection>=NUMBER_OF_ZERO_BLOCK_DETECTION_MODES)
+  {
+    exit(EXIT_FAILURE);
+  }
+  m_zeroBlockDetection = ZeroBlockDetectionMode(tmpZeroBlockDetection);
+
   assert(tmpMotionEstimationSearchMethod>=0 && tmpMotionEstimationSearchMethod<MESEARCH_NUMBER_OF_METHODS);
   if (tmpMotionEstimationSearchMethod<0 || tmpMotionEstimationSearchMethod>=MESEARCH_NUMBER_OF_METHODS)
   {
@@ -1529,6 +1583,11 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
     }
   }
 
+  if ( m_iNumThreads == 0 )
+  {
+    m_iNumThreads = std::max( std::max( m_iNumWppThreads, m_iNumTileThreads ), std::max( m_iNumFrameThreads, m_iNumMEThreads ) );
+  }
+
   // check validity of input parameters
   xCheckParameter();
 
@@ -1683,6 +1742,8 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_InputChromaFormatIDC >= NUM_CHROMA_FORMAT,                                "InputChromaFormatIDC must be either 400, 420, 422 or 444" );
   xConfirmPara( m_iFrameRate <= 0,                                                          "Frame rate must be more than 1" );
   xConfirmPara( m_temporalSubsampleRatio < 1,                                               "Temporal subsample rate must be no less than 1" );
+  xConfirmPara( m_iInputPrefetchDepth < 0,                                                  "InputPrefetchDepth must not be negative" );
+  xConfirmPara( m_iOutputQueueDepth < 0,                                                    "OutputQueueDepth must not be negative" );
   xConfirmPara( m_framesToBeEncoded <= 0,                                                   "Total Number Of Frames encoded must be more than 0" );
   xConfirmPara( m_iGOPSize < 1 ,                                                            "GOP Size must be greater or equal to 1" );
   xConfirmPara( m_iGOPSize > 1 &&  m_iGOPSize % 2,                                          "GOP Size must be a multiple of 2, if GOP Size is greater than 1" );
@@ -1742,6 +1803,11 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_loopFilterBetaOffsetDiv2 < -6 || m_loopFilterBetaOffsetDiv2 > 6,        "Loop Filter Beta Offset div. 2 exceeds supported range (-6 to 6)");
   xConfirmPara( m_loopFilterTcOffsetDiv2 < -6 || m_loopFilterTcOffsetDiv2 > 6,            "Loop Filter Tc Offset div. 2 exceeds supported range (-6 to 6)");
   xConfirmPara( m_iSearchRange < 0 ,                                                        "Search Range must be more than 0" );
+  xConfirmPara( m_iNumMEThreads < 1 ,                                                       "NumMEThreads must be at least 1" );
+  xConfirmPara( m_iNumWppThreads < 1 ,                                                      "NumWppThreads must be at least 1" );
+  xConfirmPara( m_iNumTileThreads < 1 ,                                                     "NumTileThreads must be at least 1" );
+  xConfirmPara( m_iNumFrameThreads < 1 ,                                                    "NumFrameThreads must be at least 1" );
+  xConfirmPara( m_iNumThreads < 1 ,                                                         "NumThreads must be at least 1" );
   xConfirmPara( m_bipredSearchRange < 0 ,                                                   "Bi-prediction refinement search range must be more than 0" );
   xConfirmPara( m_minSearchWindow < 0,                                                      "Minimum motion search window size for the adaptive window ME must be greater than or equal to 0" );
   xConfirmPara( m_iMaxDeltaQP > 7,                                                          "Absolute Delta QP exceeds supported range (0 to 7)" );
@@ -2502,11 +2568,18 @@ Void TAppEncCfg::xPrintParameter()
   printf("HAD:%d ", m_bUseHADME                          );
   printf("RDQ:%d ", m_useRDOQ                            );
   printf("RDQTS:%d ", m_useRDOQTS                        );
+  printf("FastRDQ:%d ", m_useFastRDOQ                    );
+  printf("ZBD:%d ", m_zeroBlockDetection                 );
+  printf("IRC:%d ", m_useInterResidualCache              );
   printf("RDpenalty:%d ", m_rdPenalty                    );
   printf("SQP:%d ", m_uiDeltaQpRD                        );
   printf("ASR:%d ", m_bUseASR                            );
   printf("MinSearchWindow:%d ", m_minSearchWindow        );
   printf("RestrictMESampling:%d ", m_bRestrictMESampling );
+  printf("PyramidME:%d ", m_bUsePyramidME                );
+  printf("SADTreeME:%d ", m_bUseSADTreeME                );
+  printf("NumMEThreads:%d ", m_iNumMEThreads             );
+  printf("SEA:%d ", m_bUseSEA                            );
   printf("FEN:%d ", Int(m_fastInterSearchMode)           );
   printf("ECU:%d ", m_bUseEarlyCU                        );
   printf("FDM:%d ", m_useFastDecisionForMerge            );
@@ -2544,6 +2617,10 @@ Void TAppEncCfg::xPrintParameter()
   printf("PME:%d ", m_log2ParallelMergeLevel);
   const Int iWaveFrontSubstreams = m_entropyCodingSyncEnabledFlag ? (m_iSourceHeight + m_uiMaxCUHeight - 1) / m_uiMaxCUHeight : 1;
   printf(" WaveFrontSynchro:%d WaveFrontSubstreams:%d", m_entropyCodingSyncEnabledFlag?1:0, iWaveFrontSubstreams);
+  printf(" NumWppThreads:%d", m_iNumWppThreads);
+  printf(" NumTileThreads:%d", m_iNumTileThreads);
+  printf(" NumFrameThreads:%d", m_iNumFrameThreads);
+  printf(" NumThreads:%d", m_iNumThreads);
   printf(" ScalingList:%d ", m_useScalingListId );
   printf("TMVPMode:%d ", m_TMVPModeId     );
 #if ADAPTIVE_QP_SELECTION
@@ -41,6 +41,7 @@
 #include "TLibCommon/CommonDef.h"
 
 #include "TLibEncoder/TEncCfg.h"
+#include "TLibVideoIO/TVideoIOYuv.h"
 #include <sstream>
 #include <vector>
 //! \ingroup TAppEncoder
@@ -58,6 +59,9 @@ protected:
   std::string m_inputFileName;                                ///< source file name
   std::string m_bitstreamFileName;                            ///< output bitstream file
   std::string m_reconFileName;                                ///< output reconstruction file
+  Bool      m_bWriteReconFile;                                ///< write the reconstruction file (cleared: ReconFile is ignored)
+  Int       m_iOutputQueueDepth;                              ///< number of encode outputs queued for the writer thread
+  TVideoIOYuv m_cTVideoIOYuvInputFile;                        ///< input YUV file, opened while parsing the configuration when it is streamed
 
   // Lambda modifiers
   Double    m_adLambdaModifier[ MAX_TLAYER ];                 ///< Lambda modifier array for each temporal layer
@@ -68,6 +72,9 @@ protected:
   Int       m_iFrameRate;                                     ///< source frame-rates (Hz)
   UInt      m_FrameSkip;                                      ///< number of skipped frames from the beginning
   UInt      m_temporalSubsampleRatio;                         ///< temporal subsample ratio, 2 means code every two frames
+  Int       m_iInputPrefetchDepth;                            ///< number of input frames read ahead by the reader thread
+  Bool      m_bInputMemoryMap;                                ///< memory-map the input file when it is a regular file
+  Bool      m_bInputStreaming;                                ///< read the input forward-only from a pipe or stdin, taking its format from a Y4M stream header
   Int       m_iSourceWidth;                                   ///< source width in pixel
   Int       m_iSourceHeight;                                  ///< source height in pixel (when interlaced = field height)
 
@@ -224,6 +231,9 @@ protected:
 #if T0196_SELECTIVE_RDOQ
   Bool      m_useSelectiveRDOQ;                               ///< flag for using selective RDOQ
 #endif
+  Bool      m_useFastRDOQ;                                    ///< flag for using the table-driven RDOQ
+  ZeroBlockDetectionMode m_zeroBlockDetection;                ///< early detection of all-zero inter residual TUs
+  Bool      m_useInterResidualCache;                          ///< reuse the residual quadtree decision of identical inter residuals of a CU
   Int       m_rdPenalty;                                      ///< RD-penalty for 32x32 TU for intra in non-intra slices (0: no RD-penalty, 1: RD-penalty, 2: maximum RD-penalty)
   Bool      m_bDisableIntraPUsInInterSlices;                  ///< Flag for disabling intra predicted PUs in inter slices.
   MESearchMethod m_motionEstimationSearchMethod;
@@ -233,6 +243,10 @@ protected:
   Int       m_minSearchWindow;                                ///< ME minimum search window size for the Adaptive Window ME
   Bool      m_bClipForBiPredMeEnabled;                        ///< Enables clipping for Bi-Pred ME.
   Bool      m_bFastMEAssumingSmootherMVEnabled;               ///< Enables fast ME assuming a smoother MV.
+  Bool      m_bUsePyramidME;                                  ///< Seed the integer ME with a hierarchical motion pre-analysis
+  Bool      m_bUseSADTreeME;                                  ///< Reuse the 2Nx2N sub-block distortions in the integer ME of the other partition shapes
+  Int       m_iNumMEThreads;                                  ///< Number of threads for the per-reference motion searches of a PU
+  Bool      m_bUseSEA;                                        ///< Successive elimination in the full-search integer ME
   FastInterSearchMode m_fastInterSearchMode;                  ///< Parameter that controls fast encoder settings
   Bool      m_bUseEarlyCU;                                    ///< flag for using Early CU setting
   Bool      m_useFastDecisionForMerge;                        ///< flag for using Fast Decision Merge RD-Cost
@@ -251,6 +265,10 @@ protected:
   std::vector<Int> m_tileColumnWidth;
   std::vector<Int> m_tileRowHeight;
   Bool      m_entropyCodingSyncEnabledFlag;
+  Int       m_iNumWppThreads;                                 ///< Number of threads for the wavefront CTU-row compression
+  Int       m_iNumTileThreads;                                ///< Number of threads for the tile-parallel compression
+  Int       m_iNumFrameThreads;                               ///< Number of pictures compressed in parallel
+  Int       m_iNumThreads;                                    ///< Number of threads of the encoder thread pool
 
   Bool      m_bUseConstrainedIntraPred;                       ///< flag for using constrained intra prediction
   Bool      m_bFastUDIUseMPMEnabled;
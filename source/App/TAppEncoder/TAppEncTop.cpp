@@ -42,6 +42,7 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <iomanip>
+#include <functional>
 
 #include "TAppEncTop.h"
 #include "TLibEncoder/AnnexBwrite.h"
@@ -60,6 +61,7 @@ TAppEncTop::TAppEncTop()
   m_iFrameRcvd = 0;
   m_totalBytes = 0;
   m_essentialBytes = 0;
+  m_bOutputDone = false;
 }
 
 TAppEncTop::~TAppEncTop()
@@ -157,6 +159,10 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setFastMEAssumingSmootherMVEnabled                   ( m_bFastMEAssumingSmootherMVEnabled );
   m_cTEncTop.setMinSearchWindow                                   ( m_minSearchWindow );
   m_cTEncTop.setRestrictMESampling                                ( m_bRestrictMESampling );
+  m_cTEncTop.setUsePyramidME                                      ( m_bUsePyramidME );
+  m_cTEncTop.setUseSADTreeME                                      ( m_bUseSADTreeME );
+  m_cTEncTop.setNumMEThreads                                      ( m_iNumMEThreads );
+  m_cTEncTop.setUseSEA                                            ( m_bUseSEA );
 
   //====== Quality control ========
   m_cTEncTop.setMaxDeltaQP                                        ( m_iMaxDeltaQP  );
@@ -191,6 +197,9 @@ Void TAppEncTop::xInitLibCfg()
 #if T0196_SELECTIVE_RDOQ
   m_cTEncTop.setUseSelectiveRDOQ                                  ( m_useSelectiveRDOQ );
 #endif
+  m_cTEncTop.setUseFastRDOQ                                       ( m_useFastRDOQ );
+  m_cTEncTop.setZeroBlockDetection                                ( m_zeroBlockDetection );
+  m_cTEncTop.setUseInterResidualCache                             ( m_useInterResidualCache );
   m_cTEncTop.setRDpenalty                                         ( m_rdPenalty );
   m_cTEncTop.setMaxCUWidth                                        ( m_uiMaxCUWidth );
   m_cTEncTop.setMaxCUHeight                                       ( m_uiMaxCUHeight );
@@ -363,6 +372,10 @@ Void TAppEncTop::xInitLibCfg()
   }
   m_cTEncTop.setLFCrossTileBoundaryFlag                           ( m_bLFCrossTileBoundaryFlag );
   m_cTEncTop.setEntropyCodingSyncEnabledFlag                      ( m_entropyCodingSyncEnabledFlag );
+  m_cTEncTop.setNumWppThreads                                     ( m_iNumWppThreads );
+  m_cTEncTop.setNumTileThreads                                    ( m_iNumTileThreads );
+  m_cTEncTop.setNumFrameThreads                                   ( m_iNumFrameThreads );
+  m_cTEncTop.setNumThreads                                        ( m_iNumThreads );
   m_cTEncTop.setTMVPModeId                                        ( m_TMVPModeId );
   m_cTEncTop.setUseScalingListId                                  ( m_useScalingListId  );
   m_cTEncTop.setScalingListFileName                               ( m_scalingListFileName );
@@ -426,7 +439,7 @@ Void TAppEncTop::xInitLibCfg()
 Void TAppEncTop::xCreateLib()
 {
   // Video I/O
-  m_cTVideoIOYuvInputFile.open( m_inputFileName,     false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth );  // read  mode
+  m_cTVideoIOYuvInputFile.open( m_inputFileName,     false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth, m_bInputMemoryMap );  // read  mode
   m_cTVideoIOYuvInputFile.skipFrames(m_FrameSkip, m_iSourceWidth - m_aiPad[0], m_iSourceHeight - m_aiPad[1], m_InputChromaFormatIDC);
 
   if (!m_reconFileName.empty())
@@ -474,7 +487,8 @@ Void TAppEncTop::encode()
     exit(EXIT_FAILURE);
   }
 
-  TComPicYuv*       pcPicYuvOrg = new TComPicYuv;
+  TComPicYuv*       pcPicYuvOrg = NULL;
+  TComPicYuv*       pcPicYuvTrueOrg = NULL;
   TComPicYuv*       pcPicYuvRec = NULL;
 
   // initialize internal class & member variables
@@ -493,18 +507,16 @@ Void TAppEncTop::encode()
 
   list<AccessUnit> outputAccessUnits; ///< list of access units to write out.  is populated by the encoding process
 
-  TComPicYuv cPicYuvTrueOrg;
+  // allocate original YUV buffers and start reading the input file
+  m_cTVideoIOYuvInputReader.create( &m_cTVideoIOYuvInputFile, m_iInputPrefetchDepth, m_iSourceWidth, m_isField ? m_iSourceHeightOrg : m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth );
+  m_cTVideoIOYuvInputReader.start( m_isField ? (m_framesToBeEncoded >> 1) : m_framesToBeEncoded, m_temporalSubsampleRatio - 1, m_iSourceWidth - m_aiPad[0], m_iSourceHeight - m_aiPad[1],
+                                   ipCSC, m_aiPad, m_InputChromaFormatIDC, m_bClipInputVideoToRec709Range );
 
-  // allocate original YUV buffer
-  if( m_isField )
+  // start the writer thread
+  if ( m_iOutputQueueDepth > 0 )
   {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true);
-  }
-  else
-  {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+    m_bOutputDone = false;
+    m_cOutputThread = std::thread( &TAppEncTop::xOutputThread, this, std::ref( bitstreamFile ) );
   }
 
   while ( !bEos )
@@ -512,8 +524,8 @@ Void TAppEncTop::encode()
     // get buffers
     xGetBuffer(pcPicYuvRec);
 
-    // read input YUV file
-    m_cTVideoIOYuvInputFile.read( pcPicYuvOrg, &cPicYuvTrueOrg, ipCSC, m_aiPad, m_InputChromaFormatIDC, m_bClipInputVideoToRec709Range );
+    // get the next frame of the input YUV file, read ahead by the reader thread
+    const Bool bRead = m_cTVideoIOYuvInputReader.read( pcPicYuvOrg, pcPicYuvTrueOrg );
 
     // increase number of received frames
     m_iFrameRcvd++;
@@ -522,7 +534,7 @@ Void TAppEncTop::encode()
 
     Bool flush = 0;
     // if end of file (which is only detected on a read failure) flush the encoder of any queued pictures
-    if (m_cTVideoIOYuvInputFile.isEof())
+    if (!bRead)
     {
       flush = true;
       bEos = true;
@@ -533,36 +545,33 @@ Void TAppEncTop::encode()
     // call encoding function for one frame
     if ( m_isField )
     {
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst );
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst );
     }
     else
     {
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded );
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded );
     }
+    // the encoder has copied the input frame, let the reader thread refill its buffers
+    m_cTVideoIOYuvInputReader.release();
 
-    // write bistream to file if necessary
+    // write bistream to file if necessary, on the writer thread when there is one
     if ( iNumEncoded > 0 )
     {
-      xWriteOutput(bitstreamFile, iNumEncoded, outputAccessUnits);
+      xQueueOutput(bitstreamFile, iNumEncoded, outputAccessUnits);
       outputAccessUnits.clear();
     }
-    // temporally skip frames
-    if( m_temporalSubsampleRatio > 1 )
-    {
-      m_cTVideoIOYuvInputFile.skipFrames(m_temporalSubsampleRatio-1, m_iSourceWidth - m_aiPad[0], m_iSourceHeight - m_aiPad[1], m_InputChromaFormatIDC);
-    }
   }
 
+  // wait until everything is written
+  xFinishOutput();
+
   m_cTEncTop.printSummary(m_isField);
 
-  // delete original YUV buffer
-  pcPicYuvOrg->destroy();
-  delete pcPicYuvOrg;
-  pcPicYuvOrg = NULL;
+  // delete original YUV buffers
+  m_cTVideoIOYuvInputReader.destroy();
 
   // delete used buffers in encoder class
   m_cTEncTop.deletePicBuffer();
-  cPicYuvTrueOrg.destroy();
 
   // delete buffers & classes
   xDeleteBuffer();
@@ -618,13 +627,130 @@ Void TAppEncTop::xDeleteBuffer( )
 
 }
 
+/**
+  Write the output of an encode call, or queue it for the writer thread.
+  The access units are moved into the queue and the reconstructed pictures are copied into pictures of a pool,
+  since the encoder reuses its reconstruction buffers in the next calls.
+  \param bitstreamFile  target bitstream file
+  \param iNumEncoded    number of encoded frames
+  \param accessUnits    list of access units to be written, emptied when queued
+ */
+Void TAppEncTop::xQueueOutput(std::ostream& bitstreamFile, Int iNumEncoded, std::list<AccessUnit>& accessUnits)
+{
+  // the last iNumEncoded reconstructed pictures, in output order
+  std::vector<TComPicYuv*> recPics;
+  TComList<TComPicYuv*>::iterator iterPicYuvRec = m_cListPicYuvRec.end();
+  for ( Int i = 0; i < iNumEncoded; i++ )
+  {
+    --iterPicYuvRec;
+  }
+  for ( Int i = 0; i < iNumEncoded; i++ )
+  {
+    recPics.push_back( *(iterPicYuvRec++) );
+  }
+
+  if ( m_iOutputQueueDepth == 0 )
+  {
+    xWriteOutput( bitstreamFile, iNumEncoded, recPics, accessUnits );
+    return;
+  }
+
+  OutputJob* pcJob = new OutputJob;
+  pcJob->iNumEncoded = iNumEncoded;
+  pcJob->accessUnits.splice( pcJob->accessUnits.end(), accessUnits );
+  if ( !m_reconFileName.empty() )
+  {
+    for ( UInt i = 0; i < recPics.size(); i++ )
+    {
+      TComPicYuv* pcRecPic = NULL;
+      {
+        std::lock_guard<std::mutex> cLock( m_cOutputMutex );
+        if ( !m_freeRecPics.empty() )
+        {
+          pcRecPic = m_freeRecPics.back();
+          m_freeRecPics.pop_back();
+        }
+      }
+      if ( pcRecPic == NULL )
+      {
+        pcRecPic = new TComPicYuv;
+        pcRecPic->create( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+      }
+      recPics[i]->copyToPic( pcRecPic );
+      pcJob->recPics.push_back( pcRecPic );
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> cLock( m_cOutputMutex );
+    m_cOutputCond.wait( cLock, [&]{ return Int( m_outputJobs.size() ) < m_iOutputQueueDepth; } );
+    m_outputJobs.push_back( pcJob );
+  }
+  m_cOutputCond.notify_all();
+}
+
+/**
+  Writer thread: write the queued jobs in order and give their pictures back to the pool.
+  \param bitstreamFile  target bitstream file
+ */
+Void TAppEncTop::xOutputThread(std::ostream& bitstreamFile)
+{
+  while ( true )
+  {
+    OutputJob* pcJob;
+    {
+      std::unique_lock<std::mutex> cLock( m_cOutputMutex );
+      m_cOutputCond.wait( cLock, [&]{ return m_bOutputDone || !m_outputJobs.empty(); } );
+      if ( m_outputJobs.empty() )
+      {
+        return;
+      }
+      pcJob = m_outputJobs.front();
+      m_outputJobs.pop_front();
+    }
+    m_cOutputCond.notify_all();
+
+    xWriteOutput( bitstreamFile, pcJob->iNumEncoded, pcJob->recPics, pcJob->accessUnits );
+
+    {
+      std::lock_guard<std::mutex> cLock( m_cOutputMutex );
+      m_freeRecPics.insert( m_freeRecPics.end(), pcJob->recPics.begin(), pcJob->recPics.end() );
+    }
+    delete pcJob;
+  }
+}
+
+/**
+  Wait until the writer thread has written all queued jobs, and delete the picture pool.
+ */
+Void TAppEncTop::xFinishOutput()
+{
+  if ( m_cOutputThread.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> cLock( m_cOutputMutex );
+      m_bOutputDone = true;
+    }
+    m_cOutputCond.notify_all();
+    m_cOutputThread.join();
+  }
+
+  for ( UInt i = 0; i < m_freeRecPics.size(); i++ )
+  {
+    m_freeRecPics[i]->destroy();
+    delete m_freeRecPics[i];
+  }
+  m_freeRecPics.clear();
+}
+
 /** 
   Write access units to output file.
   \param bitstreamFile  target bitstream file
   \param iNumEncoded    number of encoded frames
+  \param recPics        reconstructed pictures of the access units, in output order (unused without ReconFile)
   \param accessUnits    list of access units to be written
  */
-Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::list<AccessUnit>& accessUnits)
+Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::vector<TComPicYuv*>& recPics, const std::list<AccessUnit>& accessUnits)
 {
   const InputColourSpaceConversion ipCSC = (!m_outputInternalColourSpace) ? m_inputColourSpaceConvert : IPCOLOURSPACE_UNCHANGED;
 
@@ -632,21 +758,14 @@ Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, cons
   {
     //Reinterlace fields
     Int i;
-    TComList<TComPicYuv*>::iterator iterPicYuvRec = m_cListPicYuvRec.end();
     list<AccessUnit>::const_iterator iterBitstream = accessUnits.begin();
 
-    for ( i = 0; i < iNumEncoded; i++ )
-    {
-      --iterPicYuvRec;
-    }
-
     for ( i = 0; i < iNumEncoded/2; i++ )
     {
-      TComPicYuv*  pcPicYuvRecTop  = *(iterPicYuvRec++);
-      TComPicYuv*  pcPicYuvRecBottom  = *(iterPicYuvRec++);
-
       if (!m_reconFileName.empty())
       {
+        TComPicYuv*  pcPicYuvRecTop     = recPics[2*i];
+        TComPicYuv*  pcPicYuvRecBottom  = recPics[2*i+1];
         m_cTVideoIOYuvReconFile.write( pcPicYuvRecTop, pcPicYuvRecBottom, ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom, NUM_CHROMA_FORMAT, m_isTopFieldFirst );
       }
 
@@ -663,19 +782,13 @@ Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, cons
   {
     Int i;
 
-    TComList<TComPicYuv*>::iterator iterPicYuvRec = m_cListPicYuvRec.end();
     list<AccessUnit>::const_iterator iterBitstream = accessUnits.begin();
 
     for ( i = 0; i < iNumEncoded; i++ )
     {
-      --iterPicYuvRec;
-    }
-
-    for ( i = 0; i < iNumEncoded; i++ )
-    {
-      TComPicYuv*  pcPicYuvRec  = *(iterPicYuvRec++);
       if (!m_reconFileName.empty())
       {
+        TComPicYuv*  pcPicYuvRec  = recPics[i];
         m_cTVideoIOYuvReconFile.write( pcPicYuvRec, ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom,
             NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range  );
       }
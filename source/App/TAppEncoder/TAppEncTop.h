@@ -38,11 +38,17 @@
 #ifndef __TAPPENCTOP__
 #define __TAPPENCTOP__
 
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <ostream>
+#include <thread>
+#include <vector>
 
 #include "TLibEncoder/TEncTop.h"
 #include "TLibVideoIO/TVideoIOYuv.h"
+#include "TLibVideoIO/TVideoIOYuvReader.h"
 #include "TLibCommon/AccessUnit.h"
 #include "TAppEncCfg.h"
 
@@ -59,7 +65,7 @@ class TAppEncTop : public TAppEncCfg
 private:
   // class interface
   TEncTop                    m_cTEncTop;                    ///< encoder class
-  TVideoIOYuv                m_cTVideoIOYuvInputFile;       ///< input YUV file
+  TVideoIOYuvReader          m_cTVideoIOYuvInputReader;     ///< reader thread prefetching the frames of the input file
   TVideoIOYuv                m_cTVideoIOYuvReconFile;       ///< output reconstruction file
 
   TComList<TComPicYuv*>      m_cListPicYuvRec;              ///< list of reconstruction YUV files
@@ -69,6 +75,22 @@ private:
   UInt m_essentialBytes;
   UInt m_totalBytes;
 
+  /// access units and reconstructed pictures of one encode call, waiting for the writer thread
+  struct OutputJob
+  {
+    Int                      iNumEncoded;
+    std::list<AccessUnit>    accessUnits;
+    std::vector<TComPicYuv*> recPics;                       ///< copies of the reconstructed pictures, in output order
+  };
+
+  // asynchronous output
+  std::deque<OutputJob*>     m_outputJobs;                  ///< queue of the writer thread
+  std::vector<TComPicYuv*>   m_freeRecPics;                 ///< pool of the copies of the reconstructed pictures
+  Bool                       m_bOutputDone;                 ///< no more jobs will be queued
+  std::thread                m_cOutputThread;
+  std::mutex                 m_cOutputMutex;
+  std::condition_variable    m_cOutputCond;
+
 protected:
   // initialization
   Void  xCreateLib        ();                               ///< create files & encoder class
@@ -83,7 +105,10 @@ protected:
   Void  xDeleteBuffer     ();
 
   // file I/O
-  Void xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::list<AccessUnit>& accessUnits); ///< write bitstream to file
+  Void xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::vector<TComPicYuv*>& recPics, const std::list<AccessUnit>& accessUnits); ///< write bitstream to file
+  Void xQueueOutput(std::ostream& bitstreamFile, Int iNumEncoded, std::list<AccessUnit>& accessUnits);           ///< write or queue the output of an encode call
+  Void xOutputThread(std::ostream& bitstreamFile);                                                               ///< writer thread
+  Void xFinishOutput();                                                                                          ///< wait for the writer thread
   Void rateStatsAccum(const AccessUnit& au, const std::vector<UInt>& stats);
   Void printRateSummary();
   Void printChromaFormat();
@@ -0,0 +1,350 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     transformSIMDcheck.cpp
+    \brief    randomised comparison of the SIMD transforms with the C partial butterflies
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <string>
+
+#include "TLibCommon/TComRom.h"
+#include "TLibCommon/TComTrQuantSIMD.h"
+#include "TAppCommon/program_options_lite.h"
+
+using namespace std;
+namespace po = df::program_options_lite;
+
+/// transform table under test
+struct TransformSet
+{
+  string             name;
+  TransformFunctions functions;
+};
+
+/// buffers are larger than any transform, so that writes past the output are detected
+static const Int BUFFER_SIZE = MAX_TU_SIZE * MAX_TU_SIZE + 64;
+static const Int MAX_SHIFT   = 12;
+
+static UInt s_randomState;
+
+static UInt getRandom()
+{
+  // xorshift32
+  s_randomState ^= s_randomState << 13;
+  s_randomState ^= s_randomState >> 17;
+  s_randomState ^= s_randomState << 5;
+  return s_randomState;
+}
+
+/// fill the first count values with random numbers of bits bits plus sign, and the rest of the buffer with a marker
+static Void fillRandom( TCoeff *buffer, Int count, Int bits )
+{
+  const TCoeff minimum = -(TCoeff(1) << bits);
+  const TCoeff maximum =  (TCoeff(1) << bits) - 1;
+  for (Int i = 0; i < count; i++)
+  {
+    switch (getRandom() & 7)
+    {
+      case 0:  buffer[i] = minimum; break;
+      case 1:  buffer[i] = maximum; break;
+      default: buffer[i] = minimum + TCoeff(getRandom() % UInt(maximum - minimum + 1)); break;
+    }
+  }
+  for (Int i = count; i < BUFFER_SIZE; i++)
+  {
+    buffer[i] = 0x5a5a5a5a;
+  }
+}
+
+class TransformChecker
+{
+public:
+  TransformChecker( const TransformSet &reference, const TransformSet &tested, Int trials )
+  : m_reference( reference ), m_tested( tested ), m_trials( trials ), m_numCases( 0 ), m_numMismatches( 0 ) {}
+
+  Void checkForward1D   ( Int bitDepth, Int maxLog2TrDynamicRange );
+  Void checkInverse1D   ( Int bitDepth, Int maxLog2TrDynamicRange );
+  Void checkForward2D   ( Int bitDepth, Int maxLog2TrDynamicRange );
+  Void checkInverse2D   ( Int bitDepth, Int maxLog2TrDynamicRange );
+
+  Int  getNumCases      () const { return m_numCases;      }
+  Int  getNumMismatches () const { return m_numMismatches; }
+
+private:
+  Void xCompare( const TCoeff *expected, const TCoeff *result, const TChar *function, Int size, Int line, Int shift, Int bitDepth, Int maxLog2TrDynamicRange );
+
+  const TransformSet &m_reference;
+  const TransformSet &m_tested;
+  Int                 m_trials;
+  Int                 m_numCases;
+  Int                 m_numMismatches;
+  TCoeff              m_input   [BUFFER_SIZE];
+  TCoeff              m_expected[BUFFER_SIZE];
+  TCoeff              m_result  [BUFFER_SIZE];
+};
+
+Void TransformChecker::xCompare( const TCoeff *expected, const TCoeff *result, const TChar *function, Int size, Int line, Int shift, Int bitDepth, Int maxLog2TrDynamicRange )
+{
+  m_numCases++;
+  for (Int i = 0; i < BUFFER_SIZE; i++)
+  {
+    if (expected[i] != result[i])
+    {
+      if (m_numMismatches < 20)
+      {
+        printf("%s %s: size %d, line %d, shift %d, bit depth %d, dynamic range %d: value %d is %d instead of %d\n",
+               m_tested.name.c_str(), function, size, line, shift, bitDepth, maxLog2TrDynamicRange, i, Int(result[i]), Int(expected[i]));
+      }
+      m_numMismatches++;
+      return;
+    }
+  }
+}
+
+/// forward butterflies and DST with the residual range of bitDepth and the intermediate range of the second stage
+Void TransformChecker::checkForward1D( Int bitDepth, Int maxLog2TrDynamicRange )
+{
+  const Int inputBits[2] = { bitDepth, maxLog2TrDynamicRange };
+
+  for (Int bitsIdx = 0; bitsIdx < 2; bitsIdx++)
+  {
+    for (Int shift = 0; shift <= MAX_SHIFT; shift++)
+    {
+      for (Int trial = 0; trial < m_trials; trial++)
+      {
+        for (Int log2Size = 0; log2Size < 4; log2Size++)
+        {
+          const Int size = 4 << log2Size;
+          for (Int line = 4; line <= MAX_TU_SIZE; line <<= 1)
+          {
+            fillRandom( m_input, size * line, inputBits[bitsIdx] );
+            memcpy( m_expected, m_input, sizeof(m_input) );
+            memcpy( m_result,   m_input, sizeof(m_input) );
+            m_reference.functions.partialButterfly[log2Size]( m_input, m_expected, shift, line );
+            m_tested   .functions.partialButterfly[log2Size]( m_input, m_result,   shift, line );
+            xCompare( m_expected, m_result, "partialButterfly", size, line, shift, bitDepth, maxLog2TrDynamicRange );
+          }
+        }
+
+        fillRandom( m_input, 16, inputBits[bitsIdx] );
+        memcpy( m_expected, m_input, sizeof(m_input) );
+        memcpy( m_result,   m_input, sizeof(m_input) );
+        m_reference.functions.fastForwardDst( m_input, m_expected, shift );
+        m_tested   .functions.fastForwardDst( m_input, m_result,   shift );
+        xCompare( m_expected, m_result, "fastForwardDst", 4, 4, shift, bitDepth, maxLog2TrDynamicRange );
+      }
+    }
+  }
+}
+
+/// inverse butterflies and DST with coefficients of the dynamic range, clipped to the dynamic range or to Pel
+Void TransformChecker::checkInverse1D( Int bitDepth, Int maxLog2TrDynamicRange )
+{
+  const TCoeff clipMinimum[2] = { -(TCoeff(1) << maxLog2TrDynamicRange),    std::numeric_limits<Pel>::min() };
+  const TCoeff clipMaximum[2] = {  (TCoeff(1) << maxLog2TrDynamicRange) - 1, std::numeric_limits<Pel>::max() };
+
+  for (Int clipIdx = 0; clipIdx < 2; clipIdx++)
+  {
+    for (Int shift = 0; shift <= MAX_SHIFT; shift++)
+    {
+      for (Int trial = 0; trial < m_trials; trial++)
+      {
+        for (Int log2Size = 0; log2Size < 4; log2Size++)
+        {
+          const Int size = 4 << log2Size;
+          for (Int line = 4; line <= MAX_TU_SIZE; line <<= 1)
+          {
+            fillRandom( m_input, size * line, maxLog2TrDynamicRange );
+            memcpy( m_expected, m_input, sizeof(m_input) );
+            memcpy( m_result,   m_input, sizeof(m_input) );
+            m_reference.functions.partialButterflyInverse[log2Size]( m_input, m_expected, shift, line, clipMinimum[clipIdx], clipMaximum[clipIdx] );
+            m_tested   .functions.partialButterflyInverse[log2Size]( m_input, m_result,   shift, line, clipMinimum[clipIdx], clipMaximum[clipIdx] );
+            xCompare( m_expected, m_result, "partialButterflyInverse", size, line, shift, bitDepth, maxLog2TrDynamicRange );
+          }
+        }
+
+        fillRandom( m_input, 16, maxLog2TrDynamicRange );
+        memcpy( m_expected, m_input, sizeof(m_input) );
+        memcpy( m_result,   m_input, sizeof(m_input) );
+        m_reference.functions.fastInverseDst( m_input, m_expected, shift, clipMinimum[clipIdx], clipMaximum[clipIdx] );
+        m_tested   .functions.fastInverseDst( m_input, m_result,   shift, clipMinimum[clipIdx], clipMaximum[clipIdx] );
+        xCompare( m_expected, m_result, "fastInverseDst", 4, 4, shift, bitDepth, maxLog2TrDynamicRange );
+      }
+    }
+  }
+}
+
+/// xTrMxN for every TU shape, with the DST for 4x4
+Void TransformChecker::checkForward2D( Int bitDepth, Int maxLog2TrDynamicRange )
+{
+  for (Int trial = 0; trial < m_trials; trial++)
+  {
+    for (Int width = 4; width <= MAX_TU_SIZE; width <<= 1)
+    {
+      for (Int height = 4; height <= MAX_TU_SIZE; height <<= 1)
+      {
+        for (Int useDST = 0; useDST < ((width == 4 && height == 4) ? 2 : 1); useDST++)
+        {
+          fillRandom( m_input, width * height, bitDepth );
+          memcpy( m_expected, m_input, sizeof(m_input) );
+          memcpy( m_result,   m_input, sizeof(m_input) );
+          xTrMxN( m_reference.functions, bitDepth, m_input, m_expected, width, height, useDST != 0, maxLog2TrDynamicRange );
+          xTrMxN( m_tested   .functions, bitDepth, m_input, m_result,   width, height, useDST != 0, maxLog2TrDynamicRange );
+          xCompare( m_expected, m_result, useDST ? "xTrMxN (DST)" : "xTrMxN", width, height, -1, bitDepth, maxLog2TrDynamicRange );
+        }
+      }
+    }
+  }
+}
+
+/// xITrMxN for every TU shape, with the DST for 4x4
+Void TransformChecker::checkInverse2D( Int bitDepth, Int maxLog2TrDynamicRange )
+{
+  for (Int trial = 0; trial < m_trials; trial++)
+  {
+    for (Int width = 4; width <= MAX_TU_SIZE; width <<= 1)
+    {
+      for (Int height = 4; height <= MAX_TU_SIZE; height <<= 1)
+      {
+        for (Int useDST = 0; useDST < ((width == 4 && height == 4) ? 2 : 1); useDST++)
+        {
+          fillRandom( m_input, width * height, maxLog2TrDynamicRange );
+          memcpy( m_expected, m_input, sizeof(m_input) );
+          memcpy( m_result,   m_input, sizeof(m_input) );
+          xITrMxN( m_reference.functions, bitDepth, m_input, m_expected, width, height, useDST != 0, maxLog2TrDynamicRange );
+          xITrMxN( m_tested   .functions, bitDepth, m_input, m_result,   width, height, useDST != 0, maxLog2TrDynamicRange );
+          xCompare( m_expected, m_result, useDST ? "xITrMxN (DST)" : "xITrMxN", width, height, -1, bitDepth, maxLog2TrDynamicRange );
+        }
+      }
+    }
+  }
+}
+
+Int main(Int argc, const char** argv)
+{
+  Bool do_help;
+  Int  trials;
+  UInt seed;
+
+  po::Options opts;
+  opts.addOptions()
+  ("help",       do_help, false, "this help text")
+  ("Trials,t",   trials,  10,    "random inputs per transform, shift and range")
+  ("Seed,s",     seed,    1u,    "seed of the random inputs");
+
+  po::setDefaults(opts);
+  po::ErrorReporter err;
+  const list<const TChar*>& argv_unhandled = po::scanArgv(opts, argc, argv, err);
+
+  for (list<const TChar*>::const_iterator it = argv_unhandled.begin(); it != argv_unhandled.end(); it++)
+  {
+    fprintf(stderr, "Unhandled argument ignored: `%s'\n", *it);
+  }
+
+  if (do_help)
+  {
+    po::doHelp(cout, opts);
+    return EXIT_SUCCESS;
+  }
+  if (err.is_errored)
+  {
+    return EXIT_FAILURE;
+  }
+
+  initROM();
+  s_randomState = seed ? seed : 1;
+
+  TransformSet reference;
+  reference.name = "C";
+  setTransformFunctionsC( reference.functions );
+
+  // the sets are built in the order of getTransformFunctions, the AVX2 set falls back to the SSE4.1 set
+  vector<TransformSet> tested;
+#if TRANSFORM_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1"))
+  {
+    TransformSet set = reference;
+    set.name = "SSE4.1";
+    setTransformFunctionsSSE41( set.functions );
+    tested.push_back( set );
+    if (__builtin_cpu_supports("avx2"))
+    {
+      set.name = "AVX2";
+      setTransformFunctionsAVX2( set.functions );
+      tested.push_back( set );
+    }
+  }
+#endif
+  TransformSet selected;
+  selected.name      = "selected";
+  selected.functions = getTransformFunctions();
+  tested.push_back( selected );
+
+  const Int bitDepths[3] = { 8, 10, 12 };
+  Int numCases      = 0;
+  Int numMismatches = 0;
+
+  for (UInt setIdx = 0; setIdx < tested.size(); setIdx++)
+  {
+    TransformChecker checker( reference, tested[setIdx], trials );
+
+    for (Int bitDepthIdx = 0; bitDepthIdx < 3; bitDepthIdx++)
+    {
+      const Int bitDepth = bitDepths[bitDepthIdx];
+      // without and with extended precision processing
+      const Int dynamicRanges[2] = { 15, std::max<Int>(15, bitDepth + 6) };
+
+      for (Int rangeIdx = 0; rangeIdx < ((dynamicRanges[0] == dynamicRanges[1]) ? 1 : 2); rangeIdx++)
+      {
+        checker.checkForward1D( bitDepth, dynamicRanges[rangeIdx] );
+        checker.checkInverse1D( bitDepth, dynamicRanges[rangeIdx] );
+        checker.checkForward2D( bitDepth, dynamicRanges[rangeIdx] );
+        checker.checkInverse2D( bitDepth, dynamicRanges[rangeIdx] );
+      }
+    }
+
+    printf("%-8s %8d cases, %d mismatches\n", tested[setIdx].name.c_str(), checker.getNumCases(), checker.getNumMismatches());
+    numCases      += checker.getNumCases();
+    numMismatches += checker.getNumMismatches();
+  }
+
+  printf("%s: %d cases, %d mismatches\n", numMismatches ? "FAILED" : "PASSED", numCases, numMismatches);
+  return numMismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
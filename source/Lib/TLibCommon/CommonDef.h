@@ -169,6 +169,7 @@ static const Int MLS_GRP_NUM =                                     64; ///< Max
 static const Int MLS_CG_LOG2_WIDTH =                                2;
 static const Int MLS_CG_LOG2_HEIGHT =                               2;
 static const Int MLS_CG_SIZE =                                      4; ///< Coefficient group size of 4x4; = MLS_CG_LOG2_WIDTH + MLS_CG_LOG2_HEIGHT
+static const Int NUM_SIG_CTX_PATTERNS =                             4; ///< number of coefficient group neighbourhoods distinguished by patternSigCtx
 
 #if ADAPTIVE_QP_SELECTION
 static const Int ARL_C_PRECISION =                                  7; ///< G382: 7-bit arithmetic precision
@@ -40,6 +40,9 @@
 #include "TComBitStream.h"
 #include <string.h>
 #include <memory.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -92,11 +95,13 @@ Void TComInputBitstream::resetToStart()
 
 UChar* TComOutputBitstream::getByteStream() const
 {
+  xFlushHeldBytes();
   return (UChar*) &m_fifo.front();
 }
 
 UInt TComOutputBitstream::getByteStreamLength()
 {
+  xFlushHeldBytes();
   return UInt(m_fifo.size());
 }
 
@@ -112,43 +117,31 @@ Void TComOutputBitstream::write   ( UInt uiBits, UInt uiNumberOfBits )
   assert( uiNumberOfBits <= 32 );
   assert( uiNumberOfBits == 32 || (uiBits & (~0 << uiNumberOfBits)) == 0 );
 
-  /* any modulo 8 remainder of num_total_bits cannot be written this time,
-   * and will be held until next time. */
-  UInt num_total_bits = uiNumberOfBits + m_num_held_bits;
-  UInt next_num_held_bits = num_total_bits % 8;
+  /* the new bits are appended below the held bits; since fewer than 32 bits
+   * are held between calls, the 64-bit accumulator cannot overflow.
+   * NB, this requires that v only contains 0 in bit positions {31..n} */
+  m_held_bits = (m_held_bits << uiNumberOfBits) | uiBits;
+  m_num_held_bits += uiNumberOfBits;
 
-  /* form a byte aligned word (write_bits), by concatenating any held bits
-   * with the new bits, discarding the bits that will form the next_held_bits.
-   * eg: H = held bits, V = n new bits        /---- next_held_bits
-   * len(H)=7, len(V)=1: ... ---- HHHH HHHV . 0000 0000, next_num_held_bits=0
-   * len(H)=7, len(V)=2: ... ---- HHHH HHHV . V000 0000, next_num_held_bits=1
-   * if total_bits < 8, the value of v_ is not used */
-  UChar next_held_bits = uiBits << (8 - next_num_held_bits);
-
-  if (!(num_total_bits >> 3))
+  if (m_num_held_bits < 32)
   {
-    /* insufficient bits accumulated to write out, append new_held_bits to
-     * current held_bits */
-    /* NB, this requires that v only contains 0 in bit positions {31..n} */
-    m_held_bits |= next_held_bits;
-    m_num_held_bits = next_num_held_bits;
     return;
   }
 
-  /* topword serves to justify held_bits to align with the msb of uiBits */
-  UInt topword = (uiNumberOfBits - next_num_held_bits) & ~((1 << 3) -1);
-  UInt write_bits = (m_held_bits << topword) | (uiBits >> next_num_held_bits);
+  /* flush the oldest 32 held bits to the FIFO as one big-endian word */
+  m_num_held_bits -= 32;
+  const UInt write_bits = UInt(m_held_bits >> m_num_held_bits);
+  const uint8_t word[4] = { uint8_t(write_bits >> 24), uint8_t(write_bits >> 16), uint8_t(write_bits >> 8), uint8_t(write_bits) };
+  m_fifo.insert(m_fifo.end(), word, word + 4);
+}
 
-  switch (num_total_bits >> 3)
+Void TComOutputBitstream::xFlushHeldBytes() const
+{
+  while (m_num_held_bits >= 8)
   {
-  case 4: m_fifo.push_back(write_bits >> 24);
-  case 3: m_fifo.push_back(write_bits >> 16);
-  case 2: m_fifo.push_back(write_bits >> 8);
-  case 1: m_fifo.push_back(write_bits);
+    m_num_held_bits -= 8;
+    m_fifo.push_back(uint8_t(m_held_bits >> m_num_held_bits));
   }
-
-  m_held_bits = next_held_bits;
-  m_num_held_bits = next_num_held_bits;
 }
 
 Void TComOutputBitstream::writeAlignOne()
@@ -160,11 +153,12 @@ Void TComOutputBitstream::writeAlignOne()
 
 Void TComOutputBitstream::writeAlignZero()
 {
+  xFlushHeldBytes();
   if (0 == m_num_held_bits)
   {
     return;
   }
-  m_fifo.push_back(m_held_bits);
+  m_fifo.push_back(uint8_t(m_held_bits << (8 - m_num_held_bits)));
   m_held_bits = 0;
   m_num_held_bits = 0;
 }
@@ -179,9 +173,18 @@ Void   TComOutputBitstream::addSubstream( TComOutputBitstream* pcSubstream )
   UInt uiNumBits = pcSubstream->getNumberOfWrittenBits();
 
   const vector<uint8_t>& rbsp = pcSubstream->getFIFO();
-  for (vector<uint8_t>::const_iterator it = rbsp.begin(); it != rbsp.end();)
+  if (getNumBitsUntilByteAligned() == 0)
   {
-    write(*it++, 8);
+    // byte aligned: the whole bytes of the substream can be appended directly
+    xFlushHeldBytes();
+    m_fifo.insert(m_fifo.end(), rbsp.begin(), rbsp.end());
+  }
+  else
+  {
+    for (vector<uint8_t>::const_iterator it = rbsp.begin(); it != rbsp.end();)
+    {
+      write(*it++, 8);
+    }
   }
   if (uiNumBits&0x7)
   {
@@ -198,33 +201,70 @@ Void TComOutputBitstream::writeByteAlignment()
 Int TComOutputBitstream::countStartCodeEmulations()
 {
   UInt cnt = 0;
-  vector<uint8_t>& rbsp   = getFIFO();
-  for (vector<uint8_t>::iterator it = rbsp.begin(); it != rbsp.end();)
+  const vector<uint8_t>& rbsp = getFIFO();
+  if (rbsp.empty())
+  {
+    return 0;
+  }
+  const UInt uiSize = UInt(rbsp.size());
+  // NB, a trailing two byte sequence 00 00 is not counted
+  for (UInt uiPos = findStartCodeEmulation(&rbsp.front(), uiSize, 0); uiPos < uiSize; uiPos = findStartCodeEmulation(&rbsp.front(), uiSize, uiPos))
   {
-    vector<uint8_t>::iterator found = it;
-    do
+    cnt++;
+  }
+  return cnt;
+}
+
+UInt findZeroBytePair( const UChar* pData, UInt uiSize, UInt uiPos )
+{
+#if defined(__SSE2__)
+  /* 16 candidate positions per step: the bytes at p and at p + 1 are compared
+   * with zero for all of them at once */
+  const __m128i zero = _mm_setzero_si128();
+  for (; uiPos + 17 <= uiSize; uiPos += 16)
+  {
+    const __m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + uiPos));
+    const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + uiPos + 1));
+    const Int pairMask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, zero), _mm_cmpeq_epi8(second, zero)));
+    if (pairMask != 0)
     {
-      // find the next emulated 00 00 {00,01,02,03}
-      // NB, end()-1, prevents finding a trailing two byte sequence
-      found = search_n(found, rbsp.end()-1, 2, 0);
-      found++;
-      // if not found, found == end, otherwise found = second zero byte
-      if (found == rbsp.end())
-      {
-        break;
-      }
-      if (*(++found) <= 3)
-      {
-        break;
-      }
-    } while (true);
-    it = found;
-    if (found != rbsp.end())
+      return uiPos + __builtin_ctz(pairMask);
+    }
+  }
+#else
+  /* words without any zero byte are skipped a machine word at a time */
+  static const UInt64 LOW_BITS  = 0x0101010101010101ull;
+  static const UInt64 HIGH_BITS = 0x8080808080808080ull;
+  for (; uiPos + 8 <= uiSize; uiPos += 8)
+  {
+    UInt64 uiWord;
+    memcpy(&uiWord, pData + uiPos, sizeof(uiWord));
+    if (((uiWord - LOW_BITS) & ~uiWord & HIGH_BITS) != 0)
     {
-      cnt++;
+      break;
     }
   }
-  return cnt;
+#endif
+  for (; uiPos + 1 < uiSize; uiPos++)
+  {
+    if (pData[uiPos] == 0 && pData[uiPos + 1] == 0)
+    {
+      return uiPos;
+    }
+  }
+  return uiSize;
+}
+
+UInt findStartCodeEmulation( const UChar* pData, UInt uiSize, UInt uiPos )
+{
+  for (uiPos = findZeroBytePair(pData, uiSize, uiPos); uiPos + 2 < uiSize; uiPos = findZeroBytePair(pData, uiSize, uiPos + 1))
+  {
+    if (pData[uiPos + 2] <= 3)
+    {
+      return uiPos + 2;
+    }
+  }
+  return uiSize;
 }
 
 /**
@@ -322,6 +362,8 @@ Void TComOutputBitstream::insertAt(const TComOutputBitstream& src, UInt pos)
   UInt src_bits = src.getNumberOfWrittenBits();
   assert(0 == src_bits % 8);
 
+  src.xFlushHeldBytes();
+  xFlushHeldBytes();
   vector<uint8_t>::iterator at = m_fifo.begin() + pos;
   m_fifo.insert(at, src.m_fifo.begin(), src.m_fifo.end());
 }
@@ -79,12 +79,18 @@ class TComOutputBitstream : public TComBitIf
    *  - fifo.clear() to empty the FIFO
    *  - &fifo.front() to get a pointer to the data array.
    *    NB, this pointer is only valid until the next push_back()/clear()
+   * Whole bytes may still be held in m_held_bits; they are moved to the
+   * FIFO by xFlushHeldBytes() before the FIFO is exposed.
    */
-  std::vector<uint8_t> m_fifo;
+  mutable std::vector<uint8_t> m_fifo;
+
+  mutable UInt64 m_held_bits; /// the bits held and not flushed to bytestream.
+                              /// this value is lsb-aligned: the most recently written bit is bit 0.
+  mutable UInt m_num_held_bits; /// number of bits not flushed to bytestream, always less than 32 between calls.
+
+  /** move all whole bytes held in m_held_bits to the FIFO */
+  Void xFlushHeldBytes() const;
 
-  UInt m_num_held_bits; /// number of bits not flushed to bytestream.
-  UChar m_held_bits; /// the bits held and not flushed to bytestream.
-                             /// this value is always msb-aligned, bigendian.
 public:
   // create / destroy
   TComOutputBitstream();
@@ -142,13 +148,14 @@ public:
   /**
    * Return a reference to the internal fifo
    */
-  std::vector<uint8_t>& getFIFO() { return m_fifo; }
+  std::vector<uint8_t>& getFIFO() { xFlushHeldBytes(); return m_fifo; }
 
-  UChar getHeldBits  ()          { return m_held_bits;          }
+  /** Return the bits that do not yet form a whole byte, msb-aligned */
+  UChar getHeldBits  ()          { xFlushHeldBytes(); return UChar(m_held_bits << (8 - m_num_held_bits)); }
 
   //TComOutputBitstream& operator= (const TComOutputBitstream& src);
   /** Return a reference to the internal fifo */
-  const std::vector<uint8_t>& getFIFO() const { return m_fifo; }
+  const std::vector<uint8_t>& getFIFO() const { xFlushHeldBytes(); return m_fifo; }
 
   Void          addSubstream    ( TComOutputBitstream* pcSubstream );
   Void writeByteAlignment();
@@ -157,6 +164,19 @@ public:
   Int countStartCodeEmulations();
 };
 
+/**
+ * Return the position of the first pair of zero bytes at or after uiPos, i.e. the
+ * smallest p >= uiPos with pData[p] == pData[p + 1] == 0, or uiSize if there is none.
+ */
+UInt findZeroBytePair( const UChar* pData, UInt uiSize, UInt uiPos );
+
+/**
+ * Return the position of the first byte at or after uiPos + 2 that is preceded by two
+ * zero bytes at or after uiPos and has a value of at most 3, i.e. the position at which
+ * an emulation prevention byte has to be inserted, or uiSize if there is no such byte.
+ */
+UInt findStartCodeEmulation( const UChar* pData, UInt uiSize, UInt uiPos );
+
 /**
  * Model of an input bitstream that extracts bits from a predefined
  * bytestream.
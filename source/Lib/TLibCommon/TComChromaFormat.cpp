@@ -135,12 +135,14 @@ Void getTUEntropyCodingParameters(      TUEntropyCodingParameters &result,
       && (pcCU->getCUTransquantBypass(uiAbsPartIdx) || (pcCU->getTransformSkip(uiAbsPartIdx, component) != 0)))
   {
     result.firstSignificanceMapContext = significanceMapContextSetStart[channelType][CONTEXT_TYPE_SINGLE];
+    result.sigCtxIncTable              = g_sigCtxInc[result.scanType][channelType][CONTEXT_TYPE_SINGLE][0][0];
   }
   else
   {
     if ((area.width == 4) && (area.height == 4))
     {
       result.firstSignificanceMapContext = significanceMapContextSetStart[channelType][CONTEXT_TYPE_4x4];
+      result.sigCtxIncTable              = g_sigCtxInc[result.scanType][channelType][CONTEXT_TYPE_4x4][0][0];
     }
     else if ((area.width == 8) && (area.height == 8))
     {
@@ -149,10 +151,12 @@ Void getTUEntropyCodingParameters(      TUEntropyCodingParameters &result,
       {
         result.firstSignificanceMapContext += nonDiagonalScan8x8ContextOffset[channelType];
       }
+      result.sigCtxIncTable              = g_sigCtxInc[result.scanType][channelType][CONTEXT_TYPE_8x8][0][0];
     }
     else
     {
       result.firstSignificanceMapContext = significanceMapContextSetStart[channelType][CONTEXT_TYPE_NxN];
+      result.sigCtxIncTable              = g_sigCtxInc[result.scanType][channelType][CONTEXT_TYPE_NxN][0][0];
     }
   }
 
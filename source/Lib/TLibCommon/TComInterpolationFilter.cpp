@@ -393,4 +393,66 @@ Void TComInterpolationFilter::filterVer(const ComponentID compID, Pel *src, Int
   }
 }
 
+/**
+ * \brief Fused separable 2-D interpolation of several phases, processed in strips of rows
+ *
+ * All horizontal passes write intermediate samples, and all vertical passes read intermediate samples and
+ * produce final output samples. Instead of filtering every intermediate plane in full before the vertical
+ * passes start, the block is processed in strips of IF_STRIP_HEIGHT output rows: each strip filters only
+ * the intermediate rows it needs and immediately runs every vertical pass over them, so the intermediate
+ * samples are still in the L1 cache when they are read back. The result is identical to running the passes
+ * one after another.
+ *
+ * A vertical pass producing output row y may read intermediate rows up to y + number of taps - 1, counted
+ * from the first row of the horizontal passes (i.e. the vertical source pointers point at most half the
+ * filter length below the first intermediate row). Vertical passes may also read planes that were filtered
+ * completely beforehand.
+ *
+ * \param  compID       Colour component ID
+ * \param  horPasses    Horizontal (first) filtering passes
+ * \param  numHorPasses Number of horizontal passes
+ * \param  verPasses    Vertical (last) filtering passes
+ * \param  numVerPasses Number of vertical passes
+ * \param  fmt          Chroma format
+ * \param  bitDepth     Bit depth
+ */
+Void TComInterpolationFilter::filterSeparableStrips(const ComponentID compID, const TComInterpolationPass *horPasses, Int numHorPasses, const TComInterpolationPass *verPasses, Int numVerPasses, const ChromaFormat fmt, const Int bitDepth )
+{
+  const Int numTaps = isLuma(compID) ? NTAPS_LUMA : NTAPS_CHROMA;
+
+  Int outHeight = 0;
+  for (Int i = 0; i < numVerPasses; i++)
+  {
+    outHeight = std::max(outHeight, verPasses[i].height);
+  }
+
+  Int horRowsDone = 0;
+  for (Int stripStart = 0; stripStart < outHeight; stripStart += IF_STRIP_HEIGHT)
+  {
+    const Int stripEnd      = stripStart + IF_STRIP_HEIGHT;
+    const Int horRowsNeeded = stripEnd + numTaps;
+
+    for (Int i = 0; i < numHorPasses; i++)
+    {
+      const TComInterpolationPass &pass = horPasses[i];
+      const Int rows = std::min(pass.height, horRowsNeeded) - horRowsDone;
+      if (rows > 0)
+      {
+        filterHor(compID, pass.src + horRowsDone * pass.srcStride, pass.srcStride, pass.dst + horRowsDone * pass.dstStride, pass.dstStride, pass.width, rows, pass.frac, false, fmt, bitDepth);
+      }
+    }
+    horRowsDone = horRowsNeeded;
+
+    for (Int i = 0; i < numVerPasses; i++)
+    {
+      const TComInterpolationPass &pass = verPasses[i];
+      const Int rows = std::min(pass.height, stripEnd) - stripStart;
+      if (rows > 0)
+      {
+        filterVer(compID, pass.src + stripStart * pass.srcStride, pass.srcStride, pass.dst + stripStart * pass.dstStride, pass.dstStride, pass.width, rows, pass.frac, false, true, fmt, bitDepth);
+      }
+    }
+  }
+}
+
 //! \}
@@ -49,6 +49,21 @@
 #define IF_INTERNAL_PREC 14 ///< Number of bits for internal precision
 #define IF_FILTER_PREC    6 ///< Log2 of sum of filter taps
 #define IF_INTERNAL_OFFS (1<<(IF_INTERNAL_PREC-1)) ///< Offset used internally
+#define IF_STRIP_HEIGHT   8 ///< Number of output rows produced per strip by filterSeparableStrips
+
+/**
+ * \brief One horizontal or vertical filtering pass over a block
+ */
+struct TComInterpolationPass
+{
+  Pel *src;       ///< Pointer to source samples (intermediate samples for a vertical pass)
+  Int  srcStride; ///< Stride of source samples
+  Pel *dst;       ///< Pointer to destination samples
+  Int  dstStride; ///< Stride of destination samples
+  Int  width;     ///< Width of block
+  Int  height;    ///< Height of block
+  Int  frac;      ///< Fractional sample offset
+};
 
 /**
  * \brief Interpolation filter class
@@ -74,6 +89,8 @@ public:
 
   Void filterHor(const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int frac,               Bool isLast, const ChromaFormat fmt, const Int bitDepth );
   Void filterVer(const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int frac, Bool isFirst, Bool isLast, const ChromaFormat fmt, const Int bitDepth );
+
+  Void filterSeparableStrips(const ComponentID compID, const TComInterpolationPass *horPasses, Int numHorPasses, const TComInterpolationPass *verPasses, Int numVerPasses, const ChromaFormat fmt, const Int bitDepth );
 };
 
 //! \}
@@ -73,6 +73,8 @@ const UChar TComLoopFilter::sm_betaTable[MAX_QP + 1] =
 TComLoopFilter::TComLoopFilter()
 : m_uiNumPartitions(0)
 , m_bLFCrossTileBoundary(true)
+, m_uiMaxCUDepth(0)
+, m_pcThreadPool(NULL)
 {
   for( Int edgeDir = 0; edgeDir < NUM_EDGE_DIR; edgeDir++ )
   {
@@ -96,6 +98,7 @@ Void TComLoopFilter::setCfg( Bool bLFCrossTileBoundary )
 Void TComLoopFilter::create( UInt uiMaxCUDepth )
 {
   destroy();
+  m_uiMaxCUDepth    = uiMaxCUDepth;
   m_uiNumPartitions = 1 << ( uiMaxCUDepth<<1 );
   for( Int edgeDir = 0; edgeDir < NUM_EDGE_DIR; edgeDir++ )
   {
@@ -120,6 +123,13 @@ Void TComLoopFilter::destroy()
       m_aapbEdgeFilter[edgeDir] = NULL;
     }
   }
+
+  for ( UInt i = 0; i < m_apcRowFilters.size(); i++ )
+  {
+    m_apcRowFilters[i]->destroy();
+    delete m_apcRowFilters[i];
+  }
+  m_apcRowFilters.clear();
 }
 
 /**
@@ -129,6 +139,12 @@ Void TComLoopFilter::destroy()
  */
 Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
 {
+  if ( m_pcThreadPool != NULL && m_pcThreadPool->getNumThreads() > 1 && pcPic->getFrameHeightInCtus() > 1 )
+  {
+    xLoopFilterPicRows( pcPic );
+    return;
+  }
+
   // Horizontal filtering
   for ( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame(); ctuRsAddr++ )
   {
@@ -154,6 +170,79 @@ Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
   }
 }
 
+/**
+ - call deblocking function for every CU, with one job per CTU row filter
+ .
+ Every job takes the next CTU row not filtered yet, filters its vertical edges and then, once the vertical edges of the row
+ above are filtered as well, its horizontal edges. The filters of the edges of one direction do not overlap, so the horizontal
+ edges of a row only depend on the vertical edges of the row and the row above, and the result is the same as the one of
+ loopFilterPic without thread pool.
+ \param  pcPic   picture class (TComPic) pointer
+ */
+Void TComLoopFilter::xLoopFilterPicRows( TComPic* pcPic )
+{
+  const UInt uiNumRows = pcPic->getFrameHeightInCtus();
+  const Int  iNumJobs  = std::min<Int>( m_pcThreadPool->getNumThreads(), Int(uiNumRows) );
+  while ( Int(m_apcRowFilters.size()) < iNumJobs - 1 )
+  {
+    m_apcRowFilters.push_back( new TComLoopFilter );
+    m_apcRowFilters.back()->create( m_uiMaxCUDepth );
+  }
+  for ( UInt i = 0; i < m_apcRowFilters.size(); i++ )
+  {
+    m_apcRowFilters[i]->setCfg( m_bLFCrossTileBoundary );
+  }
+  m_aucVerRowDone.assign( uiNumRows, 0 );
+
+  UInt uiNextRow = 0;
+  m_pcThreadPool->parallelFor( iNumJobs, [&]( Int iJob )
+  {
+    TComLoopFilter* pcFilter = iJob == 0 ? this : m_apcRowFilters[iJob - 1];
+    while ( true )
+    {
+      UInt uiRow;
+      {
+        std::lock_guard<std::mutex> cLock( m_cRowMutex );
+        uiRow = uiNextRow++;
+      }
+      if ( uiRow >= uiNumRows )
+      {
+        break;
+      }
+
+      pcFilter->xDeblockCtuRow( pcPic, uiRow, EDGE_VER );
+      {
+        std::unique_lock<std::mutex> cLock( m_cRowMutex );
+        m_aucVerRowDone[uiRow] = 1;
+        m_cVerRowDone.notify_all();
+        // the horizontal edges at the top of the row modify the bottom lines of the row above
+        m_cVerRowDone.wait( cLock, [&]{ return uiRow == 0 || m_aucVerRowDone[uiRow - 1] != 0; } );
+      }
+      pcFilter->xDeblockCtuRow( pcPic, uiRow, EDGE_HOR );
+    }
+  } );
+}
+
+/** Filter the edges of one direction of the CTUs of a CTU row
+ * \param pcPic   picture
+ * \param uiRow   CTU row
+ * \param edgeDir direction of the edges
+ */
+Void TComLoopFilter::xDeblockCtuRow( TComPic* pcPic, UInt uiRow, DeblockEdgeDir edgeDir )
+{
+  const UInt frameWidthInCtus = pcPic->getFrameWidthInCtus();
+  for ( UInt ctuRsAddr = uiRow * frameWidthInCtus; ctuRsAddr < ( uiRow + 1 ) * frameWidthInCtus; ctuRsAddr++ )
+  {
+    TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+
+    ::memset( m_aapucBS       [edgeDir], 0, sizeof( UChar ) * m_uiNumPartitions );
+    ::memset( m_aapbEdgeFilter[edgeDir], 0, sizeof( Bool  ) * m_uiNumPartitions );
+
+    // CU-based deblocking
+    xDeblockCU( pCtu, 0, 0, edgeDir );
+  }
+}
+
 
 // ====================================================================================================================
 // Protected member functions
@@ -40,6 +40,11 @@
 
 #include "CommonDef.h"
 #include "TComPic.h"
+#include "TComThreadPool.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 //! \ingroup TLibCommon
 //! \{
@@ -62,9 +67,19 @@ private:
 
   Bool      m_bLFCrossTileBoundary;
 
+  // row-parallel deblocking
+  UInt                          m_uiMaxCUDepth;
+  TComThreadPool*               m_pcThreadPool;     ///< pool running the CTU row jobs, or NULL to filter serially
+  std::vector<TComLoopFilter*>  m_apcRowFilters;    ///< filters of the CTU row jobs besides this one, each with its own Bs and edge storage
+  std::vector<UChar>            m_aucVerRowDone;    ///< vertical edges of each CTU row filtered
+  std::mutex                    m_cRowMutex;
+  std::condition_variable       m_cVerRowDone;
+
 protected:
   /// CU-level deblocking function
   Void xDeblockCU                 ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, DeblockEdgeDir edgeDir );
+  Void xDeblockCtuRow             ( TComPic* pcPic, UInt uiRow, DeblockEdgeDir edgeDir );
+  Void xLoopFilterPicRows         ( TComPic* pcPic );
 
   // set / get functions
   Void xSetLoopfilterParam        ( TComDataCU* pcCU, UInt uiAbsZorderIdx );
@@ -128,6 +143,9 @@ public:
   /// set configuration
   Void setCfg( Bool bLFCrossTileBoundary );
 
+  /// set the thread pool of the row-parallel filtering (NULL: serial)
+  Void setThreadPool( TComThreadPool* pcThreadPool ) { m_pcThreadPool = pcThreadPool; }
+
   /// picture-level deblocking filter
   Void loopFilterPic( TComPic* pcPic );
 
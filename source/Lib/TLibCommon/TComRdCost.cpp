@@ -166,6 +166,38 @@ Void TComRdCost::init()
 
   m_motionLambda               = 0;
   m_iCostScale                 = 0;
+  xInitMvCostOfBits();
+}
+
+const UChar* TComRdCost::s_mvBitsOfOffset = TComRdCost::xInitMvBitsOfOffset();
+
+/** Build the table of exp-Golomb vector component lengths, shared by all instances.
+ * The length of an offset d from the predictor is 2 * (bit length of |d|) + 1, so it only depends on the offset.
+ * \returns pointer to the entry of offset 0
+ */
+const UChar* TComRdCost::xInitMvBitsOfOffset()
+{
+  static UChar s_aucMvBits[2 * MV_BITS_TABLE_RANGE + 1];
+
+  for (Int iOffset = -MV_BITS_TABLE_RANGE; iOffset <= MV_BITS_TABLE_RANGE; iOffset++)
+  {
+    s_aucMvBits[iOffset + MV_BITS_TABLE_RANGE] = UChar( xGetExpGolombNumberOfBits( iOffset ) );
+  }
+  return s_aucMvBits + MV_BITS_TABLE_RANGE;
+}
+
+/** Build the motion cost of every number of vector bits covered by s_mvBitsOfOffset for the current motion lambda.
+ * It is rebuilt only when the motion lambda changes, which for most configurations is once per slice.
+ */
+Void TComRdCost::xInitMvCostOfBits()
+{
+  const UInt uiMaxBits = 2 * xGetExpGolombNumberOfBits( MV_BITS_TABLE_RANGE );
+
+  m_mvCostOfBits.resize( uiMaxBits + 1 );
+  for (UInt uiBits = 0; uiBits <= uiMaxBits; uiBits++)
+  {
+    m_mvCostOfBits[uiBits] = getCost( uiBits );
+  }
 }
 
 // Static member function
@@ -39,6 +39,8 @@
 #define __TCOMRDCOST__
 
 
+#include <vector>
+
 #include "CommonDef.h"
 #include "TComPattern.h"
 #include "TComMv.h"
@@ -126,6 +128,10 @@ private:
   TComMv                  m_mvPredictor;
   Double                  m_motionLambda;
   Int                     m_iCostScale;
+  std::vector<Distortion> m_mvCostOfBits;                             ///< motion cost of each number of vector bits with m_motionLambda
+
+  static const Int        MV_BITS_TABLE_RANGE = 1 << 11;              ///< largest quarter-pel component offset from the predictor covered by s_mvBitsOfOffset
+  static const UChar*     s_mvBitsOfOffset;                           ///< exp-Golomb bits of the component offsets -MV_BITS_TABLE_RANGE..MV_BITS_TABLE_RANGE, centred on offset 0
 
 public:
   TComRdCost();
@@ -156,7 +162,15 @@ public:
 
   // for motion cost
   static UInt    xGetExpGolombNumberOfBits( Int iVal );
-  Void    selectMotionLambda( Bool bSad, Int iAdd, Bool bIsTransquantBypass ) { m_motionLambda = (bSad ? m_dLambdaMotionSAD[(bIsTransquantBypass && m_costMode==COST_MIXED_LOSSLESS_LOSSY_CODING) ?1:0] + iAdd : m_dLambdaMotionSSE[(bIsTransquantBypass && m_costMode==COST_MIXED_LOSSLESS_LOSSY_CODING)?1:0] + iAdd); }
+  Void    selectMotionLambda( Bool bSad, Int iAdd, Bool bIsTransquantBypass )
+  {
+    const Double motionLambda = (bSad ? m_dLambdaMotionSAD[(bIsTransquantBypass && m_costMode==COST_MIXED_LOSSLESS_LOSSY_CODING) ?1:0] + iAdd : m_dLambdaMotionSSE[(bIsTransquantBypass && m_costMode==COST_MIXED_LOSSLESS_LOSSY_CODING)?1:0] + iAdd);
+    if ( motionLambda != m_motionLambda || m_mvCostOfBits.empty() )
+    {
+      m_motionLambda = motionLambda;
+      xInitMvCostOfBits();
+    }
+  }
   Void    setPredictor( TComMv& rcMv )
   {
     m_mvPredictor = rcMv;
@@ -165,6 +179,13 @@ public:
   Distortion getCost( UInt b )                 { return Distortion(( m_motionLambda * b ) / 65536.0); }
   Distortion getCostOfVectorWithPredictor( const Int x, const Int y )
   {
+    // within the table range, the cost is two bit-count loads and one cost load
+    const Int iOffsetX = ( x << m_iCostScale ) - m_mvPredictor.getHor();
+    const Int iOffsetY = ( y << m_iCostScale ) - m_mvPredictor.getVer();
+    if ( UInt( iOffsetX + MV_BITS_TABLE_RANGE ) <= UInt( 2 * MV_BITS_TABLE_RANGE ) && UInt( iOffsetY + MV_BITS_TABLE_RANGE ) <= UInt( 2 * MV_BITS_TABLE_RANGE ) )
+    {
+      return m_mvCostOfBits[ s_mvBitsOfOffset[iOffsetX] + s_mvBitsOfOffset[iOffsetY] ];
+    }
     return Distortion((m_motionLambda * getBitsOfVectorWithPredictor(x, y)) / 65536.0);
   }
   UInt getBitsOfVectorWithPredictor( const Int x, const Int y )
@@ -175,6 +196,9 @@ public:
 
 private:
 
+  Void              xInitMvCostOfBits ();
+  static const UChar* xInitMvBitsOfOffset();
+
   static Distortion xGetSSE           ( DistParam* pcDtParam );
   static Distortion xGetSSE4          ( DistParam* pcDtParam );
   static Distortion xGetSSE8          ( DistParam* pcDtParam );
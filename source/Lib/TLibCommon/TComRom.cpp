@@ -42,6 +42,7 @@
 #include <iomanip>
 #include <assert.h>
 #include "TComDataCU.h"
+#include "ContextTables.h"
 #include "Debug.h"
 // ====================================================================================================================
 // Initialize / destroy functions
@@ -176,6 +177,103 @@ public:
 };
 
 // initialize ROM variables
+/** Derive the significance map context increment of a position within a coefficient group
+ * \param chanType       channel type
+ * \param contextType    significance map context set of the block (size class, or single context)
+ * \param scanType       coefficient scan type
+ * \param patternSigCtx  significance of the right and below coefficient groups
+ * \param notFirstGroup  true if the group is not the group containing DC
+ * \param posXinSubset   horizontal position within the group
+ * \param posYinSubset   vertical position within the group
+ * \returns context increment
+ */
+static UChar deriveSigCtxInc(const ChannelType chanType, const SignificanceMapContextType contextType, const COEFF_SCAN_TYPE scanType,
+                             const Int patternSigCtx, const Bool notFirstGroup, const UInt posXinSubset, const UInt posYinSubset)
+{
+  if (contextType == CONTEXT_TYPE_SINGLE)
+  {
+    //single context mode
+    return significanceMapContextSetStart[chanType][CONTEXT_TYPE_SINGLE];
+  }
+
+  if (!notFirstGroup && (posXinSubset + posYinSubset) == 0)
+  {
+    return 0; //special case for the DC context variable
+  }
+
+  if (contextType == CONTEXT_TYPE_4x4)
+  {
+    return significanceMapContextSetStart[chanType][CONTEXT_TYPE_4x4] + ctxIndMap4x4[(4 * posYinSubset) + posXinSubset];
+  }
+
+  const UInt groupWidth  = 1 << MLS_CG_LOG2_WIDTH;
+  const UInt groupHeight = 1 << MLS_CG_LOG2_HEIGHT;
+  UInt cnt = 0;
+
+  switch (patternSigCtx)
+  {
+    case 0: //neither neighbouring group is significant - first N coefficients in scan order use 2; the next few use 1; the rest use 0
+      {
+        const UInt posTotalInSubset = posXinSubset + posYinSubset;
+        cnt = (posTotalInSubset >= NEIGHBOURHOOD_00_CONTEXT_1_THRESHOLD_4x4) ? 0 : ((posTotalInSubset >= NEIGHBOURHOOD_00_CONTEXT_2_THRESHOLD_4x4) ? 1 : 2);
+      }
+      break;
+    case 1: //right group is significant, below is not - top quarter uses 2; second-from-top quarter uses 1; bottom half uses 0
+      cnt = (posYinSubset >= (groupHeight >> 1)) ? 0 : ((posYinSubset >= (groupHeight >> 2)) ? 1 : 2);
+      break;
+    case 2: //below group is significant, right is not - left quarter uses 2; second-from-left quarter uses 1; right half uses 0
+      cnt = (posXinSubset >= (groupWidth >> 1)) ? 0 : ((posXinSubset >= (groupWidth >> 2)) ? 1 : 2);
+      break;
+    default: //both neighbouring groups are significant
+      cnt = 2;
+      break;
+  }
+
+  UInt firstSignificanceMapContext = significanceMapContextSetStart[chanType][contextType];
+  if ((contextType == CONTEXT_TYPE_8x8) && (scanType != SCAN_DIAG))
+  {
+    firstSignificanceMapContext += nonDiagonalScan8x8ContextOffset[chanType];
+  }
+
+  return UChar(firstSignificanceMapContext + (notFirstGroup ? notFirstGroupNeighbourhoodContextOffset[chanType] : 0) + cnt);
+}
+
+/** Fill g_sigCtxInc. All coefficient groups of a block share the same scan within the group, so the
+ * context increment only depends on the scan position within the group and the group's parameters.
+ */
+static Void initSigCtxInc()
+{
+  const UInt groupWidth = 1 << MLS_CG_LOG2_WIDTH;
+
+  for (UInt scanTypeIndex = 0; scanTypeIndex < SCAN_NUMBER_OF_TYPES; scanTypeIndex++)
+  {
+    const COEFF_SCAN_TYPE scanType = COEFF_SCAN_TYPE(scanTypeIndex);
+    ScanGenerator groupScan(groupWidth, 1 << MLS_CG_LOG2_HEIGHT, groupWidth, scanType);
+
+    for (UInt scanPosition = 0; scanPosition < (1 << MLS_CG_SIZE); scanPosition++)
+    {
+      const UInt rasterPosition = groupScan.GetNextIndex(0, 0);
+      const UInt posXinSubset   = rasterPosition & (groupWidth - 1);
+      const UInt posYinSubset   = rasterPosition >> MLS_CG_LOG2_WIDTH;
+
+      for (UInt chanType = 0; chanType < MAX_NUM_CHANNEL_TYPE; chanType++)
+      {
+        for (UInt contextType = 0; contextType < CONTEXT_NUMBER_OF_TYPES; contextType++)
+        {
+          for (Int patternSigCtx = 0; patternSigCtx < NUM_SIG_CTX_PATTERNS; patternSigCtx++)
+          {
+            for (UInt notFirstGroup = 0; notFirstGroup < 2; notFirstGroup++)
+            {
+              g_sigCtxInc[scanType][chanType][contextType][patternSigCtx][notFirstGroup][scanPosition] =
+                deriveSigCtxInc(ChannelType(chanType), SignificanceMapContextType(contextType), scanType, patternSigCtx, (notFirstGroup != 0), posXinSubset, posYinSubset);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 Void initROM()
 {
   Int i, c;
@@ -258,6 +356,8 @@ Void initROM()
       //--------------------------------------------------------------------------------------------------
     }
   }
+
+  initSigCtxInc();
 }
 
 Void destroyROM()
@@ -586,6 +686,8 @@ UInt64 g_nSymbolCounter = 0;
 // scanning order table
 UInt* g_scanOrder[SCAN_NUMBER_OF_GROUP_TYPES][SCAN_NUMBER_OF_TYPES][ MAX_CU_DEPTH ][ MAX_CU_DEPTH ];
 
+UChar g_sigCtxInc[SCAN_NUMBER_OF_TYPES][MAX_NUM_CHANNEL_TYPE][CONTEXT_NUMBER_OF_TYPES][NUM_SIG_CTX_PATTERNS][2][1 << MLS_CG_SIZE];
+
 const UInt ctxIndMap4x4[4*4] =
 {
   0, 1, 4, 5,
@@ -102,6 +102,10 @@ extern const UChar  g_aucChromaScale[NUM_CHROMA_FORMAT][chromaQPMappingTableSize
 
 extern const UInt   ctxIndMap4x4[4*4];
 
+// significance map context increment (as returned by TComTrQuant::getSigCtxInc) per scan position within a coefficient group,
+// indexed by scan type, channel type, context type, patternSigCtx and whether the group is not the first (DC) group
+extern       UChar  g_sigCtxInc[SCAN_NUMBER_OF_TYPES][MAX_NUM_CHANNEL_TYPE][CONTEXT_NUMBER_OF_TYPES][NUM_SIG_CTX_PATTERNS][2][1 << MLS_CG_SIZE];
+
 extern const UInt   g_uiGroupIdx[ MAX_TU_SIZE ];
 extern const UInt   g_uiMinInGroup[ LAST_SIGNIFICANT_GROUPS ];
 
@@ -103,27 +103,17 @@ const SAOBlkParam& SAOBlkParam::operator= (const SAOBlkParam& src)
 
 TComSampleAdaptiveOffset::TComSampleAdaptiveOffset()
 {
-  m_tempPicYuv = NULL;
-  m_lineBufWidth = 0;
-  m_signLineBuf1 = NULL;
-  m_signLineBuf2 = NULL;
+  m_pcThreadPool = NULL;
+  for(Int compIdx = 0; compIdx < MAX_NUM_COMPONENT; compIdx++)
+  {
+    m_ctuRowBoundaryLines[compIdx] = NULL;
+  }
 }
 
 
 TComSampleAdaptiveOffset::~TComSampleAdaptiveOffset()
 {
   destroy();
-
-  if (m_signLineBuf1)
-  {
-    delete[] m_signLineBuf1;
-    m_signLineBuf1 = NULL;
-  }
-  if (m_signLineBuf2)
-  {
-    delete[] m_signLineBuf2;
-    m_signLineBuf2 = NULL;
-  }
 }
 
 Void TComSampleAdaptiveOffset::create( Int picWidth, Int picHeight, ChromaFormat format, UInt maxCUWidth, UInt maxCUHeight, UInt maxCUDepth, UInt lumaBitShift, UInt chromaBitShift )
@@ -140,11 +130,12 @@ Void TComSampleAdaptiveOffset::create( Int picWidth, Int picHeight, ChromaFormat
   m_numCTUInHeight  = (m_picHeight/m_maxCUHeight) + ((m_picHeight % m_maxCUHeight)?1:0);
   m_numCTUsPic      = m_numCTUInHeight*m_numCTUInWidth;
 
-  //temporary picture buffer
-  if ( !m_tempPicYuv )
+  //first and last deblocked line of every CTU row, one sample padding on both sides
+  for(Int compIdx = 0; compIdx < getNumberValidComponents(m_chromaFormatIDC); compIdx++)
   {
-    m_tempPicYuv = new TComPicYuv;
-    m_tempPicYuv->create( m_picWidth, m_picHeight, m_chromaFormatIDC, m_maxCUWidth, m_maxCUHeight, maxCUDepth, true );
+    const ComponentID component = ComponentID(compIdx);
+    m_ctuRowBufStride[compIdx] = (m_picWidth >> getComponentScaleX(component, m_chromaFormatIDC)) + 2;
+    m_ctuRowBoundaryLines[compIdx] = new Pel[2*m_numCTUInHeight*m_ctuRowBufStride[compIdx]];
   }
 
   //bit-depth related
@@ -156,14 +147,93 @@ Void TComSampleAdaptiveOffset::create( Int picWidth, Int picHeight, ChromaFormat
 
 Void TComSampleAdaptiveOffset::destroy()
 {
-  if ( m_tempPicYuv )
+  xDestroyJobBuffers();
+
+  for(Int compIdx = 0; compIdx < MAX_NUM_COMPONENT; compIdx++)
   {
-    m_tempPicYuv->destroy();
-    delete m_tempPicYuv;
-    m_tempPicYuv = NULL;
+    if (m_ctuRowBoundaryLines[compIdx])
+    {
+      delete[] m_ctuRowBoundaryLines[compIdx];
+      m_ctuRowBoundaryLines[compIdx] = NULL;
+    }
   }
 }
 
+/** Allocate the sign line buffers and the CTU row buffer of every job up to numJobs
+ */
+Void TComSampleAdaptiveOffset::xCreateJobBuffers(Int numJobs)
+{
+  const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
+
+  while (Int(m_signLineBuf1.size()) < numJobs)
+  {
+    m_signLineBuf1.push_back(new SChar[m_maxCUWidth+1]);
+    m_signLineBuf2.push_back(new SChar[m_maxCUWidth+1]);
+    for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
+    {
+      const Int ctuHeight = m_maxCUHeight >> getComponentScaleY(ComponentID(compIdx), m_chromaFormatIDC);
+      m_ctuRowBuf[compIdx].push_back(new Pel[(ctuHeight+2)*m_ctuRowBufStride[compIdx]]);
+    }
+  }
+}
+
+Void TComSampleAdaptiveOffset::xDestroyJobBuffers()
+{
+  for(Int jobIdx = 0; jobIdx < Int(m_signLineBuf1.size()); jobIdx++)
+  {
+    delete[] m_signLineBuf1[jobIdx];
+    delete[] m_signLineBuf2[jobIdx];
+  }
+  m_signLineBuf1.clear();
+  m_signLineBuf2.clear();
+
+  for(Int compIdx = 0; compIdx < MAX_NUM_COMPONENT; compIdx++)
+  {
+    for(Int jobIdx = 0; jobIdx < Int(m_ctuRowBuf[compIdx].size()); jobIdx++)
+    {
+      delete[] m_ctuRowBuf[compIdx][jobIdx];
+    }
+    m_ctuRowBuf[compIdx].clear();
+  }
+}
+
+/** Call processRow for every CTU row of the picture, in parallel when there is a thread pool.
+ * Every job takes the next row not processed yet and passes its own index, so that the job buffers can be used
+ * as scratch memory.
+ */
+Void TComSampleAdaptiveOffset::processCtuRows(const std::function<Void(Int ctuRow, Int jobIdx)>& processRow)
+{
+  const Int numJobs = (m_pcThreadPool != NULL) ? std::min<Int>(m_pcThreadPool->getNumThreads(), m_numCTUInHeight) : 1;
+  xCreateJobBuffers(numJobs);
+
+  if (numJobs <= 1)
+  {
+    for(Int ctuRow = 0; ctuRow < m_numCTUInHeight; ctuRow++)
+    {
+      processRow(ctuRow, 0);
+    }
+    return;
+  }
+
+  Int nextCtuRow = 0;
+  m_pcThreadPool->parallelFor(numJobs, [&](Int jobIdx)
+  {
+    while (true)
+    {
+      Int ctuRow;
+      {
+        std::lock_guard<std::mutex> lock(m_ctuRowMutex);
+        ctuRow = nextCtuRow++;
+      }
+      if (ctuRow >= m_numCTUInHeight)
+      {
+        break;
+      }
+      processRow(ctuRow, jobIdx);
+    }
+  });
+}
+
 Void TComSampleAdaptiveOffset::invertQuantOffsets(ComponentID compIdx, Int typeIdc, Int typeAuxInfo, Int* dstOffsets, Int* srcOffsets)
 {
   Int codedOffset[MAX_NUM_SAO_CLASSES];
@@ -312,27 +382,9 @@ Void TComSampleAdaptiveOffset::reconstructBlkSAOParams(TComPic* pic, SAOBlkParam
 
 Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeIdx, Int* offset
                                           , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
-                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail)
+                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                                          , SChar* signLineBuf1, SChar* signLineBuf2)
 {
-  if(m_lineBufWidth != m_maxCUWidth)
-  {
-    m_lineBufWidth = m_maxCUWidth;
-
-    if (m_signLineBuf1)
-    {
-      delete[] m_signLineBuf1;
-      m_signLineBuf1 = NULL;
-    }
-    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
-
-    if (m_signLineBuf2)
-    {
-      delete[] m_signLineBuf2;
-      m_signLineBuf2 = NULL;
-    }
-    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
-  }
-
   const Int maxSampleValueIncl = (1<< channelBitDepth )-1;
 
   Int x,y, startX, startY, endX, endY, edgeType;
@@ -369,7 +421,7 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   case SAO_TYPE_EO_90:
     {
       offset += 2;
-      SChar *signUpLine = m_signLineBuf1;
+      SChar *signUpLine = signLineBuf1;
 
       startY = isAboveAvail ? 0 : 1;
       endY   = isBelowAvail ? height : height-1;
@@ -409,8 +461,8 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
       offset += 2;
       SChar *signUpLine, *signDownLine, *signTmpLine;
 
-      signUpLine  = m_signLineBuf1;
-      signDownLine= m_signLineBuf2;
+      signUpLine  = signLineBuf1;
+      signDownLine= signLineBuf2;
 
       startX = isLeftAvail ? 0 : 1 ;
       endX   = isRightAvail ? width : (width-1);
@@ -474,7 +526,7 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   case SAO_TYPE_EO_45:
     {
       offset += 2;
-      SChar *signUpLine = m_signLineBuf1+1;
+      SChar *signUpLine = signLineBuf1+1;
 
       startX = isLeftAvail ? 0 : 1;
       endX   = isRightAvail ? width : (width -1);
@@ -551,7 +603,10 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   }
 }
 
-Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic)
+/** Apply the SAO offsets of one CTU.
+ * \param jobIdx job whose CTU row buffer holds the deblocked samples of the row of the CTU
+ */
+Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic, Int jobIdx)
 {
   Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
 
@@ -592,8 +647,8 @@ Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TCom
       Int  blkXPos    = (xPos   >> componentScaleX);
       Int  blkYPos    = (yPos   >> componentScaleY);
 
-      Int  srcStride  = srcYuv->getStride(component);
-      Pel* srcBlk     = srcYuv->getAddr(component) + blkYPos*srcStride + blkXPos;
+      Int  srcStride  = m_ctuRowBufStride[compIdx];
+      Pel* srcBlk     = m_ctuRowBuf[compIdx][jobIdx] + srcStride + 1 + blkXPos;
 
       Int  resStride  = resYuv->getStride(component);
       Pel* resBlk     = resYuv->getAddr(component) + blkYPos*resStride + blkXPos;
@@ -604,6 +659,7 @@ Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TCom
                   , isAboveAvail, isBelowAvail
                   , isAboveLeftAvail, isAboveRightAvail
                   , isBelowLeftAvail, isBelowRightAvail
+                  , m_signLineBuf1[jobIdx], m_signLineBuf2[jobIdx]
                   );
     }
   } //compIdx
@@ -627,13 +683,85 @@ Void TComSampleAdaptiveOffset::SAOProcess(TComPic* pDecPic)
     return;
   }
 
-  TComPicYuv* resYuv = pDecPic->getPicYuvRec();
-  TComPicYuv* srcYuv = m_tempPicYuv;
-  resYuv->copyToPic(srcYuv);
-  for(Int ctuRsAddr= 0; ctuRsAddr < m_numCTUsPic; ctuRsAddr++)
+  offsetPicture(pDecPic, pDecPic->getPicSym()->getSAOBlkParam());
+}
+
+/** Apply the SAO offsets of all CTUs to the reconstructed picture in place.
+ * Instead of a copy of the whole deblocked picture, the first and last line of every CTU row are saved, and every
+ * job copies the CTU row it filters together with the saved lines of the neighbouring rows into its own row buffer.
+ * The CTU rows can then be filtered in any order.
+ */
+Void TComSampleAdaptiveOffset::offsetPicture(TComPic* pPic, SAOBlkParam* saoBlkParams)
+{
+  const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
+  TComPicYuv* resYuv = pPic->getPicYuvRec();
+
+  for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
   {
-    offsetCTU(ctuRsAddr, srcYuv, resYuv, (pDecPic->getPicSym()->getSAOBlkParam())[ctuRsAddr], pDecPic);
-  } //ctu
+    const ComponentID component = ComponentID(compIdx);
+    const UInt componentScaleY = getComponentScaleY(component, m_chromaFormatIDC);
+    const Int  lineStride      = m_ctuRowBufStride[compIdx];
+    const Int  recStride       = resYuv->getStride(component);
+
+    for(Int ctuRow = 0; ctuRow < m_numCTUInHeight; ctuRow++)
+    {
+      const Int yPos   = ctuRow*m_maxCUHeight;
+      const Int height = std::min<Int>(m_maxCUHeight, m_picHeight - yPos);
+      Pel* rec = resYuv->getAddr(component) + (yPos >> componentScaleY)*recStride - 1;
+      ::memcpy(m_ctuRowBoundaryLines[compIdx] + (2*ctuRow  )*lineStride, rec, sizeof(Pel)*lineStride);
+      ::memcpy(m_ctuRowBoundaryLines[compIdx] + (2*ctuRow+1)*lineStride, rec + ((height >> componentScaleY) - 1)*recStride, sizeof(Pel)*lineStride);
+    }
+  }
+
+  processCtuRows([&](Int ctuRow, Int jobIdx)
+  {
+    Bool bAllOff = true;
+    for(Int ctuRsAddr = ctuRow*m_numCTUInWidth; ctuRsAddr < (ctuRow+1)*m_numCTUInWidth; ctuRsAddr++)
+    {
+      for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
+      {
+        if (saoBlkParams[ctuRsAddr][compIdx].modeIdc != SAO_MODE_OFF)
+        {
+          bAllOff = false;
+        }
+      }
+    }
+    if (bAllOff)
+    {
+      return;
+    }
+
+    //deblocked samples of the row, the last line of the row above and the first line of the row below
+    for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
+    {
+      const ComponentID component = ComponentID(compIdx);
+      const UInt componentScaleY = getComponentScaleY(component, m_chromaFormatIDC);
+      const Int  lineStride      = m_ctuRowBufStride[compIdx];
+      const Int  recStride       = resYuv->getStride(component);
+      const Int  yPos            = ctuRow*m_maxCUHeight;
+      const Int  height          = std::min<Int>(m_maxCUHeight, m_picHeight - yPos) >> componentScaleY;
+      const Pel* rec             = resYuv->getAddr(component) + (yPos >> componentScaleY)*recStride - 1;
+      Pel*       rowBuf          = m_ctuRowBuf[compIdx][jobIdx];
+
+      if (ctuRow > 0)
+      {
+        ::memcpy(rowBuf, m_ctuRowBoundaryLines[compIdx] + (2*ctuRow-1)*lineStride, sizeof(Pel)*lineStride);
+      }
+      for(Int y = 0; y < height; y++)
+      {
+        ::memcpy(rowBuf + (y+1)*lineStride, rec + y*recStride, sizeof(Pel)*lineStride);
+      }
+      if (ctuRow < m_numCTUInHeight-1)
+      {
+        ::memcpy(rowBuf + (height+1)*lineStride, m_ctuRowBoundaryLines[compIdx] + (2*ctuRow+2)*lineStride, sizeof(Pel)*lineStride);
+      }
+    }
+
+    for(Int ctuRsAddr = ctuRow*m_numCTUInWidth; ctuRsAddr < (ctuRow+1)*m_numCTUInWidth; ctuRsAddr++)
+    {
+      offsetCTU(ctuRsAddr, resYuv, saoBlkParams[ctuRsAddr], pPic, jobIdx);
+    }
+  });
 }
 
 
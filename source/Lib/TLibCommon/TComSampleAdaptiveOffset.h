@@ -40,6 +40,11 @@
 
 #include "CommonDef.h"
 #include "TComPic.h"
+#include "TComThreadPool.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
 
 //! \ingroup TLibCommon
 //! \{
@@ -71,20 +76,23 @@ public:
   Void reconstructBlkSAOParams(TComPic* pic, SAOBlkParam* saoBlkParams);
   Void PCMLFDisableProcess (TComPic* pcPic);
   static Int getMaxOffsetQVal(const Int channelBitDepth) { return (1<<(std::min<Int>(channelBitDepth,MAX_SAO_TRUNCATED_BITDEPTH)-5))-1; } //Table 9-32, inclusive
+  Void setThreadPool(TComThreadPool* pcThreadPool) { m_pcThreadPool = pcThreadPool; }
 
 protected:
   Void offsetBlock(const Int channelBitDepth, Int typeIdx, Int* offset, Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
-                  , Bool isLeftAvail, Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail);
+                  , Bool isLeftAvail, Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                  , SChar* signLineBuf1, SChar* signLineBuf2);
   Void invertQuantOffsets(ComponentID compIdx, Int typeIdc, Int typeAuxInfo, Int* dstOffsets, Int* srcOffsets);
   Void reconstructBlkSAOParam(SAOBlkParam& recParam, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES]);
   Int  getMergeList(TComPic* pic, Int ctuRsAddr, SAOBlkParam* blkParams, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES]);
-  Void offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic);
+  Void offsetCTU(Int ctuRsAddr, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic, Int jobIdx);
+  Void offsetPicture(TComPic* pPic, SAOBlkParam* saoBlkParams);
+  Void processCtuRows(const std::function<Void(Int ctuRow, Int jobIdx)>& processRow);
   Void xPCMRestoration(TComPic* pcPic);
   Void xPCMCURestoration ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth );
   Void xPCMSampleRestoration (TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, const ComponentID compID);
 protected:
   UInt m_offsetStepLog2[MAX_NUM_COMPONENT]; //offset step
-  TComPicYuv*   m_tempPicYuv; //temporary buffer
   Int m_picWidth;
   Int m_picHeight;
   Int m_maxCUWidth;
@@ -94,12 +102,19 @@ protected:
   Int m_numCTUsPic;
 
 
-  Int m_lineBufWidth;
-  SChar* m_signLineBuf1;
-  SChar* m_signLineBuf2;
+  std::vector<SChar*> m_signLineBuf1; //[job]
+  std::vector<SChar*> m_signLineBuf2; //[job]
   ChromaFormat m_chromaFormatIDC;
+  TComThreadPool* m_pcThreadPool;
 private:
+  Void xCreateJobBuffers(Int numJobs);
+  Void xDestroyJobBuffers();
+
   Bool m_picSAOEnabled[MAX_NUM_COMPONENT];
+  Int m_ctuRowBufStride[MAX_NUM_COMPONENT];
+  std::vector<Pel*> m_ctuRowBuf[MAX_NUM_COMPONENT]; //[job], deblocked samples of one CTU row with one line above and below
+  Pel* m_ctuRowBoundaryLines[MAX_NUM_COMPONENT]; //deblocked first and last line of every CTU row
+  std::mutex m_ctuRowMutex;
 };
 
 //! \}
@@ -0,0 +1,166 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.cpp
+    \brief    fixed-size worker thread pool
+*/
+
+#include "TComThreadPool.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Constructor / destructor / create / destroy
+// ====================================================================================================================
+
+TComThreadPool::TComThreadPool()
+: m_bStop (false)
+{
+}
+
+TComThreadPool::~TComThreadPool()
+{
+  destroy();
+}
+
+Void TComThreadPool::create( Int iNumThreads )
+{
+  assert( m_acThreads.empty() );
+  m_bStop = false;
+  for ( Int i = 1; i < iNumThreads; i++ )
+  {
+    m_acThreads.push_back( std::thread( &TComThreadPool::xWorkerLoop, this ) );
+  }
+}
+
+Void TComThreadPool::destroy()
+{
+  {
+    std::lock_guard<std::mutex> cLock( m_cMutex );
+    m_bStop = true;
+  }
+  m_cWorkAvailable.notify_all();
+  for ( UInt i = 0; i < m_acThreads.size(); i++ )
+  {
+    m_acThreads[i].join();
+  }
+  m_acThreads.clear();
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+/** Execute a batch of jobs
+ * The calling thread takes part in the execution, so parallelFor() may be called from within a job without dead-locking
+ * the pool.
+ * \param iNumJobs number of jobs of the batch
+ * \param rcJob    job function, called with the job index
+ */
+Void TComThreadPool::parallelFor( Int iNumJobs, const JobFunc& rcJob )
+{
+  if ( m_acThreads.empty() || iNumJobs < 2 )
+  {
+    for ( Int i = 0; i < iNumJobs; i++ )
+    {
+      rcJob( i );
+    }
+    return;
+  }
+
+  JobBatch cBatch;
+  cBatch.pJob     = &rcJob;
+  cBatch.iNumJobs = iNumJobs;
+  cBatch.iNextJob = 0;
+  cBatch.iNumDone = 0;
+
+  std::unique_lock<std::mutex> cLock( m_cMutex );
+  m_apcBatches.push_back( &cBatch );
+  m_cWorkAvailable.notify_all();
+
+  while ( cBatch.iNextJob < cBatch.iNumJobs )
+  {
+    xRunJob( &cBatch, cLock );
+  }
+  m_cBatchDone.wait( cLock, [&cBatch]{ return cBatch.iNumDone == cBatch.iNumJobs; } );
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+Void TComThreadPool::xWorkerLoop()
+{
+  std::unique_lock<std::mutex> cLock( m_cMutex );
+  while ( true )
+  {
+    m_cWorkAvailable.wait( cLock, [this]{ return m_bStop || !m_apcBatches.empty(); } );
+    if ( m_apcBatches.empty() )
+    {
+      return;
+    }
+    xRunJob( m_apcBatches.front(), cLock );
+  }
+}
+
+/** Take the next job of a batch and run it with the pool mutex released
+ * \param pcBatch batch with at least one job not started yet
+ * \param rcLock  lock of the pool mutex, held on entry and on exit
+ */
+Void TComThreadPool::xRunJob( JobBatch* pcBatch, std::unique_lock<std::mutex>& rcLock )
+{
+  const Int iJob = pcBatch->iNextJob++;
+  if ( pcBatch->iNextJob == pcBatch->iNumJobs )
+  {
+    for ( std::deque<JobBatch*>::iterator it = m_apcBatches.begin(); it != m_apcBatches.end(); it++ )
+    {
+      if ( *it == pcBatch )
+      {
+        m_apcBatches.erase( it );
+        break;
+      }
+    }
+  }
+
+  rcLock.unlock();
+  (*pcBatch->pJob)( iJob );
+  rcLock.lock();
+
+  if ( ++pcBatch->iNumDone == pcBatch->iNumJobs )
+  {
+    m_cBatchDone.notify_all();
+  }
+}
+
+//! \}
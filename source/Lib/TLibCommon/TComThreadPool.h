@@ -0,0 +1,98 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.h
+    \brief    fixed-size worker thread pool (header)
+*/
+
+#ifndef __TCOMTHREADPOOL__
+#define __TCOMTHREADPOOL__
+
+#include "CommonDef.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <deque>
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// pool of worker threads executing batches of independent jobs
+class TComThreadPool
+{
+public:
+  typedef std::function<Void(Int)> JobFunc;
+
+private:
+  typedef struct
+  {
+    const JobFunc* pJob;
+    Int            iNumJobs;
+    Int            iNextJob;
+    Int            iNumDone;
+  } JobBatch;
+
+  std::vector<std::thread>  m_acThreads;
+  std::deque<JobBatch*>     m_apcBatches;
+  std::mutex                m_cMutex;
+  std::condition_variable   m_cWorkAvailable;
+  std::condition_variable   m_cBatchDone;
+  Bool                      m_bStop;
+
+  Void xWorkerLoop();
+  Void xRunJob    ( JobBatch* pcBatch, std::unique_lock<std::mutex>& rcLock );
+
+public:
+  TComThreadPool();
+  virtual ~TComThreadPool();
+
+  /// start the pool; iNumThreads counts the calling thread, which also executes jobs
+  Void create     ( Int iNumThreads );
+  Void destroy    ();
+
+  Int  getNumThreads() const { return Int(m_acThreads.size()) + 1; }
+
+  /// run rcJob(0) .. rcJob(iNumJobs-1) on the pool and the calling thread, and return when all jobs are done
+  Void parallelFor( Int iNumJobs, const JobFunc& rcJob );
+};
+
+//! \}
+
+#endif // __TCOMTHREADPOOL__
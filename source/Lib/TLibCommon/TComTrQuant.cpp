@@ -38,8 +38,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <limits>
+#include <algorithm>
 #include <memory.h>
 #include "TComTrQuant.h"
+#include "TComTrQuantSIMD.h"
 #include "TComPic.h"
 #include "ContextTables.h"
 #include "TComTU.h"
@@ -130,6 +132,7 @@ TComTrQuant::TComTrQuant()
 
   // allocate bit estimation class  (for RDOQ)
   m_pcEstBitsSbac = new estBitsSbacStruct;
+  m_useFastRDOQ   = false;
   initScalingList();
 }
 
@@ -847,7 +850,51 @@ Void partialButterflyInverse32(TCoeff *src, TCoeff *dst, Int shift, Int line, co
   }
 }
 
+/** set the partial butterflies above, the reference of the SIMD versions
+ */
+Void setTransformFunctionsC( TransformFunctions &functions )
+{
+  functions.partialButterfly       [0] = partialButterfly4;
+  functions.partialButterfly       [1] = partialButterfly8;
+  functions.partialButterfly       [2] = partialButterfly16;
+  functions.partialButterfly       [3] = partialButterfly32;
+  functions.partialButterflyInverse[0] = partialButterflyInverse4;
+  functions.partialButterflyInverse[1] = partialButterflyInverse8;
+  functions.partialButterflyInverse[2] = partialButterflyInverse16;
+  functions.partialButterflyInverse[3] = partialButterflyInverse32;
+  functions.fastForwardDst             = fastForwardDst;
+  functions.fastInverseDst             = fastInverseDst;
+}
+
+/** 1D transforms for the instruction sets of the CPU: the partial butterflies above, or their SSE4.1/AVX2
+ *  versions, which give identical results
+ */
+static TransformFunctions selectTransformFunctions()
+{
+  TransformFunctions functions;
+  setTransformFunctionsC(functions);
+#if TRANSFORM_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1"))
+  {
+    setTransformFunctionsSSE41(functions);
+    if (__builtin_cpu_supports("avx2"))
+    {
+      setTransformFunctionsAVX2(functions);
+    }
+  }
+#endif
+  return functions;
+}
+
+const TransformFunctions& getTransformFunctions()
+{
+  static const TransformFunctions functions = selectTransformFunctions();
+  return functions;
+}
+
 /** MxN forward transform (2D)
+*  \param functions             [in]  1D transforms
 *  \param bitDepth              [in]  bit depth
 *  \param block                 [in]  residual block
 *  \param coeff                 [out] transform coefficients
@@ -857,7 +904,7 @@ Void partialButterflyInverse32(TCoeff *src, TCoeff *dst, Int shift, Int line, co
 *  \param maxLog2TrDynamicRange [in]
 
 */
-Void xTrMxN(Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange)
+Void xTrMxN(const TransformFunctions &functions, Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange)
 {
   const Int TRANSFORM_MATRIX_SHIFT = g_transformMatrixShift[TRANSFORM_FORWARD];
 
@@ -875,18 +922,18 @@ Void xTrMxN(Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight,
       {
         if ((iHeight == 4) && useDST)    // Check for DCT or DST
         {
-           fastForwardDst( block, tmp, shift_1st );
+           functions.fastForwardDst( block, tmp, shift_1st );
         }
         else
         {
-          partialButterfly4 ( block, tmp, shift_1st, iHeight );
+          functions.partialButterfly[0]( block, tmp, shift_1st, iHeight );
         }
       }
       break;
 
-    case 8:     partialButterfly8 ( block, tmp, shift_1st, iHeight );  break;
-    case 16:    partialButterfly16( block, tmp, shift_1st, iHeight );  break;
-    case 32:    partialButterfly32( block, tmp, shift_1st, iHeight );  break;
+    case 8:     functions.partialButterfly[1]( block, tmp, shift_1st, iHeight );  break;
+    case 16:    functions.partialButterfly[2]( block, tmp, shift_1st, iHeight );  break;
+    case 32:    functions.partialButterfly[3]( block, tmp, shift_1st, iHeight );  break;
     default:
       assert(0); exit (1); break;
   }
@@ -897,18 +944,18 @@ Void xTrMxN(Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight,
       {
         if ((iWidth == 4) && useDST)    // Check for DCT or DST
         {
-          fastForwardDst( tmp, coeff, shift_2nd );
+          functions.fastForwardDst( tmp, coeff, shift_2nd );
         }
         else
         {
-          partialButterfly4 ( tmp, coeff, shift_2nd, iWidth );
+          functions.partialButterfly[0]( tmp, coeff, shift_2nd, iWidth );
         }
       }
       break;
 
-    case 8:     partialButterfly8 ( tmp, coeff, shift_2nd, iWidth );    break;
-    case 16:    partialButterfly16( tmp, coeff, shift_2nd, iWidth );    break;
-    case 32:    partialButterfly32( tmp, coeff, shift_2nd, iWidth );    break;
+    case 8:     functions.partialButterfly[1]( tmp, coeff, shift_2nd, iWidth );    break;
+    case 16:    functions.partialButterfly[2]( tmp, coeff, shift_2nd, iWidth );    break;
+    case 32:    functions.partialButterfly[3]( tmp, coeff, shift_2nd, iWidth );    break;
     default:
       assert(0); exit (1); break;
   }
@@ -916,6 +963,7 @@ Void xTrMxN(Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight,
 
 
 /** MxN inverse transform (2D)
+*  \param functions             [in]  1D transforms
 *  \param bitDepth              [in]  bit depth
 *  \param coeff                 [in]  transform coefficients
 *  \param block                 [out] residual block
@@ -924,7 +972,7 @@ Void xTrMxN(Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight,
 *  \param useDST                [in]
 *  \param maxLog2TrDynamicRange [in]
 */
-Void xITrMxN(Int bitDepth, TCoeff *coeff, TCoeff *block, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange)
+Void xITrMxN(const TransformFunctions &functions, Int bitDepth, TCoeff *coeff, TCoeff *block, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange)
 {
   const Int TRANSFORM_MATRIX_SHIFT = g_transformMatrixShift[TRANSFORM_INVERSE];
 
@@ -944,18 +992,18 @@ Void xITrMxN(Int bitDepth, TCoeff *coeff, TCoeff *block, Int iWidth, Int iHeight
       {
         if ((iWidth == 4) && useDST)    // Check for DCT or DST
         {
-          fastInverseDst( coeff, tmp, shift_1st, clipMinimum, clipMaximum);
+          functions.fastInverseDst( coeff, tmp, shift_1st, clipMinimum, clipMaximum);
         }
         else
         {
-          partialButterflyInverse4 ( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum);
+          functions.partialButterflyInverse[0]( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum);
         }
       }
       break;
 
-    case  8: partialButterflyInverse8 ( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
-    case 16: partialButterflyInverse16( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
-    case 32: partialButterflyInverse32( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
+    case  8: functions.partialButterflyInverse[1]( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
+    case 16: functions.partialButterflyInverse[2]( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
+    case 32: functions.partialButterflyInverse[3]( coeff, tmp, shift_1st, iWidth, clipMinimum, clipMaximum); break;
 
     default:
       assert(0); exit (1); break;
@@ -968,18 +1016,18 @@ Void xITrMxN(Int bitDepth, TCoeff *coeff, TCoeff *block, Int iWidth, Int iHeight
       {
         if ((iHeight == 4) && useDST)    // Check for DCT or DST
         {
-          fastInverseDst( tmp, block, shift_2nd, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max() );
+          functions.fastInverseDst( tmp, block, shift_2nd, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max() );
         }
         else
         {
-          partialButterflyInverse4 ( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max());
+          functions.partialButterflyInverse[0]( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max());
         }
       }
       break;
 
-    case  8: partialButterflyInverse8 ( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
-    case 16: partialButterflyInverse16( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
-    case 32: partialButterflyInverse32( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
+    case  8: functions.partialButterflyInverse[1]( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
+    case 16: functions.partialButterflyInverse[2]( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
+    case 32: functions.partialButterflyInverse[3]( tmp, block, shift_2nd, iHeight, std::numeric_limits<Pel>::min(), std::numeric_limits<Pel>::max()); break;
 
     default:
       assert(0); exit (1); break;
@@ -1156,11 +1204,22 @@ Void TComTrQuant::xQuant(       TComTU       &rTu,
     if ( !m_useSelectiveRDOQ || xNeedRDOQ( rTu, piCoef, compID, cQP ) )
     {
 #endif
+      if ( m_useFastRDOQ )
+      {
+#if ADAPTIVE_QP_SELECTION
+        xRateDistOptQuantFast( rTu, piCoef, pDes, pArlDes, uiAbsSum, compID, cQP );
+#else
+        xRateDistOptQuantFast( rTu, piCoef, pDes, uiAbsSum, compID, cQP );
+#endif
+      }
+      else
+      {
 #if ADAPTIVE_QP_SELECTION
-      xRateDistOptQuant( rTu, piCoef, pDes, pArlDes, uiAbsSum, compID, cQP );
+        xRateDistOptQuant( rTu, piCoef, pDes, pArlDes, uiAbsSum, compID, cQP );
 #else
-      xRateDistOptQuant( rTu, piCoef, pDes, uiAbsSum, compID, cQP );
+        xRateDistOptQuant( rTu, piCoef, pDes, uiAbsSum, compID, cQP );
 #endif
+      }
 #if T0196_SELECTIVE_RDOQ
     }
     else
@@ -1544,6 +1603,127 @@ Void TComTrQuant::transformNxN(       TComTU        & rTu,
 }
 
 
+/** Early detection of a TU whose transform coefficients all quantise to zero
+ * \param rTu        reference to transform data
+ * \param compID     colour component ID
+ * \param pcResidual residual of the TU
+ * \param uiStride   stride of the residual
+ * \param cQP        reference to quantization parameters
+ * \param mode       detection mode
+ * \returns true if the TU can be coded with CBF=0 without being transformed
+ *
+ * The SAD of the residual is compared with a threshold derived from the QP and the TU size.
+ * The conservative mode bounds the magnitude of every coefficient of xTrMxN, rounding included, so that
+ * the TU quantises to zero both with and without RDOQ. The aggressive mode takes the DC coefficient of
+ * a residual of the same SAD (SAD/N in orthonormal units) as the estimate, against one quantisation step,
+ * since RDOQ usually drops the isolated unit levels such a TU would otherwise carry.
+ * Transform-skipped and transquant-bypass TUs are never detected.
+ */
+Bool TComTrQuant::isZeroBlock(       TComTU        & rTu,
+                               const ComponentID     compID,
+                               const Pel          *  pcResidual,
+                               const UInt            uiStride,
+                               const QpParam       & cQP,
+                               const ZeroBlockDetectionMode mode
+                             )
+{
+  TComDataCU          *pcCU         = rTu.getCU();
+  const UInt           uiAbsPartIdx = rTu.GetAbsPartIdxTU();
+  const TComRectangle &rect         = rTu.getRect(compID);
+  const UInt           uiWidth      = rect.width;
+  const UInt           uiHeight     = rect.height;
+
+  if ((mode == ZERO_BLOCK_DETECTION_OFF) || (uiWidth != uiHeight) || pcCU->getCUTransquantBypass(uiAbsPartIdx) || (pcCU->getTransformSkip(uiAbsPartIdx, compID) != 0))
+  {
+    return false;
+  }
+
+  Int64 iSAD = 0;
+  for (UInt y = 0; y < uiHeight; y++, pcResidual += uiStride)
+  {
+    for (UInt x = 0; x < uiWidth; x++)
+    {
+      iSAD += abs(pcResidual[x]);
+    }
+  }
+
+  if (iSAD == 0)
+  {
+    return true;
+  }
+
+  const Int  channelBitDepth       = pcCU->getSlice()->getSPS()->getBitDepth(toChannelType(compID));
+  const Int  maxLog2TrDynamicRange = pcCU->getSlice()->getSPS()->getMaxLog2TrDynamicRange(toChannelType(compID));
+  const UInt uiLog2TrSize          = g_aucConvertToBit[ uiWidth ] + 2;
+
+  // largest quantisation coefficient of the TU
+  Int64 iQuantCoef = g_quantScales[cQP.rem];
+  if (getUseScalingList(uiWidth, uiHeight, false))
+  {
+    const Int        scalingListType = getScalingListType(pcCU->getPredictionMode(uiAbsPartIdx), compID);
+    const Int *const piQCoef         = getQuantCoeff(scalingListType, cQP.rem, (uiLog2TrSize-2));
+    iQuantCoef = *std::max_element(piQCoef, piQCoef + (uiWidth * uiHeight));
+  }
+
+  if (mode == ZERO_BLOCK_DETECTION_CONSERVATIVE)
+  {
+    // a level is zero when |coeff| * Q < 2^(iQBits-1) (see xQuant and xRateDistOptQuant)
+    const Int iQBits = QUANT_SHIFT + cQP.per + getTransformShift(channelBitDepth, uiLog2TrSize, maxLog2TrDynamicRange);
+
+    // no basis function of the forward transform exceeds sqrt(2) * 2^TRANSFORM_MATRIX_SHIFT in magnitude
+    const Int   TRANSFORM_MATRIX_SHIFT = g_transformMatrixShift[TRANSFORM_FORWARD];
+    const Int64 maxBasis               = Int64(ceil(Double(1 << TRANSFORM_MATRIX_SHIFT) * sqrt(2.0)));
+    const Int   shift_1st              = (uiLog2TrSize + channelBitDepth + TRANSFORM_MATRIX_SHIFT) - maxLog2TrDynamicRange;
+    const Int   shift_2nd              = uiLog2TrSize + TRANSFORM_MATRIX_SHIFT;
+    const Int64 add_1st                = (shift_1st > 0) ? (Int64(1) << (shift_1st - 1)) : 0;
+    const Int64 add_2nd                = Int64(1) << (shift_2nd - 1);
+
+    // each stage of xTrMxN rounds towards minus infinity, adding at most one to the magnitude of its outputs
+    const Int64 maxFirstStageSum       = ((maxBasis * iSAD + (uiHeight * add_1st)) >> shift_1st) + uiHeight;
+    const Int64 maxCoeff               = ((maxBasis * maxFirstStageSum + add_2nd) >> shift_2nd) + 1;
+
+    return (maxCoeff * iQuantCoef) < (Int64(1) << (iQBits - 1));
+  }
+  else
+  {
+    // SAD * 2^iTransformShift / N * Q < 2^iQBits, with iQBits = QUANT_SHIFT + per + iTransformShift
+    return (iSAD * iQuantCoef) < (Int64(uiWidth) << (QUANT_SHIFT + cQP.per));
+  }
+}
+
+
+/** Set a TU to all-zero levels, leaving the CU in the state transformNxN leaves it in when the TU quantises to zero
+ * \param rTu      reference to transform data
+ * \param compID   colour component ID
+ * \param rpcCoeff coefficient buffer of the TU
+ * \param pcArlCoeff adaptive reconstruction level buffer of the TU
+ * \param uiAbsSum absolute sum of the levels, set to zero
+ */
+Void TComTrQuant::setZeroBlock(       TComTU        & rTu,
+                                const ComponentID     compID,
+                                      TCoeff       *  rpcCoeff,
+#if ADAPTIVE_QP_SELECTION
+                                      TCoeff       *  pcArlCoeff,
+#endif
+                                      TCoeff        & uiAbsSum
+                              )
+{
+  TComDataCU          *pcCU         = rTu.getCU();
+  const UInt           uiAbsPartIdx = rTu.GetAbsPartIdxTU();
+  const UInt           uiNumParts   = rTu.GetAbsPartIdxNumParts(compID);
+  const TComRectangle &rect         = rTu.getRect(compID);
+
+  memset( rpcCoeff, 0, sizeof(TCoeff) * rect.width * rect.height );
+#if ADAPTIVE_QP_SELECTION
+  memset( pcArlCoeff, 0, sizeof(TCoeff) * rect.width * rect.height );
+#endif
+  uiAbsSum = 0;
+
+  pcCU->setExplicitRdpcmModePartRange(RDPCM_OFF, compID, uiAbsPartIdx, uiNumParts);
+  pcCU->setCbfPartRange(0, compID, uiAbsPartIdx, uiNumParts);
+}
+
+
 Void TComTrQuant::invTransformNxN(      TComTU        &rTu,
                                   const ComponentID    compID,
                                         Pel          *pcResidual,
@@ -1970,7 +2150,7 @@ Void TComTrQuant::xT( const Int channelBitDepth, Bool useDST, Pel* piBlkResi, UI
     }
   }
 
-  xTrMxN( channelBitDepth, block, coeff, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
+  xTrMxN( getTransformFunctions(), channelBitDepth, block, coeff, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
 
   memcpy(psCoeff, coeff, (iWidth * iHeight * sizeof(TCoeff)));
 }
@@ -2000,7 +2180,7 @@ Void TComTrQuant::xIT( const Int channelBitDepth, Bool useDST, TCoeff* plCoef, P
 
   memcpy(coeff, plCoef, (iWidth * iHeight * sizeof(TCoeff)));
 
-  xITrMxN( channelBitDepth, coeff, block, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
+  xITrMxN( getTransformFunctions(), channelBitDepth, coeff, block, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
 
   for (Int y = 0; y < iHeight; y++)
   {
@@ -2166,7 +2346,6 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
         UInt uiGoRiceParam                     = initialGolombRiceParameter;
   Double     d64BlockUncodedCost               = 0;
   const UInt uiLog2BlockWidth                  = g_aucConvertToBit[ uiWidth  ] + 2;
-  const UInt uiLog2BlockHeight                 = g_aucConvertToBit[ uiHeight ] + 2;
   const UInt uiMaxNumCoeff                     = uiWidth * uiHeight;
   assert(compID<MAX_NUM_COMPONENT);
 
@@ -2199,7 +2378,6 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
   const Int    defaultQuantisationCoefficient = g_quantScales[cQP.rem];
   const Double defaultErrorScale              = getErrScaleCoeffNoScalingList(scalingListType, (uiLog2TrSize-2), cQP.rem);
 
-  const TCoeff entropyCodingMinimum = -(1 << maxLog2TrDynamicRange);
   const TCoeff entropyCodingMaximum =  (1 << maxLog2TrDynamicRange) - 1;
 
 #if ADAPTIVE_QP_SELECTION
@@ -2242,7 +2420,8 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
 
     memset( &rdStats, 0, sizeof (coeffGroupRDStats));
 
-    const Int patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
+    const Int    patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
+    const UChar *sigCtxInc     = getSigCtxIncTable(patternSigCtx, codingParameters, iCGScanPos);
 
     for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
     {
@@ -2294,7 +2473,7 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
         }
         else
         {
-          UShort uiCtxSig      = significanceMapContextOffset + getSigCtxInc( patternSigCtx, codingParameters, iScanPos, uiLog2BlockWidth, uiLog2BlockHeight, channelType );
+          UShort uiCtxSig      = significanceMapContextOffset + sigCtxInc[ iScanPosinCG ];
 
           uiLevel              = xGetCodedLevel( pdCostCoeff[ iScanPos ], pdCostCoeff0[ iScanPos ], pdCostSig[ iScanPos ],
                                                   lLevelDouble, uiMaxAbsLevel, uiCtxSig, uiOneCtx, uiAbsCtx, uiGoRiceParam,
@@ -2539,277 +2718,780 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
 
   if( pcCU->getSlice()->getPPS()->getSignHideFlag() && uiAbsSum>=2)
   {
-    const Double inverseQuantScale = Double(g_invQuantScales[cQP.rem]);
-    Int64 rdFactor = (Int64)(inverseQuantScale * inverseQuantScale * (1 << (2 * cQP.per))
-                             / m_dLambda / 16 / (1 << (2 * DISTORTION_PRECISION_ADJUSTMENT(channelBitDepth - 8)))
-                             + 0.5);
+    xRateDistOptSignHiding( rTu, plSrcCoeff, piDstCoeff, deltaU, rateIncUp, rateIncDown, sigRateDelta, codingParameters, compID, cQP );
+  }
+}
 
-    Int lastCG = -1;
-    Int absSum = 0 ;
-    Int n ;
 
-    for( Int subSet = (uiWidth*uiHeight-1) >> MLS_CG_SIZE; subSet >= 0; subSet-- )
-    {
-      Int  subPos     = subSet << MLS_CG_SIZE;
-      Int  firstNZPosInCG=uiCGSize , lastNZPosInCG=-1 ;
-      absSum = 0 ;
+/** Table-driven variant of xRateDistOptQuant, selected with the FastRDOQ option
+ * \param rTu reference to transform data
+ * \param plSrcCoeff pointer to input buffer
+ * \param piDstCoeff reference to quantized transform coefficient buffer
+ * \param piArlDstCoeff reference to adaptive reconstruction level buffer (ADAPTIVE_QP_SELECTION only)
+ * \param uiAbsSum reference to absolute sum of quantized transform coefficient
+ * \param compID colour component ID
+ * \param cQP reference to quantization parameters
+ *
+ * The decisions follow xRateDistOptQuant, with the following shortcuts:
+ * - the lambda-scaled significance, coefficient group and last position costs are tabulated once per TU,
+ * - the coefficient groups are quantised ahead of the level decision, and groups in which every level
+ *   quantises to zero are accounted for in one step, without deriving their significance contexts,
+ * - the max and max-1 level candidates are evaluated together, and their rates are reused by sign bit hiding.
+ * Only the order of the floating-point cost accumulation differs from the exact search.
+ */
+Void TComTrQuant::xRateDistOptQuantFast             (       TComTU       &rTu,
+                                                            TCoeff      * plSrcCoeff,
+                                                            TCoeff      * piDstCoeff,
+#if ADAPTIVE_QP_SELECTION
+                                                            TCoeff      * piArlDstCoeff,
+#endif
+                                                            TCoeff       &uiAbsSum,
+                                                      const ComponentID   compID,
+                                                      const QpParam      &cQP  )
+{
+  const TComRectangle  & rect             = rTu.getRect(compID);
+  const UInt             uiWidth          = rect.width;
+  const UInt             uiHeight         = rect.height;
+        TComDataCU    *  pcCU             = rTu.getCU();
+  const UInt             uiAbsPartIdx     = rTu.GetAbsPartIdxTU();
+  const ChannelType      channelType      = toChannelType(compID);
+  const UInt             uiLog2TrSize     = rTu.GetEquivalentLog2TrSize(compID);
 
-      for(n = uiCGSize-1; n >= 0; --n )
-      {
-        if( piDstCoeff[ codingParameters.scan[ n + subPos ]] )
-        {
-          lastNZPosInCG = n;
-          break;
-        }
-      }
+  const Bool             extendedPrecision = pcCU->getSlice()->getSPS()->getSpsRangeExtension().getExtendedPrecisionProcessingFlag();
+  const Int              maxLog2TrDynamicRange = pcCU->getSlice()->getSPS()->getMaxLog2TrDynamicRange(toChannelType(compID));
+  const Int              channelBitDepth = rTu.getCU()->getSlice()->getSPS()->getBitDepth(channelType);
+  const Bool             bSignHiding     = pcCU->getSlice()->getPPS()->getSignHideFlag();
 
-      for(n = 0; n <uiCGSize; n++ )
-      {
-        if( piDstCoeff[ codingParameters.scan[ n + subPos ]] )
-        {
-          firstNZPosInCG = n;
-          break;
-        }
-      }
+  Int iTransformShift = getTransformShift(channelBitDepth, uiLog2TrSize, maxLog2TrDynamicRange);
+  if ((pcCU->getTransformSkip(uiAbsPartIdx, compID) != 0) && extendedPrecision)
+  {
+    iTransformShift = std::max<Int>(0, iTransformShift);
+  }
 
-      for(n = firstNZPosInCG; n <=lastNZPosInCG; n++ )
-      {
-        absSum += Int(piDstCoeff[ codingParameters.scan[ n + subPos ]]);
-      }
+  const Bool bUseGolombRiceParameterAdaptation = pcCU->getSlice()->getSPS()->getSpsRangeExtension().getPersistentRiceAdaptationEnabledFlag();
+  const UInt initialGolombRiceParameter        = m_pcEstBitsSbac->golombRiceAdaptationStatistics[rTu.getGolombRiceStatisticsIndex(compID)] / RExt__GOLOMB_RICE_INCREMENT_DIVISOR;
+        UInt uiGoRiceParam                     = initialGolombRiceParameter;
+  Double     d64BlockUncodedCost               = 0;
+  const UInt uiLog2BlockWidth                  = g_aucConvertToBit[ uiWidth  ] + 2;
+  const UInt uiMaxNumCoeff                     = uiWidth * uiHeight;
+  assert(compID<MAX_NUM_COMPONENT);
 
-      if(lastNZPosInCG>=0 && lastCG==-1)
-      {
-        lastCG = 1;
-      }
+  Int scalingListType = getScalingListType(pcCU->getPredictionMode(uiAbsPartIdx), compID);
+  assert(scalingListType < SCALING_LIST_NUM);
 
-      if( lastNZPosInCG-firstNZPosInCG>=SBH_THRESHOLD )
-      {
-        UInt signbit = (piDstCoeff[codingParameters.scan[subPos+firstNZPosInCG]]>0?0:1);
-        if( signbit!=(absSum&0x1) )  // hide but need tune
-        {
-          // calculate the cost
-          Int64 minCostInc = std::numeric_limits<Int64>::max(), curCost = std::numeric_limits<Int64>::max();
-          Int minPos = -1, finalChange = 0, curChange = 0;
+#if ADAPTIVE_QP_SELECTION
+  memset(piArlDstCoeff, 0, sizeof(TCoeff) *  uiMaxNumCoeff);
+#endif
 
-          for( n = (lastCG==1?lastNZPosInCG:uiCGSize-1) ; n >= 0; --n )
-          {
-            UInt uiBlkPos   = codingParameters.scan[ n + subPos ];
-            if(piDstCoeff[ uiBlkPos ] != 0 )
-            {
-              Int64 costUp   = rdFactor * ( - deltaU[uiBlkPos] ) + rateIncUp[uiBlkPos];
-              Int64 costDown = rdFactor * (   deltaU[uiBlkPos] ) + rateIncDown[uiBlkPos]
-                               -   ((abs(piDstCoeff[uiBlkPos]) == 1) ? sigRateDelta[uiBlkPos] : 0);
+  Double pdCostCoeff [ MAX_TU_SIZE * MAX_TU_SIZE ];
+  Double pdCostSig   [ MAX_TU_SIZE * MAX_TU_SIZE ];
+  Double pdCostCoeff0[ MAX_TU_SIZE * MAX_TU_SIZE ];
+  Int rateIncUp   [ MAX_TU_SIZE * MAX_TU_SIZE ];
+  Int rateIncDown [ MAX_TU_SIZE * MAX_TU_SIZE ];
+  Int sigRateDelta[ MAX_TU_SIZE * MAX_TU_SIZE ];
+  TCoeff deltaU   [ MAX_TU_SIZE * MAX_TU_SIZE ];
+  if (bSignHiding)
+  {
+    memset( rateIncUp,    0, sizeof(Int   ) *  uiMaxNumCoeff );
+    memset( rateIncDown,  0, sizeof(Int   ) *  uiMaxNumCoeff );
+    memset( sigRateDelta, 0, sizeof(Int   ) *  uiMaxNumCoeff );
+    memset( deltaU,       0, sizeof(TCoeff) *  uiMaxNumCoeff );
+  }
 
-              if(lastCG==1 && lastNZPosInCG==n && abs(piDstCoeff[uiBlkPos])==1)
-              {
-                costDown -= (4<<15);
-              }
+  const Int iQBits = QUANT_SHIFT + cQP.per + iTransformShift;                   // Right shift of non-RDOQ quantizer;  level = (coeff*uiQ + offset)>>q_bits
+  const Double *const pdErrScale = getErrScaleCoeff(scalingListType, (uiLog2TrSize-2), cQP.rem);
+  const Int    *const piQCoef    = getQuantCoeff(scalingListType, cQP.rem, (uiLog2TrSize-2));
 
-              if(costUp<costDown)
-              {
-                curCost = costUp;
-                curChange =  1;
-              }
-              else
-              {
-                curChange = -1;
-                if(n==firstNZPosInCG && abs(piDstCoeff[uiBlkPos])==1)
-                {
-                  curCost = std::numeric_limits<Int64>::max();
-                }
-                else
-                {
-                  curCost = costDown;
-                }
-              }
-            }
-            else
-            {
-              curCost = rdFactor * ( - (abs(deltaU[uiBlkPos])) ) + (1<<15) + rateIncUp[uiBlkPos] + sigRateDelta[uiBlkPos] ;
-              curChange = 1 ;
+  const Bool   enableScalingLists             = getUseScalingList(uiWidth, uiHeight, (pcCU->getTransformSkip(uiAbsPartIdx, compID) != 0));
+  const Int    defaultQuantisationCoefficient = g_quantScales[cQP.rem];
+  const Double defaultErrorScale              = getErrScaleCoeffNoScalingList(scalingListType, (uiLog2TrSize-2), cQP.rem);
 
-              if(n<firstNZPosInCG)
-              {
-                UInt thissignbit = (plSrcCoeff[uiBlkPos]>=0?0:1);
-                if(thissignbit != signbit )
-                {
-                  curCost = std::numeric_limits<Int64>::max();
-                }
-              }
-            }
+  const TCoeff entropyCodingMaximum =  (1 << maxLog2TrDynamicRange) - 1;
 
-            if( curCost<minCostInc)
-            {
-              minCostInc = curCost;
-              finalChange = curChange;
-              minPos = uiBlkPos;
-            }
-          }
+#if ADAPTIVE_QP_SELECTION
+  Int iQBitsC = iQBits - ARL_C_PRECISION;
+  Int iAddC =  1 << (iQBitsC-1);
+#endif
 
-          if(piDstCoeff[minPos] == entropyCodingMaximum || piDstCoeff[minPos] == entropyCodingMinimum)
-          {
-            finalChange = -1;
-          }
+  TUEntropyCodingParameters codingParameters;
+  getTUEntropyCodingParameters(codingParameters, rTu, compID);
+  const UInt uiCGSize = (1 << MLS_CG_SIZE);
 
-          if(plSrcCoeff[minPos]>=0)
-          {
-            piDstCoeff[minPos] += finalChange ;
-          }
-          else
-          {
-            piDstCoeff[minPos] -= finalChange ;
-          }
-        }
-      }
+  //===== per-TU cost tables =====
+  const UInt significanceMapContextOffset = getSignificanceMapContextOffset(compID);
+
+  Double pdSigCost  [ NUM_SIG_FLAG_CTX    ][ 2 ];
+  Double pdSigCGCost[ NUM_SIG_CG_FLAG_CTX ][ 2 ];
+  Int    piLastRate [ 2 ][ MAX_TU_SIZE ];
 
-      if(lastCG==1)
+  {
+    const SignificanceMapContextType contextType = ((uiWidth == 4) && (uiHeight == 4)) ? CONTEXT_TYPE_4x4 : (((uiWidth == 8) && (uiHeight == 8)) ? CONTEXT_TYPE_8x8 : CONTEXT_TYPE_NxN);
+    const UInt        firstCtx    = significanceMapContextSetStart[channelType][contextType];
+    const UInt        lastCtx     = firstCtx + significanceMapContextSetSize[channelType][contextType];
+    const UInt        singleCtx   = significanceMapContextSetStart[channelType][CONTEXT_TYPE_SINGLE];
+
+    // the same contexts as are estimated by TEncSbac::estSignificantMapBit
+    for (UInt ctx = 0; ctx <= singleCtx; ctx++)
+    {
+      if ((ctx == 0) || (ctx == singleCtx) || ((ctx >= firstCtx) && (ctx < lastCtx)))
       {
-        lastCG=0 ;
+        pdSigCost[ significanceMapContextOffset + ctx ][ 0 ] = xGetRateSigCoef( 0, significanceMapContextOffset + ctx );
+        pdSigCost[ significanceMapContextOffset + ctx ][ 1 ] = xGetRateSigCoef( 1, significanceMapContextOffset + ctx );
       }
     }
-  }
-}
 
+    for (UInt ctx = 0; ctx < NUM_SIG_CG_FLAG_CTX; ctx++)
+    {
+      pdSigCGCost[ ctx ][ 0 ] = xGetRateSigCoeffGroup( 0, ctx );
+      pdSigCGCost[ ctx ][ 1 ] = xGetRateSigCoeffGroup( 1, ctx );
+    }
 
-/** Pattern decision for context derivation process of significant_coeff_flag
- * \param sigCoeffGroupFlag pointer to prior coded significant coeff group
- * \param uiCGPosX column of current coefficient group
- * \param uiCGPosY row of current coefficient group
- * \param widthInGroups width of the block
- * \param heightInGroups height of the block
- * \returns pattern for current coefficient group
- */
-Int  TComTrQuant::calcPatternSigCtx( const UInt* sigCoeffGroupFlag, UInt uiCGPosX, UInt uiCGPosY, UInt widthInGroups, UInt heightInGroups )
-{
-  if ((widthInGroups <= 1) && (heightInGroups <= 1))
-  {
-    return 0;
+    // rates of the last position prefix and suffix, indexed by the coordinate along each axis of the coded order
+    const UInt uiLastSizeX = (codingParameters.scanType == SCAN_VER) ? uiHeight : uiWidth;
+    const UInt uiLastSizeY = (codingParameters.scanType == SCAN_VER) ? uiWidth  : uiHeight;
+    for (UInt pos = 0; pos < uiLastSizeX; pos++)
+    {
+      const UInt uiCtx = g_uiGroupIdx[pos];
+      piLastRate[ 0 ][ pos ] = m_pcEstBitsSbac->lastXBits[channelType][ uiCtx ] + ((uiCtx > 3) ? (Int(xGetIEPRate()) * ((uiCtx-2)>>1)) : 0);
+    }
+    for (UInt pos = 0; pos < uiLastSizeY; pos++)
+    {
+      const UInt uiCtx = g_uiGroupIdx[pos];
+      piLastRate[ 1 ][ pos ] = m_pcEstBitsSbac->lastYBits[channelType][ uiCtx ] + ((uiCtx > 3) ? (Int(xGetIEPRate()) * ((uiCtx-2)>>1)) : 0);
+    }
   }
 
-  const Bool rightAvailable = uiCGPosX < (widthInGroups  - 1);
-  const Bool belowAvailable = uiCGPosY < (heightInGroups - 1);
+  Double pdCostCoeffGroupSig[ MLS_GRP_NUM ];
+  UInt uiSigCoeffGroupFlag[ MLS_GRP_NUM ];
+  Int iCGLastScanPos = -1;
 
-  UInt sigRight = 0;
-  UInt sigLower = 0;
+  UInt    uiCtxSet            = 0;
+  Int     c1                  = 1;
+  Int     c2                  = 0;
+  Double  d64BaseCost         = 0;
+  Int     iLastScanPos        = -1;
 
-  if (rightAvailable)
-  {
-    sigRight = ((sigCoeffGroupFlag[ (uiCGPosY * widthInGroups) + uiCGPosX + 1 ] != 0) ? 1 : 0);
-  }
-  if (belowAvailable)
+  UInt    c1Idx     = 0;
+  UInt    c2Idx     = 0;
+  Int     baseLevel;
+
+  memset( pdCostCoeffGroupSig,   0, sizeof(Double) * MLS_GRP_NUM );
+  memset( uiSigCoeffGroupFlag,   0, sizeof(UInt) * MLS_GRP_NUM );
+
+  UInt uiCGNum = uiWidth * uiHeight >> MLS_CG_SIZE;
+  Int iScanPos;
+  coeffGroupRDStats rdStats;
+
+  Intermediate_Int plLevelDouble [ 1 << MLS_CG_SIZE ];
+  UInt             puiMaxAbsLevel[ 1 << MLS_CG_SIZE ];
+  Double           pdErrorScale  [ 1 << MLS_CG_SIZE ];
+
+  for (Int iCGScanPos = uiCGNum-1; iCGScanPos >= 0; iCGScanPos--)
   {
-    sigLower = ((sigCoeffGroupFlag[ (uiCGPosY + 1) * widthInGroups + uiCGPosX ] != 0) ? 1 : 0);
-  }
+    UInt uiCGBlkPos = codingParameters.scanCG[ iCGScanPos ];
+    UInt uiCGPosY   = uiCGBlkPos / codingParameters.widthInGroups;
+    UInt uiCGPosX   = uiCGBlkPos - (uiCGPosY * codingParameters.widthInGroups);
 
-  return sigRight + (sigLower << 1);
-}
+    //===== quantization of the whole group =====
+    UInt   uiMaxAbsLevelInCG = 0;
+    Double d64UncodedCostCG  = 0;
 
+    for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
+    {
+      iScanPos = iCGScanPos*uiCGSize + iScanPosinCG;
+      const UInt   uiBlkPos                = codingParameters.scan[iScanPos];
 
-/** Context derivation process of coeff_abs_significant_flag
- * \param patternSigCtx pattern for current coefficient group
- * \param codingParameters coding parameters for the TU (includes the scan)
- * \param scanPosition current position in scan order
- * \param log2BlockWidth log2 width of the block
- * \param log2BlockHeight log2 height of the block
- * \param chanType channel type (CHANNEL_TYPE_LUMA/CHROMA)
- * \returns ctxInc for current scan position
- */
-Int TComTrQuant::getSigCtxInc    (       Int                        patternSigCtx,
-                                   const TUEntropyCodingParameters &codingParameters,
-                                   const Int                        scanPosition,
-                                   const Int                        log2BlockWidth,
-                                   const Int                        log2BlockHeight,
-                                   const ChannelType                chanType)
-{
-  if (codingParameters.firstSignificanceMapContext == significanceMapContextSetStart[chanType][CONTEXT_TYPE_SINGLE])
-  {
-    //single context mode
-    return significanceMapContextSetStart[chanType][CONTEXT_TYPE_SINGLE];
-  }
+      const Int    quantisationCoefficient = (enableScalingLists) ? piQCoef   [uiBlkPos] : defaultQuantisationCoefficient;
+      const Double errorScale              = (enableScalingLists) ? pdErrScale[uiBlkPos] : defaultErrorScale;
+
+      const Int64  tmpLevel                = Int64(abs(plSrcCoeff[ uiBlkPos ])) * quantisationCoefficient;
+
+      const Intermediate_Int lLevelDouble  = (Intermediate_Int)min<Int64>(tmpLevel, std::numeric_limits<Intermediate_Int>::max() - (Intermediate_Int(1) << (iQBits - 1)));
+
+#if ADAPTIVE_QP_SELECTION
+      if( m_bUseAdaptQpSelect )
+      {
+        piArlDstCoeff[uiBlkPos]   = (TCoeff)(( lLevelDouble + iAddC) >> iQBitsC );
+      }
+#endif
+      const UInt uiMaxAbsLevel  = std::min<UInt>(UInt(entropyCodingMaximum), UInt((lLevelDouble + (Intermediate_Int(1) << (iQBits - 1))) >> iQBits));
+
+      const Double dErr         = Double( lLevelDouble );
+      pdCostCoeff0[ iScanPos ]  = dErr * dErr * errorScale;
+      d64UncodedCostCG         += pdCostCoeff0[ iScanPos ];
+      piDstCoeff[ uiBlkPos ]    = uiMaxAbsLevel;
+
+      plLevelDouble [ iScanPosinCG ] = lLevelDouble;
+      puiMaxAbsLevel[ iScanPosinCG ] = uiMaxAbsLevel;
+      pdErrorScale  [ iScanPosinCG ] = errorScale;
+      uiMaxAbsLevelInCG             |= uiMaxAbsLevel;
+    }
+
+    d64BlockUncodedCost += d64UncodedCostCG;
+
+    if (uiMaxAbsLevelInCG == 0)
+    {
+      if (iLastScanPos < 0)
+      {
+        d64BaseCost += d64UncodedCostCG;
+        continue;
+      }
+      if (iCGScanPos != 0)
+      {
+        // all levels are zero: the significance costs of the group cancel against the coded_sub_block_flag
+        UInt  uiCtxSig = getSigCoeffGroupCtxInc( uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups );
+        d64BaseCost += d64UncodedCostCG + pdSigCGCost[ uiCtxSig ][ 0 ];
+        pdCostCoeffGroupSig[ iCGScanPos ] = pdSigCGCost[ uiCtxSig ][ 0 ];
+
+        uiCtxSet          = getContextSetIndex(compID, (iCGScanPos - 1), (c1 == 0));
+        c1                = 1;
+        c2                = 0;
+        c1Idx             = 0;
+        c2Idx             = 0;
+        uiGoRiceParam     = initialGolombRiceParameter;
+        continue;
+      }
+    }
+
+    memset( &rdStats, 0, sizeof (coeffGroupRDStats));
+
+    const Int    patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
+    const UChar *sigCtxInc     = getSigCtxIncTable(patternSigCtx, codingParameters, iCGScanPos);
+
+    for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
+    {
+      iScanPos = iCGScanPos*uiCGSize + iScanPosinCG;
+      UInt    uiBlkPos          = codingParameters.scan[iScanPos];
 
-  const UInt rasterPosition = codingParameters.scan[scanPosition];
-  const UInt posY           = rasterPosition >> log2BlockWidth;
-  const UInt posX           = rasterPosition - (posY << log2BlockWidth);
+      const Intermediate_Int lLevelDouble  = plLevelDouble [ iScanPosinCG ];
+      const UInt             uiMaxAbsLevel = puiMaxAbsLevel[ iScanPosinCG ];
+      const Double           errorScale    = pdErrorScale  [ iScanPosinCG ];
 
-  if ((posX + posY) == 0)
+      pdCostSig[ iScanPos ] = 0;
+
+      if ( uiMaxAbsLevel > 0 && iLastScanPos < 0 )
+      {
+        iLastScanPos            = iScanPos;
+        uiCtxSet                = getContextSetIndex(compID, (iScanPos >> MLS_CG_SIZE), 0);
+        iCGLastScanPos          = iCGScanPos;
+      }
+
+      if ( iLastScanPos >= 0 )
+      {
+        //===== coefficient level estimation =====
+        const UInt uiOneCtx    = (NUM_ONE_FLAG_CTX_PER_SET * uiCtxSet) + c1;
+        const UInt uiAbsCtx    = (NUM_ABS_FLAG_CTX_PER_SET * uiCtxSet) + c2;
+        const Bool bLast       = (iScanPos == iLastScanPos);
+        UShort     uiCtxSig    = 0;
+        UInt       uiLevel     = 0;
+        Double     dCostSig1   = 0;
+
+        if( bLast )
+        {
+          pdCostCoeff[ iScanPos ] = MAX_DOUBLE;
+        }
+        else
+        {
+          uiCtxSig              = significanceMapContextOffset + sigCtxInc[ iScanPosinCG ];
+          dCostSig1             = pdSigCost[ uiCtxSig ][ 1 ];
+          if( uiMaxAbsLevel < 3 )
+          {
+            pdCostSig  [ iScanPos ] = pdSigCost[ uiCtxSig ][ 0 ];
+            pdCostCoeff[ iScanPos ] = pdCostCoeff0[ iScanPos ] + pdCostSig[ iScanPos ];
+          }
+          else
+          {
+            pdCostCoeff[ iScanPos ] = MAX_DOUBLE;
+          }
+        }
+
+        // candidates max and max-1, in the order in which xGetCodedLevel visits them
+        Int rateMax    = 0;
+        Int rateMaxM1  = 0;
+        if( uiMaxAbsLevel > 0 )
+        {
+          rateMax                   = xGetICRate( uiMaxAbsLevel, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange );
+          const Double dErrMax      = Double( lLevelDouble - ( Intermediate_Int(uiMaxAbsLevel) << iQBits ) );
+          const Double dCostMax     = dErrMax * dErrMax * errorScale + xGetICost( rateMax ) + dCostSig1;
+          Double       dCostMaxM1   = MAX_DOUBLE;
+          if( uiMaxAbsLevel > 1 )
+          {
+            rateMaxM1               = xGetICRate( uiMaxAbsLevel-1, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange );
+            const Double dErrMaxM1  = Double( lLevelDouble - ( Intermediate_Int(uiMaxAbsLevel-1) << iQBits ) );
+            dCostMaxM1              = dErrMaxM1 * dErrMaxM1 * errorScale + xGetICost( rateMaxM1 ) + dCostSig1;
+          }
+          if( dCostMax < pdCostCoeff[ iScanPos ] )
+          {
+            uiLevel                 = uiMaxAbsLevel;
+            pdCostCoeff[ iScanPos ] = dCostMax;
+            pdCostSig  [ iScanPos ] = dCostSig1;
+          }
+          if( dCostMaxM1 < pdCostCoeff[ iScanPos ] )
+          {
+            uiLevel                 = uiMaxAbsLevel-1;
+            pdCostCoeff[ iScanPos ] = dCostMaxM1;
+            pdCostSig  [ iScanPos ] = dCostSig1;
+          }
+        }
+
+        if( bSignHiding )
+        {
+          if( !bLast )
+          {
+            sigRateDelta[ uiBlkPos ] = m_pcEstBitsSbac->significantBits[ uiCtxSig ][ 1 ] - m_pcEstBitsSbac->significantBits[ uiCtxSig ][ 0 ];
+          }
+          deltaU[ uiBlkPos ]        = TCoeff((lLevelDouble - (Intermediate_Int(uiLevel) << iQBits)) >> (iQBits-8));
+
+          if( uiLevel == uiMaxAbsLevel && uiLevel > 0 )
+          {
+            rateIncUp   [ uiBlkPos ] = xGetICRate( uiLevel+1, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange ) - rateMax;
+            rateIncDown [ uiBlkPos ] = rateMaxM1 - rateMax;
+          }
+          else if( uiLevel > 0 )
+          {
+            rateIncUp   [ uiBlkPos ] = rateMax - rateMaxM1;
+            rateIncDown [ uiBlkPos ] = xGetICRate( uiLevel-1, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange ) - rateMaxM1;
+          }
+          else // uiLevel == 0
+          {
+            rateIncUp   [ uiBlkPos ] = m_pcEstBitsSbac->m_greaterOneBits[ uiOneCtx ][ 0 ];
+          }
+        }
+        piDstCoeff[ uiBlkPos ] = uiLevel;
+        d64BaseCost           += pdCostCoeff [ iScanPos ];
+
+        baseLevel = (c1Idx < C1FLAG_NUMBER) ? (2 + (c2Idx < C2FLAG_NUMBER)) : 1;
+        if( uiLevel >= baseLevel )
+        {
+          if (uiLevel > 3*(1<<uiGoRiceParam))
+          {
+            uiGoRiceParam = bUseGolombRiceParameterAdaptation ? (uiGoRiceParam + 1) : (std::min<UInt>((uiGoRiceParam + 1), 4));
+          }
+        }
+        if ( uiLevel >= 1)
+        {
+          c1Idx ++;
+        }
+
+        //===== update bin model =====
+        if( uiLevel > 1 )
+        {
+          c1 = 0;
+          c2 += (c2 < 2);
+          c2Idx ++;
+        }
+        else if( (c1 < 3) && (c1 > 0) && uiLevel)
+        {
+          c1++;
+        }
+
+        //===== context set update =====
+        if( ( iScanPos % uiCGSize == 0 ) && ( iScanPos > 0 ) )
+        {
+          uiCtxSet          = getContextSetIndex(compID, ((iScanPos - 1) >> MLS_CG_SIZE), (c1 == 0)); //(iScanPos - 1) because we do this **before** entering the final group
+          c1                = 1;
+          c2                = 0;
+          c1Idx             = 0;
+          c2Idx             = 0;
+          uiGoRiceParam     = initialGolombRiceParameter;
+        }
+      }
+      else
+      {
+        d64BaseCost    += pdCostCoeff0[ iScanPos ];
+      }
+      rdStats.d64SigCost += pdCostSig[ iScanPos ];
+      if (iScanPosinCG == 0 )
+      {
+        rdStats.d64SigCost_0 = pdCostSig[ iScanPos ];
+      }
+      if (piDstCoeff[ uiBlkPos ] )
+      {
+        uiSigCoeffGroupFlag[ uiCGBlkPos ] = 1;
+        rdStats.d64CodedLevelandDist += pdCostCoeff[ iScanPos ] - pdCostSig[ iScanPos ];
+        rdStats.d64UncodedDist += pdCostCoeff0[ iScanPos ];
+        if ( iScanPosinCG != 0 )
+        {
+          rdStats.iNNZbeforePos0++;
+        }
+      }
+    } //end for (iScanPosinCG)
+
+    if (iCGLastScanPos >= 0)
+    {
+      if( iCGScanPos )
+      {
+        UInt  uiCtxSig = getSigCoeffGroupCtxInc( uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups );
+
+        if (uiSigCoeffGroupFlag[ uiCGBlkPos ] == 0)
+        {
+          d64BaseCost += pdSigCGCost[ uiCtxSig ][ 0 ] - rdStats.d64SigCost;
+          pdCostCoeffGroupSig[ iCGScanPos ] = pdSigCGCost[ uiCtxSig ][ 0 ];
+        }
+        else if (iCGScanPos < iCGLastScanPos) //skip the last coefficient group, which will be handled together with last position below.
+        {
+          if ( rdStats.iNNZbeforePos0 == 0 )
+          {
+            d64BaseCost -= rdStats.d64SigCost_0;
+            rdStats.d64SigCost -= rdStats.d64SigCost_0;
+          }
+          // rd-cost if SigCoeffGroupFlag = 0, initialization
+          Double d64CostZeroCG = d64BaseCost;
+
+          // add SigCoeffGroupFlag cost to total cost
+          d64BaseCost  += pdSigCGCost[ uiCtxSig ][ 1 ];
+          d64CostZeroCG += pdSigCGCost[ uiCtxSig ][ 0 ];
+          pdCostCoeffGroupSig[ iCGScanPos ] = pdSigCGCost[ uiCtxSig ][ 1 ];
+
+          // try to convert the current coeff group from non-zero to all-zero
+          d64CostZeroCG += rdStats.d64UncodedDist;  // distortion for resetting non-zero levels to zero levels
+          d64CostZeroCG -= rdStats.d64CodedLevelandDist;   // distortion and level cost for keeping all non-zero levels
+          d64CostZeroCG -= rdStats.d64SigCost;     // sig cost for all coeffs, including zero levels and non-zerl levels
+
+          // if we can save cost, change this block to all-zero block
+          if ( d64CostZeroCG < d64BaseCost )
+          {
+            uiSigCoeffGroupFlag[ uiCGBlkPos ] = 0;
+            d64BaseCost = d64CostZeroCG;
+            pdCostCoeffGroupSig[ iCGScanPos ] = pdSigCGCost[ uiCtxSig ][ 0 ];
+
+            // reset coeffs to 0 in this block
+            for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
+            {
+              iScanPos      = iCGScanPos*uiCGSize + iScanPosinCG;
+              UInt uiBlkPos = codingParameters.scan[ iScanPos ];
+
+              if (piDstCoeff[ uiBlkPos ])
+              {
+                piDstCoeff [ uiBlkPos ] = 0;
+                pdCostCoeff[ iScanPos ] = pdCostCoeff0[ iScanPos ];
+                pdCostSig  [ iScanPos ] = 0;
+              }
+            }
+          } // end if ( d64CostAllZeros < d64BaseCost )
+        }
+      }
+      else
+      {
+        uiSigCoeffGroupFlag[ uiCGBlkPos ] = 1;
+      }
+    }
+  } //end for (iCGScanPos)
+
+  //===== estimate last position =====
+  if ( iLastScanPos < 0 )
   {
-    return 0; //special case for the DC context variable
+    return;
   }
 
-  Int offset = MAX_INT;
-
-  if ((log2BlockWidth == 2) && (log2BlockHeight == 2)) //4x4
+  Double  d64BestCost         = 0;
+  Int     ui16CtxCbf          = 0;
+  Int     iBestLastIdxP1      = 0;
+  if( !pcCU->isIntra( uiAbsPartIdx ) && isLuma(compID) && pcCU->getTransformIdx( uiAbsPartIdx ) == 0 )
   {
-    offset = ctxIndMap4x4[ (4 * posY) + posX ];
+    ui16CtxCbf   = 0;
+    d64BestCost  = d64BlockUncodedCost + xGetICost( m_pcEstBitsSbac->blockRootCbpBits[ ui16CtxCbf ][ 0 ] );
+    d64BaseCost += xGetICost( m_pcEstBitsSbac->blockRootCbpBits[ ui16CtxCbf ][ 1 ] );
   }
   else
   {
-    Int cnt = 0;
+    ui16CtxCbf   = pcCU->getCtxQtCbf( rTu, channelType );
+    ui16CtxCbf  += getCBFContextOffset(compID);
+    d64BestCost  = d64BlockUncodedCost + xGetICost( m_pcEstBitsSbac->blockCbpBits[ ui16CtxCbf ][ 0 ] );
+    d64BaseCost += xGetICost( m_pcEstBitsSbac->blockCbpBits[ ui16CtxCbf ][ 1 ] );
+  }
+
+  const Bool bSwapLast = (codingParameters.scanType == SCAN_VER);
 
-    switch (patternSigCtx)
+  Bool bFoundLast = false;
+  for (Int iCGScanPos = iCGLastScanPos; iCGScanPos >= 0; iCGScanPos--)
+  {
+    UInt uiCGBlkPos = codingParameters.scanCG[ iCGScanPos ];
+
+    d64BaseCost -= pdCostCoeffGroupSig [ iCGScanPos ];
+    if (uiSigCoeffGroupFlag[ uiCGBlkPos ])
     {
-      //------------------
+      for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
+      {
+        iScanPos = iCGScanPos*uiCGSize + iScanPosinCG;
 
-      case 0: //neither neighbouring group is significant
+        if (iScanPos > iLastScanPos)
         {
-          const Int posXinSubset     = posX & ((1 << MLS_CG_LOG2_WIDTH)  - 1);
-          const Int posYinSubset     = posY & ((1 << MLS_CG_LOG2_HEIGHT) - 1);
-          const Int posTotalInSubset = posXinSubset + posYinSubset;
+          continue;
+        }
+        UInt   uiBlkPos     = codingParameters.scan[iScanPos];
+
+        if( piDstCoeff[ uiBlkPos ] )
+        {
+          UInt   uiPosY       = uiBlkPos >> uiLog2BlockWidth;
+          UInt   uiPosX       = uiBlkPos - ( uiPosY << uiLog2BlockWidth );
 
-          //first N coefficients in scan order use 2; the next few use 1; the rest use 0.
-          const UInt context1Threshold = NEIGHBOURHOOD_00_CONTEXT_1_THRESHOLD_4x4;
-          const UInt context2Threshold = NEIGHBOURHOOD_00_CONTEXT_2_THRESHOLD_4x4;
+          Double d64CostLast= xGetICost( Double( bSwapLast ? (piLastRate[ 0 ][ uiPosY ] + piLastRate[ 1 ][ uiPosX ]) : (piLastRate[ 0 ][ uiPosX ] + piLastRate[ 1 ][ uiPosY ]) ) );
+          Double totalCost = d64BaseCost + d64CostLast - pdCostSig[ iScanPos ];
 
-          cnt = (posTotalInSubset >= context1Threshold) ? 0 : ((posTotalInSubset >= context2Threshold) ? 1 : 2);
+          if( totalCost < d64BestCost )
+          {
+            iBestLastIdxP1  = iScanPos + 1;
+            d64BestCost     = totalCost;
+          }
+          if( piDstCoeff[ uiBlkPos ] > 1 )
+          {
+            bFoundLast = true;
+            break;
+          }
+          d64BaseCost      -= pdCostCoeff[ iScanPos ];
+          d64BaseCost      += pdCostCoeff0[ iScanPos ];
+        }
+        else
+        {
+          d64BaseCost      -= pdCostSig[ iScanPos ];
         }
+      } //end for
+      if (bFoundLast)
+      {
         break;
+      }
+    } // end if (uiSigCoeffGroupFlag[ uiCGBlkPos ])
+  } // end for
 
-      //------------------
 
-      case 1: //right group is significant, below is not
-        {
-          const Int posYinSubset = posY & ((1 << MLS_CG_LOG2_HEIGHT) - 1);
-          const Int groupHeight  = 1 << MLS_CG_LOG2_HEIGHT;
+  for ( Int scanPos = 0; scanPos < iBestLastIdxP1; scanPos++ )
+  {
+    Int blkPos = codingParameters.scan[ scanPos ];
+    TCoeff level = piDstCoeff[ blkPos ];
+    uiAbsSum += level;
+    piDstCoeff[ blkPos ] = ( plSrcCoeff[ blkPos ] < 0 ) ? -level : level;
+  }
 
-          cnt = (posYinSubset >= (groupHeight >> 1)) ? 0 : ((posYinSubset >= (groupHeight >> 2)) ? 1 : 2); //top quarter uses 2; second-from-top quarter uses 1; bottom half uses 0
-        }
+  //===== clean uncoded coefficients =====
+  for ( Int scanPos = iBestLastIdxP1; scanPos <= iLastScanPos; scanPos++ )
+  {
+    piDstCoeff[ codingParameters.scan[ scanPos ] ] = 0;
+  }
+
+  if( bSignHiding && uiAbsSum>=2)
+  {
+    xRateDistOptSignHiding( rTu, plSrcCoeff, piDstCoeff, deltaU, rateIncUp, rateIncDown, sigRateDelta, codingParameters, compID, cQP );
+  }
+}
+
+
+/** Sign bit hiding stage of the rate distortion optimised quantisation
+ * \param rTu reference to transform data
+ * \param plSrcCoeff pointer to input buffer
+ * \param piDstCoeff reference to quantised output buffer
+ * \param deltaU quantisation error of the selected levels, in units of 1/256 of a quantisation step
+ * \param rateIncUp rate increase when the level is incremented
+ * \param rateIncDown rate increase when the level is decremented
+ * \param sigRateDelta rate difference between coding the significance flag as 1 and as 0
+ * \param codingParameters coding parameters for the TU (includes the scan)
+ * \param compID colour component ID
+ * \param cQP reference to quantization parameters
+ */
+Void TComTrQuant::xRateDistOptSignHiding(       TComTU       &rTu,
+                                          const TCoeff      * plSrcCoeff,
+                                                TCoeff      * piDstCoeff,
+                                          const TCoeff      * deltaU,
+                                          const Int         * rateIncUp,
+                                          const Int         * rateIncDown,
+                                          const Int         * sigRateDelta,
+                                          const TUEntropyCodingParameters &codingParameters,
+                                          const ComponentID   compID,
+                                          const QpParam      &cQP )
+{
+  const TComRectangle  & rect                  = rTu.getRect(compID);
+  const UInt             uiWidth               = rect.width;
+  const UInt             uiHeight              = rect.height;
+  const UInt             uiCGSize              = (1 << MLS_CG_SIZE);
+  const Int              maxLog2TrDynamicRange = rTu.getCU()->getSlice()->getSPS()->getMaxLog2TrDynamicRange(toChannelType(compID));
+  const Int              channelBitDepth       = rTu.getCU()->getSlice()->getSPS()->getBitDepth(toChannelType(compID));
+  const TCoeff           entropyCodingMinimum  = -(1 << maxLog2TrDynamicRange);
+  const TCoeff           entropyCodingMaximum  =  (1 << maxLog2TrDynamicRange) - 1;
+
+  const Double inverseQuantScale = Double(g_invQuantScales[cQP.rem]);
+  Int64 rdFactor = (Int64)(inverseQuantScale * inverseQuantScale * (1 << (2 * cQP.per))
+                           / m_dLambda / 16 / (1 << (2 * DISTORTION_PRECISION_ADJUSTMENT(channelBitDepth - 8)))
+                           + 0.5);
+
+  Int lastCG = -1;
+  Int absSum = 0 ;
+  Int n ;
+
+  for( Int subSet = (uiWidth*uiHeight-1) >> MLS_CG_SIZE; subSet >= 0; subSet-- )
+  {
+    Int  subPos     = subSet << MLS_CG_SIZE;
+    Int  firstNZPosInCG=uiCGSize , lastNZPosInCG=-1 ;
+    absSum = 0 ;
+
+    for(n = uiCGSize-1; n >= 0; --n )
+    {
+      if( piDstCoeff[ codingParameters.scan[ n + subPos ]] )
+      {
+        lastNZPosInCG = n;
         break;
+      }
+    }
 
-      //------------------
+    for(n = 0; n <uiCGSize; n++ )
+    {
+      if( piDstCoeff[ codingParameters.scan[ n + subPos ]] )
+      {
+        firstNZPosInCG = n;
+        break;
+      }
+    }
+
+    for(n = firstNZPosInCG; n <=lastNZPosInCG; n++ )
+    {
+      absSum += Int(piDstCoeff[ codingParameters.scan[ n + subPos ]]);
+    }
+
+    if(lastNZPosInCG>=0 && lastCG==-1)
+    {
+      lastCG = 1;
+    }
 
-      case 2: //below group is significant, right is not
+    if( lastNZPosInCG-firstNZPosInCG>=SBH_THRESHOLD )
+    {
+      UInt signbit = (piDstCoeff[codingParameters.scan[subPos+firstNZPosInCG]]>0?0:1);
+      if( signbit!=(absSum&0x1) )  // hide but need tune
+      {
+        // calculate the cost
+        Int64 minCostInc = std::numeric_limits<Int64>::max(), curCost = std::numeric_limits<Int64>::max();
+        Int minPos = -1, finalChange = 0, curChange = 0;
+
+        for( n = (lastCG==1?lastNZPosInCG:uiCGSize-1) ; n >= 0; --n )
         {
-          const Int posXinSubset = posX & ((1 << MLS_CG_LOG2_WIDTH)  - 1);
-          const Int groupWidth   = 1 << MLS_CG_LOG2_WIDTH;
+          UInt uiBlkPos   = codingParameters.scan[ n + subPos ];
+          if(piDstCoeff[ uiBlkPos ] != 0 )
+          {
+            Int64 costUp   = rdFactor * ( - deltaU[uiBlkPos] ) + rateIncUp[uiBlkPos];
+            Int64 costDown = rdFactor * (   deltaU[uiBlkPos] ) + rateIncDown[uiBlkPos]
+                             -   ((abs(piDstCoeff[uiBlkPos]) == 1) ? sigRateDelta[uiBlkPos] : 0);
 
-          cnt = (posXinSubset >= (groupWidth >> 1)) ? 0 : ((posXinSubset >= (groupWidth >> 2)) ? 1 : 2); //left quarter uses 2; second-from-left quarter uses 1; right half uses 0
-        }
-        break;
+            if(lastCG==1 && lastNZPosInCG==n && abs(piDstCoeff[uiBlkPos])==1)
+            {
+              costDown -= (4<<15);
+            }
 
-      //------------------
+            if(costUp<costDown)
+            {
+              curCost = costUp;
+              curChange =  1;
+            }
+            else
+            {
+              curChange = -1;
+              if(n==firstNZPosInCG && abs(piDstCoeff[uiBlkPos])==1)
+              {
+                curCost = std::numeric_limits<Int64>::max();
+              }
+              else
+              {
+                curCost = costDown;
+              }
+            }
+          }
+          else
+          {
+            curCost = rdFactor * ( - (abs(deltaU[uiBlkPos])) ) + (1<<15) + rateIncUp[uiBlkPos] + sigRateDelta[uiBlkPos] ;
+            curChange = 1 ;
+
+            if(n<firstNZPosInCG)
+            {
+              UInt thissignbit = (plSrcCoeff[uiBlkPos]>=0?0:1);
+              if(thissignbit != signbit )
+              {
+                curCost = std::numeric_limits<Int64>::max();
+              }
+            }
+          }
 
-      case 3: //both neighbouring groups are significant
+          if( curCost<minCostInc)
+          {
+            minCostInc = curCost;
+            finalChange = curChange;
+            minPos = uiBlkPos;
+          }
+        }
+
+        if(piDstCoeff[minPos] == entropyCodingMaximum || piDstCoeff[minPos] == entropyCodingMinimum)
         {
-          cnt = 2;
+          finalChange = -1;
         }
-        break;
 
-      //------------------
+        if(plSrcCoeff[minPos]>=0)
+        {
+          piDstCoeff[minPos] += finalChange ;
+        }
+        else
+        {
+          piDstCoeff[minPos] -= finalChange ;
+        }
+      }
+    }
 
-      default:
-        std::cerr << "ERROR: Invalid patternSigCtx \"" << Int(patternSigCtx) << "\" in getSigCtxInc" << std::endl;
-        exit(1);
-        break;
+    if(lastCG==1)
+    {
+      lastCG=0 ;
     }
+  }
+}
 
-    //------------------------------------------------
 
-    const Bool notFirstGroup = ((posX >> MLS_CG_LOG2_WIDTH) + (posY >> MLS_CG_LOG2_HEIGHT)) > 0;
+/** Pattern decision for context derivation process of significant_coeff_flag
+ * \param sigCoeffGroupFlag pointer to prior coded significant coeff group
+ * \param uiCGPosX column of current coefficient group
+ * \param uiCGPosY row of current coefficient group
+ * \param widthInGroups width of the block
+ * \param heightInGroups height of the block
+ * \returns pattern for current coefficient group
+ */
+Int  TComTrQuant::calcPatternSigCtx( const UInt* sigCoeffGroupFlag, UInt uiCGPosX, UInt uiCGPosY, UInt widthInGroups, UInt heightInGroups )
+{
+  if ((widthInGroups <= 1) && (heightInGroups <= 1))
+  {
+    return 0;
+  }
+
+  const Bool rightAvailable = uiCGPosX < (widthInGroups  - 1);
+  const Bool belowAvailable = uiCGPosY < (heightInGroups - 1);
 
-    offset = (notFirstGroup ? notFirstGroupNeighbourhoodContextOffset[chanType] : 0) + cnt;
+  UInt sigRight = 0;
+  UInt sigLower = 0;
+
+  if (rightAvailable)
+  {
+    sigRight = ((sigCoeffGroupFlag[ (uiCGPosY * widthInGroups) + uiCGPosX + 1 ] != 0) ? 1 : 0);
   }
+  if (belowAvailable)
+  {
+    sigLower = ((sigCoeffGroupFlag[ (uiCGPosY + 1) * widthInGroups + uiCGPosX ] != 0) ? 1 : 0);
+  }
+
+  return sigRight + (sigLower << 1);
+}
+
 
-  return codingParameters.firstSignificanceMapContext + offset;
+/** Context derivation process of coeff_abs_significant_flag
+ * \param patternSigCtx pattern for current coefficient group
+ * \param codingParameters coding parameters for the TU (includes the scan)
+ * \param scanPosition current position in scan order
+ * \param log2BlockWidth log2 width of the block
+ * \param log2BlockHeight log2 height of the block
+ * \param chanType channel type (CHANNEL_TYPE_LUMA/CHROMA)
+ * \returns ctxInc for current scan position
+ */
+Int TComTrQuant::getSigCtxInc    (       Int                        patternSigCtx,
+                                   const TUEntropyCodingParameters &codingParameters,
+                                   const Int                        scanPosition,
+                                   const Int                        log2BlockWidth,
+                                   const Int                        log2BlockHeight,
+                                   const ChannelType                chanType)
+{
+  // all coefficient groups share the same scan within the group, so the context increments only depend on the
+  // position within the group; they are derived for every combination of parameters in initROM()
+  return getSigCtxIncTable(patternSigCtx, codingParameters, scanPosition >> MLS_CG_SIZE)[scanPosition & ((1 << MLS_CG_SIZE) - 1)];
 }
 
 
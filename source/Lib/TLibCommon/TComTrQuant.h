@@ -128,6 +128,24 @@ public:
                      const QpParam        & cQP
                     );
 
+  // early detection of TUs that quantise to all-zero levels
+  Bool isZeroBlock (       TComTU         & rTu,
+                     const ComponentID      compID,
+                     const Pel           *  pcResidual,
+                     const UInt             uiStride,
+                     const QpParam        & cQP,
+                     const ZeroBlockDetectionMode mode
+                    );
+
+  Void setZeroBlock(       TComTU         & rTu,
+                     const ComponentID      compID,
+                           TCoeff        *  rpcCoeff,
+#if ADAPTIVE_QP_SELECTION
+                           TCoeff        * rpcArlCoeff,
+#endif
+                           TCoeff         & uiAbsSum
+                    );
+
 
   Void invTransformNxN(      TComTU       & rTu,
                        const ComponentID    compID,
@@ -166,6 +184,14 @@ public:
                                      const ChannelType                chanType
                                     );
 
+  /// significance map context increments of the scan positions within the coefficient group at iCGScanPos
+  static const UChar* getSigCtxIncTable( const Int                        patternSigCtx,
+                                         const TUEntropyCodingParameters &codingParameters,
+                                         const Int                        iCGScanPos )
+  {
+    return codingParameters.sigCtxIncTable + (((patternSigCtx << 1) + ((iCGScanPos != 0) ? 1 : 0)) << MLS_CG_SIZE);
+  }
+
   static UInt getSigCoeffGroupCtxInc  (const UInt*  uiSigCoeffGroupFlag,
                                        const UInt   uiCGPosX,
                                        const UInt   uiCGPosY,
@@ -180,6 +206,7 @@ public:
   Int* getQuantCoeff                    ( UInt list, Int qp, UInt size ) { return m_quantCoef            [size][list][qp]; };  //!< get Quant Coefficent
   Int* getDequantCoeff                  ( UInt list, Int qp, UInt size ) { return m_dequantCoef          [size][list][qp]; };  //!< get DeQuant Coefficent
   Void setUseScalingList   ( Bool bUseScalingList){ m_scalingListEnabledFlag = bUseScalingList; };
+  Void setUseFastRDOQ      ( Bool bUseFastRDOQ)   { m_useFastRDOQ = bUseFastRDOQ; };
   Bool getUseScalingList   (const UInt width, const UInt height, const Bool isTransformSkip){ return m_scalingListEnabledFlag && (!isTransformSkip || ((width == 4) && (height == 4))); };
   Void setFlatScalingList  (const Int maxLog2TrDynamicRange[MAX_NUM_CHANNEL_TYPE], const BitDepths &bitDepths);
   Void xsetFlatScalingList ( UInt list, UInt size, Int qp);
@@ -221,6 +248,7 @@ protected:
 #if T0196_SELECTIVE_RDOQ
   Bool     m_useSelectiveRDOQ;
 #endif
+  Bool     m_useFastRDOQ;
 #if ADAPTIVE_QP_SELECTION
   Bool     m_bUseAdaptQpSelect;
 #endif
@@ -272,6 +300,27 @@ private:
                                      const ComponentID   compID,
                                      const QpParam      &cQP );
 
+  Void           xRateDistOptQuantFast (       TComTU       &rTu,
+                                               TCoeff      * plSrcCoeff,
+                                               TCoeff      * piDstCoeff,
+#if ADAPTIVE_QP_SELECTION
+                                               TCoeff      *piArlDstCoeff,
+#endif
+                                               TCoeff       &uiAbsSum,
+                                         const ComponentID   compID,
+                                         const QpParam      &cQP );
+
+  Void           xRateDistOptSignHiding(       TComTU       &rTu,
+                                         const TCoeff      * plSrcCoeff,
+                                               TCoeff      * piDstCoeff,
+                                         const TCoeff      * deltaU,
+                                         const Int         * rateIncUp,
+                                         const Int         * rateIncDown,
+                                         const Int         * sigRateDelta,
+                                         const TUEntropyCodingParameters &codingParameters,
+                                         const ComponentID   compID,
+                                         const QpParam      &cQP );
+
 __inline UInt              xGetCodedLevel  ( Double&          rd64CodedCost,
                                              Double&          rd64CodedCost0,
                                              Double&          rd64CodedCostSig,
@@ -0,0 +1,192 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTrQuantAVX2.cpp
+    \brief    AVX2 partial butterfly transforms
+*/
+
+#include "TComTrQuantSIMD.h"
+
+#if TRANSFORM_SIMD
+
+#include <immintrin.h>
+#include "TComRom.h"
+
+// everything below is compiled for AVX2, and only called when the CPU supports it
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace
+{
+
+/// eight lanes of 32-bit coefficients
+struct OpsAVX2
+{
+  typedef __m256i Vec;
+  static const Int lanes = 8;
+
+  static inline Vec  load ( const TCoeff *p )       { return _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) ); }
+  static inline Void store( TCoeff *p, Vec a )      { _mm256_storeu_si256( reinterpret_cast<__m256i*>( p ), a ); }
+  static inline Vec  set1 ( Int value )             { return _mm256_set1_epi32( value ); }
+  static inline Vec  add  ( Vec a, Vec b )          { return _mm256_add_epi32( a, b ); }
+  static inline Vec  sub  ( Vec a, Vec b )          { return _mm256_sub_epi32( a, b ); }
+  static inline Vec  mul  ( Vec a, Int c )          { return _mm256_mullo_epi32( a, _mm256_set1_epi32( c ) ); }
+  static inline Vec  sra  ( Vec a, Int shift )      { return _mm256_sra_epi32( a, _mm_cvtsi32_si128( shift ) ); }
+  static inline Vec  clip ( Vec a, Vec minimum, Vec maximum ) { return _mm256_min_epi32( _mm256_max_epi32( a, minimum ), maximum ); }
+
+  /// transpose 8x8 values, rows[i] lane j <-> rows[j] lane i
+  static inline Void transpose( Vec rows[8] )
+  {
+    // 2x2 and 4x4 transposes within the 128-bit halves
+    const Vec t0 = _mm256_unpacklo_epi32( rows[0], rows[1] );
+    const Vec t1 = _mm256_unpackhi_epi32( rows[0], rows[1] );
+    const Vec t2 = _mm256_unpacklo_epi32( rows[2], rows[3] );
+    const Vec t3 = _mm256_unpackhi_epi32( rows[2], rows[3] );
+    const Vec t4 = _mm256_unpacklo_epi32( rows[4], rows[5] );
+    const Vec t5 = _mm256_unpackhi_epi32( rows[4], rows[5] );
+    const Vec t6 = _mm256_unpacklo_epi32( rows[6], rows[7] );
+    const Vec t7 = _mm256_unpackhi_epi32( rows[6], rows[7] );
+    const Vec u0 = _mm256_unpacklo_epi64( t0, t2 );
+    const Vec u1 = _mm256_unpackhi_epi64( t0, t2 );
+    const Vec u2 = _mm256_unpacklo_epi64( t1, t3 );
+    const Vec u3 = _mm256_unpackhi_epi64( t1, t3 );
+    const Vec u4 = _mm256_unpacklo_epi64( t4, t6 );
+    const Vec u5 = _mm256_unpackhi_epi64( t4, t6 );
+    const Vec u6 = _mm256_unpacklo_epi64( t5, t7 );
+    const Vec u7 = _mm256_unpackhi_epi64( t5, t7 );
+    // exchange the 4x4 blocks across the halves
+    rows[0] = _mm256_permute2x128_si256( u0, u4, 0x20 );
+    rows[1] = _mm256_permute2x128_si256( u1, u5, 0x20 );
+    rows[2] = _mm256_permute2x128_si256( u2, u6, 0x20 );
+    rows[3] = _mm256_permute2x128_si256( u3, u7, 0x20 );
+    rows[4] = _mm256_permute2x128_si256( u0, u4, 0x31 );
+    rows[5] = _mm256_permute2x128_si256( u1, u5, 0x31 );
+    rows[6] = _mm256_permute2x128_si256( u2, u6, 0x31 );
+    rows[7] = _mm256_permute2x128_si256( u3, u7, 0x31 );
+  }
+};
+
+} // namespace
+
+#include "TComTrQuantSIMDKernels.h"
+
+/// transforms replaced by setTransformFunctionsAVX2, used for fewer lines than AVX2 lanes
+static TransformFunctions s_narrowFunctions;
+
+// ====================================================================================================================
+// Transforms
+// ====================================================================================================================
+
+static Void partialButterfly8AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterfly[1]( src, dst, shift, line );
+    return;
+  }
+  forwardTransform<OpsAVX2, 8, false>( g_aiT8[TRANSFORM_FORWARD], src, dst, shift, line );
+}
+
+static Void partialButterfly16AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterfly[2]( src, dst, shift, line );
+    return;
+  }
+  forwardTransform<OpsAVX2, 16, false>( g_aiT16[TRANSFORM_FORWARD], src, dst, shift, line );
+}
+
+static Void partialButterfly32AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterfly[3]( src, dst, shift, line );
+    return;
+  }
+  forwardTransform<OpsAVX2, 32, false>( g_aiT32[TRANSFORM_FORWARD], src, dst, shift, line );
+}
+
+static Void partialButterflyInverse8AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterflyInverse[1]( src, dst, shift, line, outputMinimum, outputMaximum );
+    return;
+  }
+  inverseTransform<OpsAVX2, 8, false>( g_aiT8[TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum );
+}
+
+static Void partialButterflyInverse16AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterflyInverse[2]( src, dst, shift, line, outputMinimum, outputMaximum );
+    return;
+  }
+  inverseTransform<OpsAVX2, 16, false>( g_aiT16[TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum );
+}
+
+static Void partialButterflyInverse32AVX2( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum )
+{
+  if (line % OpsAVX2::lanes)
+  {
+    s_narrowFunctions.partialButterflyInverse[3]( src, dst, shift, line, outputMinimum, outputMaximum );
+    return;
+  }
+  inverseTransform<OpsAVX2, 32, false>( g_aiT32[TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum );
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+Void setTransformFunctionsAVX2( TransformFunctions &functions )
+{
+  s_narrowFunctions = functions;
+
+  functions.partialButterfly       [1] = partialButterfly8AVX2;
+  functions.partialButterfly       [2] = partialButterfly16AVX2;
+  functions.partialButterfly       [3] = partialButterfly32AVX2;
+  functions.partialButterflyInverse[1] = partialButterflyInverse8AVX2;
+  functions.partialButterflyInverse[2] = partialButterflyInverse16AVX2;
+  functions.partialButterflyInverse[3] = partialButterflyInverse32AVX2;
+}
+
+#endif // TRANSFORM_SIMD
@@ -0,0 +1,89 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTrQuantSIMD.h
+    \brief    SSE4.1 and AVX2 partial butterfly transforms (header)
+*/
+
+#ifndef __TCOMTRQUANTSIMD__
+#define __TCOMTRQUANTSIMD__
+
+#include "CommonDef.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+/// SIMD transforms are built for x86 GCC/Clang builds with 32-bit transform coefficients, and selected at run time
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TRANSFORM_SIMD 1
+#else
+#define TRANSFORM_SIMD 0
+#endif
+
+// ====================================================================================================================
+// Type definition
+// ====================================================================================================================
+
+typedef Void (*PartialButterflyFunc)       (TCoeff *src, TCoeff *dst, Int shift, Int line);
+typedef Void (*PartialButterflyInverseFunc)(TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum);
+typedef Void (*FastForwardDstFunc)         (TCoeff *block, TCoeff *coeff, Int shift);
+typedef Void (*FastInverseDstFunc)         (TCoeff *tmp, TCoeff *block, Int shift, const TCoeff outputMinimum, const TCoeff outputMaximum);
+
+/// 1D transforms used by xTrMxN and xITrMxN, the butterflies are indexed by log2 of the transform size - 2
+struct TransformFunctions
+{
+  PartialButterflyFunc        partialButterfly       [4];
+  PartialButterflyInverseFunc partialButterflyInverse[4];
+  FastForwardDstFunc          fastForwardDst;
+  FastInverseDstFunc          fastInverseDst;
+};
+
+// ====================================================================================================================
+// Function declaration
+// ====================================================================================================================
+
+Void setTransformFunctionsC    ( TransformFunctions &functions );  ///< set the C partial butterflies, the reference of the SIMD versions
+#if TRANSFORM_SIMD
+Void setTransformFunctionsSSE41( TransformFunctions &functions );  ///< replace all transforms with SSE4.1 versions
+Void setTransformFunctionsAVX2 ( TransformFunctions &functions );  ///< replace the 8- to 32-point butterflies with AVX2 versions, which fall back to the replaced ones for fewer than 8 lines
+#endif
+
+const TransformFunctions& getTransformFunctions();  ///< 1D transforms selected for the instruction sets of the CPU
+
+/// 2D forward and inverse transforms of TComTrQuant, through the given 1D transforms
+Void xTrMxN ( const TransformFunctions &functions, Int bitDepth, TCoeff *block, TCoeff *coeff, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange );
+Void xITrMxN( const TransformFunctions &functions, Int bitDepth, TCoeff *coeff, TCoeff *block, Int iWidth, Int iHeight, Bool useDST, const Int maxLog2TrDynamicRange );
+
+//! \}
+
+#endif // __TCOMTRQUANTSIMD__
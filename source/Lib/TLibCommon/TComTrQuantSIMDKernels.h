@@ -0,0 +1,245 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTrQuantSIMDKernels.h
+    \brief    partial butterfly transforms over SIMD lanes, shared by the SSE4.1 and AVX2 builds
+*/
+
+// Included by TComTrQuantSSE41.cpp and TComTrQuantAVX2.cpp after they have selected their instruction set, so the
+// templates below are compiled for that instruction set. Ops provides the vector type and operations on it:
+//   Vec, lanes, load, store, set1, add, sub, mul (by a constant), sra, clip and transpose (of lanes x lanes values).
+// Each lane transforms one line, so all arithmetic is the 32-bit arithmetic of the scalar transforms, and the results
+// are identical: the butterflies are exact integer factorisations of the transform matrices.
+
+#ifndef __TCOMTRQUANTSIMDKERNELS__
+#define __TCOMTRQUANTSIMDKERNELS__
+
+#include "TComTrQuantSIMD.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Butterflies
+// ====================================================================================================================
+
+/// y[step*i] = sum over n of T[step*i][n] * x[n], for the rows step*i, i < M, of the M-point transform within T, step = N/M
+template<class Ops, Int N, Int M>
+struct ForwardButterfly
+{
+  static inline Void apply( const TMatrixCoeff T[N][N], const typename Ops::Vec x[M], typename Ops::Vec y[N] )
+  {
+    typedef typename Ops::Vec Vec;
+    const Int step = N / M;
+
+    /* E and O */
+    Vec E[M / 2], O[M / 2];
+    for (Int k = 0; k < M / 2; k++)
+    {
+      E[k] = Ops::add( x[k], x[M - 1 - k] );
+      O[k] = Ops::sub( x[k], x[M - 1 - k] );
+    }
+
+    /* odd rows from O, even rows from the M/2-point transform of E */
+    for (Int i = 1; i < M; i += 2)
+    {
+      Vec sum = Ops::mul( O[0], T[step * i][0] );
+      for (Int n = 1; n < M / 2; n++)
+      {
+        sum = Ops::add( sum, Ops::mul( O[n], T[step * i][n] ) );
+      }
+      y[step * i] = sum;
+    }
+    ForwardButterfly<Ops, N, M / 2>::apply( T, E, y );
+  }
+};
+
+template<class Ops, Int N>
+struct ForwardButterfly<Ops, N, 1>
+{
+  static inline Void apply( const TMatrixCoeff T[N][N], const typename Ops::Vec x[1], typename Ops::Vec y[N] )
+  {
+    y[0] = Ops::mul( x[0], T[0][0] );
+  }
+};
+
+/// y[n] = sum over i of T[step*i][n] * x[step*i], for n < M, of the M-point transform within T, step = N/M
+template<class Ops, Int N, Int M>
+struct InverseButterfly
+{
+  static inline Void apply( const TMatrixCoeff T[N][N], const typename Ops::Vec x[N], typename Ops::Vec y[M] )
+  {
+    typedef typename Ops::Vec Vec;
+    const Int step = N / M;
+
+    /* E from the M/2-point transform of the even rows, O from the odd rows */
+    Vec E[M / 2], O[M / 2];
+    InverseButterfly<Ops, N, M / 2>::apply( T, x, E );
+    for (Int n = 0; n < M / 2; n++)
+    {
+      O[n] = Ops::mul( x[step], T[step][n] );
+      for (Int i = 3; i < M; i += 2)
+      {
+        O[n] = Ops::add( O[n], Ops::mul( x[step * i], T[step * i][n] ) );
+      }
+    }
+
+    /* combining even and odd terms */
+    for (Int n = 0; n < M / 2; n++)
+    {
+      y[n]         = Ops::add( E[n], O[n] );
+      y[M - 1 - n] = Ops::sub( E[n], O[n] );
+    }
+  }
+};
+
+template<class Ops, Int N>
+struct InverseButterfly<Ops, N, 1>
+{
+  static inline Void apply( const TMatrixCoeff T[N][N], const typename Ops::Vec x[N], typename Ops::Vec y[1] )
+  {
+    y[0] = Ops::mul( x[0], T[0][0] );
+  }
+};
+
+/// full N x N matrix multiplication in either direction, for the DST
+template<class Ops, Int N>
+static inline Void matrixMultiply( const TMatrixCoeff T[N][N], const typename Ops::Vec x[N], typename Ops::Vec y[N], Bool bInverse )
+{
+  for (Int k = 0; k < N; k++)
+  {
+    y[k] = Ops::mul( x[0], bInverse ? T[0][k] : T[k][0] );
+    for (Int n = 1; n < N; n++)
+    {
+      y[k] = Ops::add( y[k], Ops::mul( x[n], bInverse ? T[n][k] : T[k][n] ) );
+    }
+  }
+}
+
+// ====================================================================================================================
+// 1D transforms
+// ====================================================================================================================
+
+/** forward 1D transform of line lines of N samples, as partialButterflyN (or fastForwardDst if bDST)
+ *  \param src   input data, line after line
+ *  \param dst   output data, coefficient after coefficient (transposed)
+ *  \param shift specifies right shift after 1D transform
+ *  \param line  number of lines, a multiple of Ops::lanes
+ */
+template<class Ops, Int N, Bool bDST>
+static inline Void forwardTransform( const TMatrixCoeff T[N][N], const TCoeff *src, TCoeff *dst, Int shift, Int line )
+{
+  typedef typename Ops::Vec Vec;
+  const Vec add = Ops::set1( (shift > 0) ? (1 << (shift - 1)) : 0 );
+
+  for (Int j = 0; j < line; j += Ops::lanes)
+  {
+    // lane l holds line j+l
+    Vec x[N], y[N];
+    for (Int n = 0; n < N; n += Ops::lanes)
+    {
+      for (Int l = 0; l < Ops::lanes; l++)
+      {
+        x[n + l] = Ops::load( src + (j + l) * N + n );
+      }
+      Ops::transpose( x + n );
+    }
+
+    if (bDST)
+    {
+      matrixMultiply<Ops, N>( T, x, y, false );
+    }
+    else
+    {
+      ForwardButterfly<Ops, N, N>::apply( T, x, y );
+    }
+
+    for (Int k = 0; k < N; k++)
+    {
+      Ops::store( dst + k * line + j, Ops::sra( Ops::add( y[k], add ), shift ) );
+    }
+  }
+}
+
+/** inverse 1D transform of line lines of N coefficients, as partialButterflyInverseN (or fastInverseDst if bDST)
+ *  \param src            input data, coefficient after coefficient
+ *  \param dst            output data, line after line (transposed)
+ *  \param shift          specifies right shift after 1D transform
+ *  \param line           number of lines, a multiple of Ops::lanes
+ *  \param outputMinimum  minimum for clipping
+ *  \param outputMaximum  maximum for clipping
+ */
+template<class Ops, Int N, Bool bDST>
+static inline Void inverseTransform( const TMatrixCoeff T[N][N], const TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum )
+{
+  typedef typename Ops::Vec Vec;
+  const Vec add     = Ops::set1( (shift > 0) ? (1 << (shift - 1)) : 0 );
+  const Vec minimum = Ops::set1( outputMinimum );
+  const Vec maximum = Ops::set1( outputMaximum );
+
+  for (Int j = 0; j < line; j += Ops::lanes)
+  {
+    // lane l holds line j+l
+    Vec x[N], y[N];
+    for (Int k = 0; k < N; k++)
+    {
+      x[k] = Ops::load( src + k * line + j );
+    }
+
+    if (bDST)
+    {
+      matrixMultiply<Ops, N>( T, x, y, true );
+    }
+    else
+    {
+      InverseButterfly<Ops, N, N>::apply( T, x, y );
+    }
+
+    for (Int n = 0; n < N; n++)
+    {
+      y[n] = Ops::clip( Ops::sra( Ops::add( y[n], add ), shift ), minimum, maximum );
+    }
+    for (Int n = 0; n < N; n += Ops::lanes)
+    {
+      Ops::transpose( y + n );
+      for (Int l = 0; l < Ops::lanes; l++)
+      {
+        Ops::store( dst + (j + l) * N + n, y[n + l] );
+      }
+    }
+  }
+}
+
+//! \}
+
+#endif // __TCOMTRQUANTSIMDKERNELS__
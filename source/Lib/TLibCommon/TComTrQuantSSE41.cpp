@@ -0,0 +1,133 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTrQuantSSE41.cpp
+    \brief    SSE4.1 partial butterfly transforms
+*/
+
+#include "TComTrQuantSIMD.h"
+
+#if TRANSFORM_SIMD
+
+#include <smmintrin.h>
+#include "TComRom.h"
+
+// everything below is compiled for SSE4.1, and only called when the CPU supports it
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+namespace
+{
+
+/// four lanes of 32-bit coefficients
+struct OpsSSE41
+{
+  typedef __m128i Vec;
+  static const Int lanes = 4;
+
+  static inline Vec  load ( const TCoeff *p )       { return _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) ); }
+  static inline Void store( TCoeff *p, Vec a )      { _mm_storeu_si128( reinterpret_cast<__m128i*>( p ), a ); }
+  static inline Vec  set1 ( Int value )             { return _mm_set1_epi32( value ); }
+  static inline Vec  add  ( Vec a, Vec b )          { return _mm_add_epi32( a, b ); }
+  static inline Vec  sub  ( Vec a, Vec b )          { return _mm_sub_epi32( a, b ); }
+  static inline Vec  mul  ( Vec a, Int c )          { return _mm_mullo_epi32( a, _mm_set1_epi32( c ) ); }
+  static inline Vec  sra  ( Vec a, Int shift )      { return _mm_sra_epi32( a, _mm_cvtsi32_si128( shift ) ); }
+  static inline Vec  clip ( Vec a, Vec minimum, Vec maximum ) { return _mm_min_epi32( _mm_max_epi32( a, minimum ), maximum ); }
+
+  /// transpose 4x4 values, rows[i] lane j <-> rows[j] lane i
+  static inline Void transpose( Vec rows[4] )
+  {
+    const Vec t0 = _mm_unpacklo_epi32( rows[0], rows[1] );
+    const Vec t1 = _mm_unpacklo_epi32( rows[2], rows[3] );
+    const Vec t2 = _mm_unpackhi_epi32( rows[0], rows[1] );
+    const Vec t3 = _mm_unpackhi_epi32( rows[2], rows[3] );
+    rows[0] = _mm_unpacklo_epi64( t0, t1 );
+    rows[1] = _mm_unpackhi_epi64( t0, t1 );
+    rows[2] = _mm_unpacklo_epi64( t2, t3 );
+    rows[3] = _mm_unpackhi_epi64( t2, t3 );
+  }
+};
+
+} // namespace
+
+#include "TComTrQuantSIMDKernels.h"
+
+// ====================================================================================================================
+// Transforms
+// ====================================================================================================================
+
+static Void partialButterfly4SSE41 ( TCoeff *src, TCoeff *dst, Int shift, Int line ) { forwardTransform<OpsSSE41,  4, false>( g_aiT4 [TRANSFORM_FORWARD], src, dst, shift, line ); }
+static Void partialButterfly8SSE41 ( TCoeff *src, TCoeff *dst, Int shift, Int line ) { forwardTransform<OpsSSE41,  8, false>( g_aiT8 [TRANSFORM_FORWARD], src, dst, shift, line ); }
+static Void partialButterfly16SSE41( TCoeff *src, TCoeff *dst, Int shift, Int line ) { forwardTransform<OpsSSE41, 16, false>( g_aiT16[TRANSFORM_FORWARD], src, dst, shift, line ); }
+static Void partialButterfly32SSE41( TCoeff *src, TCoeff *dst, Int shift, Int line ) { forwardTransform<OpsSSE41, 32, false>( g_aiT32[TRANSFORM_FORWARD], src, dst, shift, line ); }
+
+static Void partialButterflyInverse4SSE41 ( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum ) { inverseTransform<OpsSSE41,  4, false>( g_aiT4 [TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum ); }
+static Void partialButterflyInverse8SSE41 ( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum ) { inverseTransform<OpsSSE41,  8, false>( g_aiT8 [TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum ); }
+static Void partialButterflyInverse16SSE41( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum ) { inverseTransform<OpsSSE41, 16, false>( g_aiT16[TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum ); }
+static Void partialButterflyInverse32SSE41( TCoeff *src, TCoeff *dst, Int shift, Int line, const TCoeff outputMinimum, const TCoeff outputMaximum ) { inverseTransform<OpsSSE41, 32, false>( g_aiT32[TRANSFORM_INVERSE], src, dst, shift, line, outputMinimum, outputMaximum ); }
+
+static Void fastForwardDstSSE41( TCoeff *block, TCoeff *coeff, Int shift )
+{
+  forwardTransform<OpsSSE41, 4, true>( g_as_DST_MAT_4[TRANSFORM_FORWARD], block, coeff, shift, 4 );
+}
+
+static Void fastInverseDstSSE41( TCoeff *tmp, TCoeff *block, Int shift, const TCoeff outputMinimum, const TCoeff outputMaximum )
+{
+  inverseTransform<OpsSSE41, 4, true>( g_as_DST_MAT_4[TRANSFORM_INVERSE], tmp, block, shift, 4, outputMinimum, outputMaximum );
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+Void setTransformFunctionsSSE41( TransformFunctions &functions )
+{
+  functions.partialButterfly       [0] = partialButterfly4SSE41;
+  functions.partialButterfly       [1] = partialButterfly8SSE41;
+  functions.partialButterfly       [2] = partialButterfly16SSE41;
+  functions.partialButterfly       [3] = partialButterfly32SSE41;
+  functions.partialButterflyInverse[0] = partialButterflyInverse4SSE41;
+  functions.partialButterflyInverse[1] = partialButterflyInverse8SSE41;
+  functions.partialButterflyInverse[2] = partialButterflyInverse16SSE41;
+  functions.partialButterflyInverse[3] = partialButterflyInverse32SSE41;
+  functions.fastForwardDst             = fastForwardDstSSE41;
+  functions.fastInverseDst             = fastInverseDstSSE41;
+}
+
+#endif // TRANSFORM_SIMD
@@ -620,6 +620,14 @@ enum FastInterSearchMode
   FASTINTERSEARCH_MODE3    = 3
 };
 
+enum ZeroBlockDetectionMode
+{
+  ZERO_BLOCK_DETECTION_OFF             = 0,
+  ZERO_BLOCK_DETECTION_CONSERVATIVE    = 1, ///< skip only the TUs whose levels are bound to quantise to zero
+  ZERO_BLOCK_DETECTION_AGGRESSIVE      = 2, ///< also skip the TUs whose residual is estimated to fall within the quantiser dead zone
+  NUMBER_OF_ZERO_BLOCK_DETECTION_MODES = 3
+};
+
 enum SPSExtensionFlagIndex
 {
   SPS_EXT__REXT           = 0,
@@ -783,6 +791,7 @@ struct TUEntropyCodingParameters
         UInt             widthInGroups;
         UInt             heightInGroups;
         UInt             firstSignificanceMapContext;
+  const UChar           *sigCtxIncTable;              ///< significance map context increments for the scan, channel and context type of the TU, see g_sigCtxInc
 };
 
 
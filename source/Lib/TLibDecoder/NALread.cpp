@@ -40,6 +40,7 @@
 #include <vector>
 #include <algorithm>
 #include <ostream>
+#include <cstring>
 
 #include "NALread.h"
 #include "TLibCommon/NAL.h"
@@ -57,33 +58,40 @@ using namespace std;
 //! \{
 static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, TComInputBitstream *bitstream, Bool isVclNalUnit)
 {
-  UInt zeroCount = 0;
-  vector<uint8_t>::iterator it_read, it_write;
-
-  UInt pos = 0;
   bitstream->clearEmulationPreventionByteLocation();
-  for (it_read = it_write = nalUnitBuf.begin(); it_read != nalUnitBuf.end(); it_read++, it_write++, pos++)
+  if (nalUnitBuf.empty())
+  {
+    return;
+  }
+  assert(nalUnitBuf.back() != 0x00);
+
+  /* the bytes between the emulation_prevention_three_bytes are moved down in
+   * runs; only the pairs of zero bytes found by the scanner are examined */
+  UChar* const pBuf   = &nalUnitBuf.front();
+  const UInt   uiSize = UInt(nalUnitBuf.size());
+  UInt uiRead  = 0;
+  UInt uiWrite = 0;
+  for (UInt uiPos = findZeroBytePair(pBuf, uiSize, 0); uiPos + 2 < uiSize; uiPos = findZeroBytePair(pBuf, uiSize, uiPos + 1))
   {
-    assert(zeroCount < 2 || *it_read >= 0x03);
-    if (zeroCount == 2 && *it_read == 0x03)
+    assert(pBuf[uiPos + 2] >= 0x03);
+    if (pBuf[uiPos + 2] == 0x03)
     {
-      bitstream->pushEmulationPreventionByteLocation( pos );
-      pos++;
-      it_read++;
-      zeroCount = 0;
+      const UInt uiEmulationPos = uiPos + 2;
+      memmove(pBuf + uiWrite, pBuf + uiRead, uiEmulationPos - uiRead);
+      uiWrite += uiEmulationPos - uiRead;
+      uiRead   = uiEmulationPos + 1;
+      bitstream->pushEmulationPreventionByteLocation( uiEmulationPos );
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
       TComCodingStatistics::IncrementStatisticEP(STATS__EMULATION_PREVENTION_3_BYTES, 8, 0);
 #endif
-      if (it_read == nalUnitBuf.end())
-      {
-        break;
-      }
-      assert(*it_read <= 0x03);
+      assert(uiRead == uiSize || pBuf[uiRead] <= 0x03);
+      // the zero count restarts after the emulation_prevention_three_byte
+      uiPos = uiEmulationPos;
     }
-    zeroCount = (*it_read == 0x00) ? zeroCount+1 : 0;
-    *it_write = *it_read;
   }
-  assert(zeroCount == 0);
+  memmove(pBuf + uiWrite, pBuf + uiRead, uiSize - uiRead);
+  uiWrite += uiSize - uiRead;
+  vector<uint8_t>::iterator it_write = nalUnitBuf.begin() + uiWrite;
 
   if (isVclNalUnit)
   {
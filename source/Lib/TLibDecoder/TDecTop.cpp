@@ -115,6 +115,7 @@ Void TDecTop::create()
 Void TDecTop::destroy()
 {
   m_cGopDecoder.destroy();
+  m_cThreadPool.destroy();
 
   delete m_apcSlicePilot;
   m_apcSlicePilot = NULL;
@@ -131,6 +132,17 @@ Void TDecTop::init()
   m_cEntropyDecoder.init(&m_cPrediction);
 }
 
+/** Set the number of threads of the in-loop filters
+ * \param iNumThreads number of threads, including the decoding thread (1: serial)
+ */
+Void TDecTop::setNumThreads( Int iNumThreads )
+{
+  m_cThreadPool.destroy();
+  m_cThreadPool.create( iNumThreads );
+  m_cLoopFilter.setThreadPool( &m_cThreadPool );
+  m_cSAO.setThreadPool( &m_cThreadPool );
+}
+
 Void TDecTop::deletePicBuffer ( )
 {
   TComList<TComPic*>::iterator  iterPic   = m_cListPic.begin();
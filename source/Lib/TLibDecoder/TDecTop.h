@@ -45,6 +45,7 @@
 #include "TLibCommon/TComTrQuant.h"
 #include "TLibCommon/TComPrediction.h"
 #include "TLibCommon/SEI.h"
+#include "TLibCommon/TComThreadPool.h"
 
 #include "TDecGop.h"
 #include "TDecEntropy.h"
@@ -90,6 +91,7 @@ private:
   SEIReader               m_seiReader;
   TComLoopFilter          m_cLoopFilter;
   TComSampleAdaptiveOffset m_cSAO;
+  TComThreadPool          m_cThreadPool;            ///< threads of the in-loop filters
 
   Bool isSkipPictureForBLA(Int& iPOCLastDisplay);
   Bool isRandomAccessSkipPicture(Int& iSkipFrame,  Int& iPOCLastDisplay);
@@ -121,6 +123,7 @@ public:
   Void  destroy ();
 
   Void setDecodedPictureHashSEIEnabled(Int enabled) { m_cGopDecoder.setDecodedPictureHashSEIEnabled(enabled); }
+  Void setNumThreads( Int iNumThreads );
 
   Void  init();
   Bool  decode(InputNALUnit& nalu, Int& iSkipFrame, Int& iPOCLastDisplay);
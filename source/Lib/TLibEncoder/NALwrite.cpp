@@ -84,42 +84,35 @@ Void write(ostream& out, OutputNALUnit& nalu)
    *  - 0x00000302
    *  - 0x00000303
    */
-  vector<uint8_t>& rbsp   = nalu.m_Bitstream.getFIFO();
-
-  vector<uint8_t> outputBuffer;
-  outputBuffer.resize(rbsp.size()*2+1); //there can never be enough emulation_prevention_three_bytes to require this much space
-  std::size_t outputAmount = 0;
-  Int         zeroCount    = 0;
-  for (vector<uint8_t>::iterator it = rbsp.begin(); it != rbsp.end(); it++)
+  const vector<uint8_t>& rbsp = nalu.m_Bitstream.getFIFO();
+  if (rbsp.empty())
   {
-    const uint8_t v=(*it);
-    if (zeroCount==2 && v<=3)
-    {
-      outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
-      zeroCount=0;
-    }
+    return;
+  }
 
-    if (v==0)
-    {
-      zeroCount++;
-    }
-    else
-    {
-      zeroCount=0;
-    }
-    outputBuffer[outputAmount++]=v;
+  /* the runs of bytes between the emulated start codes are written out
+   * unchanged in a single pass, with an emulation_prevention_three_byte
+   * in front of each byte that completes an emulated start code */
+  const UChar* pRbsp  = &rbsp.front();
+  const UInt   uiSize = UInt(rbsp.size());
+  UInt         uiRunStart = 0;
+  for (UInt uiPos = findStartCodeEmulation(pRbsp, uiSize, 0); uiPos < uiSize; uiPos = findStartCodeEmulation(pRbsp, uiSize, uiPos))
+  {
+    out.write(reinterpret_cast<const TChar*>(pRbsp + uiRunStart), uiPos - uiRunStart);
+    out.write(reinterpret_cast<const TChar*>(emulation_prevention_three_byte), 1);
+    uiRunStart = uiPos;
   }
+  out.write(reinterpret_cast<const TChar*>(pRbsp + uiRunStart), uiSize - uiRunStart);
 
   /* 7.4.1.1
    * ... when the last byte of the RBSP data is equal to 0x00 (which can
    * only occur when the RBSP ends in a cabac_zero_word), a final byte equal
    * to 0x03 is appended to the end of the data.
    */
-  if (zeroCount>0)
+  if (pRbsp[uiSize - 1] == 0)
   {
-    outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
+    out.write(reinterpret_cast<const TChar*>(emulation_prevention_three_byte), 1);
   }
-  out.write(reinterpret_cast<const TChar*>(&(*outputBuffer.begin())), outputAmount);
 }
 
 //! \}
@@ -307,23 +307,24 @@ Void TEncBinCABAC::encodeBinsEP( UInt binValues, Int numBins )
     return;
   }
 
-  while ( numBins > 8 )
+  // The low register holds 33 - m_bitsLeft significant bits (including the carry), so
+  // up to m_bitsLeft - 1 bins can be added in one step before whole bytes have to be
+  // moved out; with m_bitsLeft >= 12 between calls, at least 11 bins are coded per step.
+  while ( numBins > 0 )
   {
-    numBins -= 8;
-    UInt pattern = binValues >> numBins;
-    m_uiLow <<= 8;
+    const Int binsInStep = std::min<Int>( numBins, m_bitsLeft - 1 );
+    numBins -= binsInStep;
+    const UInt pattern = binValues >> numBins;
+    m_uiLow <<= binsInStep;
     m_uiLow += m_uiRange * pattern;
     binValues -= pattern << numBins;
-    m_bitsLeft -= 8;
+    m_bitsLeft -= binsInStep;
 
-    testAndWriteOut();
+    while ( m_bitsLeft < 12 )
+    {
+      writeOut();
+    }
   }
-
-  m_uiLow <<= numBins;
-  m_uiLow += m_uiRange * binValues;
-  m_bitsLeft -= numBins;
-
-  testAndWriteOut();
 }
 
 Void TEncBinCABAC::align()
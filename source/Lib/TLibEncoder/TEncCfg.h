@@ -198,6 +198,10 @@ protected:
   Bool      m_bFastMEAssumingSmootherMVEnabled;
   Int       m_minSearchWindow;
   Bool      m_bRestrictMESampling;
+  Bool      m_bUsePyramidME;                    ///< seed the integer motion search with a hierarchical motion pre-analysis
+  Bool      m_bUseSADTreeME;                    ///< reuse the sub-block distortions of the 2Nx2N integer search for the other partition shapes
+  Int       m_iNumMEThreads;                    ///< number of threads for the uni-directional motion searches of a PU over its reference pictures
+  Bool      m_bUseSEA;                          ///< successive elimination in the full-search integer motion estimation
 
   //====== Quality control ========
   Int       m_iMaxDeltaQP;                      //  Max. absolute delta QP (1:default)
@@ -230,6 +234,9 @@ protected:
 #if T0196_SELECTIVE_RDOQ
   Bool      m_useSelectiveRDOQ;
 #endif
+  Bool      m_useFastRDOQ;
+  ZeroBlockDetectionMode m_zeroBlockDetection;
+  Bool      m_useInterResidualCache;
   UInt      m_rdPenalty;
   FastInterSearchMode m_fastInterSearchMode;
   Bool      m_bUseEarlyCU;
@@ -278,6 +285,10 @@ protected:
   std::vector<Int> m_tileRowHeight;
 
   Bool      m_entropyCodingSyncEnabledFlag;
+  Int       m_iNumWppThreads;                   ///< number of threads compressing the CTU rows of a slice in wavefront order
+  Int       m_iNumTileThreads;                  ///< number of threads compressing the tiles of a slice
+  Int       m_iNumFrameThreads;                 ///< number of pictures of a GOP compressed in parallel
+  Int       m_iNumThreads;                      ///< number of threads of the thread pool shared by all parallel compression jobs
 
   HashType  m_decodedPictureHashSEIType;
   Bool      m_bufferingPeriodSEIEnabled;
@@ -481,6 +492,9 @@ public:
   Void      setMaxCUHeight                  ( UInt  u )      { m_maxCUHeight = u; }
   Void      setMaxTotalCUDepth              ( UInt  u )      { m_maxTotalCUDepth = u; }
   Void      setLog2DiffMaxMinCodingBlockSize( UInt  u )      { m_log2DiffMaxMinCodingBlockSize = u; }
+  UInt      getMaxCUWidth                   ()      const { return m_maxCUWidth;      }
+  UInt      getMaxCUHeight                  ()      const { return m_maxCUHeight;     }
+  UInt      getMaxTotalCUDepth              ()      const { return m_maxTotalCUDepth; }
 
   //======== Transform =============
   Void      setQuadtreeTULog2MaxSize        ( UInt  u )      { m_uiQuadtreeTULog2MaxSize = u; }
@@ -509,6 +523,10 @@ public:
   Void      setFastMEAssumingSmootherMVEnabled ( Bool b )    { m_bFastMEAssumingSmootherMVEnabled = b; }
   Void      setMinSearchWindow              ( Int   i )      { m_minSearchWindow = i; }
   Void      setRestrictMESampling           ( Bool  b )      { m_bRestrictMESampling = b; }
+  Void      setUsePyramidME                 ( Bool  b )      { m_bUsePyramidME = b; }
+  Void      setUseSADTreeME                 ( Bool  b )      { m_bUseSADTreeME = b; }
+  Void      setNumMEThreads                 ( Int   i )      { m_iNumMEThreads = i; }
+  Void      setUseSEA                       ( Bool  b )      { m_bUseSEA = b; }
 
   //====== Quality control ========
   Void      setMaxDeltaQP                   ( Int   i )      { m_iMaxDeltaQP = i; }
@@ -592,10 +610,17 @@ public:
   Bool      getDisableIntraPUsInInterSlices    () const { return m_bDisableIntraPUsInInterSlices; }
   MESearchMethod getMotionEstimationSearchMethod ( ) const { return m_motionEstimationSearchMethod; }
   Int       getSearchRange                     () const { return m_iSearchRange; }
+  Int       getBipredSearchRange               () const { return m_bipredSearchRange; }
   Bool      getClipForBiPredMeEnabled          () const { return m_bClipForBiPredMeEnabled; }
   Bool      getFastMEAssumingSmootherMVEnabled () const { return m_bFastMEAssumingSmootherMVEnabled; }
   Int       getMinSearchWindow                 () const { return m_minSearchWindow; }
   Bool      getRestrictMESampling              () const { return m_bRestrictMESampling; }
+  Bool      getUsePyramidME                    () const { return m_bUsePyramidME; }
+  Bool      getUseSADTreeME                    () const { return m_bUseSADTreeME; }
+  Int       getNumMEThreads                    () const { return m_iNumMEThreads; }
+  Bool      getUseSEA                          () const { return m_bUseSEA; }
+  //! integral images of the references are needed only where xPatternSearch can use the successive elimination bounds
+  Bool      getUseRecIntegralImages            () const { return m_bUseSEA && m_motionEstimationSearchMethod == MESEARCH_FULL && DISTORTION_PRECISION_ADJUSTMENT(m_bitDepth[CHANNEL_TYPE_LUMA] - 8) == 0; }
 
   //==== Quality control ========
   Int       getMaxDeltaQP                   ()      { return  m_iMaxDeltaQP; }
@@ -612,6 +637,9 @@ public:
 #if T0196_SELECTIVE_RDOQ
   Void      setUseSelectiveRDOQ             ( Bool b )      { m_useSelectiveRDOQ = b; }
 #endif
+  Void      setUseFastRDOQ                  ( Bool b )      { m_useFastRDOQ = b; }
+  Void      setZeroBlockDetection           ( ZeroBlockDetectionMode m ) { m_zeroBlockDetection = m; }
+  Void      setUseInterResidualCache        ( Bool b )      { m_useInterResidualCache = b; }
   Void      setRDpenalty                    ( UInt  u )     { m_rdPenalty  = u; }
   Void      setFastInterSearchMode          ( FastInterSearchMode m ) { m_fastInterSearchMode = m; }
   Void      setUseEarlyCU                   ( Bool  b )     { m_bUseEarlyCU = b; }
@@ -639,6 +667,9 @@ public:
 #if T0196_SELECTIVE_RDOQ
   Bool      getUseSelectiveRDOQ             ()      { return m_useSelectiveRDOQ; }
 #endif
+  Bool      getUseFastRDOQ                  ()      { return m_useFastRDOQ; }
+  ZeroBlockDetectionMode getZeroBlockDetection() const { return m_zeroBlockDetection; }
+  Bool      getUseInterResidualCache        () const { return m_useInterResidualCache; }
   Int       getRDpenalty                    ()      { return m_rdPenalty;  }
   FastInterSearchMode getFastInterSearchMode() const{ return m_fastInterSearchMode;  }
   Bool      getUseEarlyCU                   ()      { return m_bUseEarlyCU; }
@@ -729,6 +760,14 @@ public:
   Void  xCheckGSParameters();
   Void  setEntropyCodingSyncEnabledFlag(Bool b)                      { m_entropyCodingSyncEnabledFlag = b; }
   Bool  getEntropyCodingSyncEnabledFlag() const                      { return m_entropyCodingSyncEnabledFlag; }
+  Void  setNumWppThreads(Int i)                                      { m_iNumWppThreads = i; }
+  Int   getNumWppThreads() const                                     { return m_iNumWppThreads; }
+  Void  setNumTileThreads(Int i)                                     { m_iNumTileThreads = i; }
+  Int   getNumTileThreads() const                                    { return m_iNumTileThreads; }
+  Void  setNumFrameThreads(Int i)                                    { m_iNumFrameThreads = i; }
+  Int   getNumFrameThreads() const                                   { return m_iNumFrameThreads; }
+  Void  setNumThreads(Int i)                                         { m_iNumThreads = i; }
+  Int   getNumThreads() const                                        { return m_iNumThreads; }
   Void  setDecodedPictureHashSEIType(HashType m)                     { m_decodedPictureHashSEIType = m; }
   HashType getDecodedPictureHashSEIType() const                      { return m_decodedPictureHashSEIType; }
   Void  setBufferingPeriodSEIEnabled(Bool b)                         { m_bufferingPeriodSEIEnabled = b; }
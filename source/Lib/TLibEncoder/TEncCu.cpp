@@ -205,18 +205,27 @@ Void TEncCu::destroy()
  */
 Void TEncCu::init( TEncTop* pcEncTop )
 {
-  m_pcEncCfg           = pcEncTop;
-  m_pcPredSearch       = pcEncTop->getPredSearch();
-  m_pcTrQuant          = pcEncTop->getTrQuant();
-  m_pcRdCost           = pcEncTop->getRdCost();
+  init( pcEncTop, pcEncTop->getPredSearch(), pcEncTop->getTrQuant(), pcEncTop->getRdCost(),
+        pcEncTop->getEntropyCoder(), pcEncTop->getBinCABAC(), pcEncTop->getRDSbacCoder(),
+        pcEncTop->getRDGoOnSbacCoder(), pcEncTop->getRateCtrl() );
+}
+
+Void TEncCu::init( TEncCfg* pcEncCfg, TEncSearch* pcPredSearch, TComTrQuant* pcTrQuant, TComRdCost* pcRdCost,
+                   TEncEntropy* pcEntropyCoder, TEncBinCABAC* pcBinCABAC, TEncSbac*** pppcRDSbacCoder,
+                   TEncSbac* pcRDGoOnSbacCoder, TEncRateCtrl* pcRateCtrl )
+{
+  m_pcEncCfg           = pcEncCfg;
+  m_pcPredSearch       = pcPredSearch;
+  m_pcTrQuant          = pcTrQuant;
+  m_pcRdCost           = pcRdCost;
 
-  m_pcEntropyCoder     = pcEncTop->getEntropyCoder();
-  m_pcBinCABAC         = pcEncTop->getBinCABAC();
+  m_pcEntropyCoder     = pcEntropyCoder;
+  m_pcBinCABAC         = pcBinCABAC;
 
-  m_pppcRDSbacCoder    = pcEncTop->getRDSbacCoder();
-  m_pcRDGoOnSbacCoder  = pcEncTop->getRDGoOnSbacCoder();
+  m_pppcRDSbacCoder    = pppcRDSbacCoder;
+  m_pcRDGoOnSbacCoder  = pcRDGoOnSbacCoder;
 
-  m_pcRateCtrl         = pcEncTop->getRateCtrl();
+  m_pcRateCtrl         = pcRateCtrl;
 }
 
 // ====================================================================================================================
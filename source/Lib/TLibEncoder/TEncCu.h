@@ -102,6 +102,11 @@ public:
   /// copy parameters from encoder class
   Void  init                ( TEncTop* pcEncTop );
 
+  /// use the given set of encoding modules instead of the ones of the encoder class
+  Void  init                ( TEncCfg* pcEncCfg, TEncSearch* pcPredSearch, TComTrQuant* pcTrQuant, TComRdCost* pcRdCost,
+                              TEncEntropy* pcEntropyCoder, TEncBinCABAC* pcBinCABAC, TEncSbac*** pppcRDSbacCoder,
+                              TEncSbac* pcRDGoOnSbacCoder, TEncRateCtrl* pcRateCtrl );
+
   /// create internal buffers
   Void  create              ( UChar uhTotalDepth, UInt iMaxWidth, UInt iMaxHeight, ChromaFormat chromaFormat );
 
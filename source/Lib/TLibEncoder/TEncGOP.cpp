@@ -98,6 +98,7 @@ TEncGOP::TEncGOP()
   m_bufferingPeriodSEIPresentInAU = false;
   m_associatedIRAPType = NAL_UNIT_CODED_SLICE_IDR_N_LP;
   m_associatedIRAPPOC  = 0;
+  m_bPicEncoderScalingListSet = false;
 #if W0038_DB_OPT
   m_pcDeblockingTempPicYuv = NULL;
 #endif
@@ -118,6 +119,11 @@ Void  TEncGOP::create()
 
 Void  TEncGOP::destroy()
 {
+  for ( UInt i = 0; i < m_apcPicEncoders.size(); i++ )
+  {
+    delete m_apcPicEncoders[i];
+  }
+  m_apcPicEncoders.clear();
 #if W0038_DB_OPT
   if (m_pcDeblockingTempPicYuv)
   {
@@ -147,6 +153,19 @@ Void TEncGOP::init ( TEncTop* pcTEncTop )
   m_lastBPSEI          = 0;
   m_totalCoded         = 0;
 
+  // picture encoders of the frame-parallel compression
+  if ( m_pcCfg->getNumFrameThreads() > 1 )
+  {
+    for ( Int i = 0; i < m_pcCfg->getNumFrameThreads(); i++ )
+    {
+      TEncPicEncoder* pcPicEncoder = new TEncPicEncoder;
+      pcPicEncoder->m_cModules.create( m_pcCfg, m_pcRateCtrl, pcTEncTop->getThreadPool() );
+      pcPicEncoder->m_cSliceEncoder.create( m_pcCfg->getSourceWidth(), m_pcCfg->getSourceHeight(), m_pcCfg->getChromaFormatIdc(),
+                                            m_pcCfg->getMaxCUWidth(), m_pcCfg->getMaxCUHeight(), m_pcCfg->getMaxTotalCUDepth() );
+      pcPicEncoder->m_cSliceEncoder.init( pcTEncTop, &pcPicEncoder->m_cModules );
+      m_apcPicEncoders.push_back( pcPicEncoder );
+    }
+  }
 }
 
 Int TEncGOP::xWriteVPS (AccessUnit &accessUnit, const TComVPS *vps)
@@ -1103,6 +1122,10 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     effFieldIRAPMap.initialize(isField, m_iGopSize, iPOCLast, iNumPicRcvd, m_iLastIDR, this, m_pcCfg);
   }
 
+  // coding state of the pictures, and whether the pictures that do not reference each other are compressed in parallel
+  std::vector<PicState> acPics( m_iGopSize );
+  const Bool bFrameParallel = xUseFrameParallel( isField );
+
   // reset flag indicating whether pictures have been encoded
   for ( Int iGOPid=0; iGOPid < m_iGopSize; iGOPid++ )
   {
@@ -1116,30 +1139,9 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       iGOPid=effFieldIRAPMap.adjustGOPid(iGOPid);
     }
 
-    //-- For time output for each slice
-    clock_t iBeforeTime = clock();
-
-    UInt uiColDir = calculateCollocatedFromL1Flag(m_pcCfg, iGOPid, m_iGopSize);
-
-    /////////////////////////////////////////////////////////////////////////////////////////////////// Initial to start encoding
     Int iTimeOffset;
     Int pocCurr;
-
-    if(iPOCLast == 0) //case first frame or first top field
-    {
-      pocCurr=0;
-      iTimeOffset = 1;
-    }
-    else if(iPOCLast == 1 && isField) //case first bottom field, just like the first frame, the poc computation is not right anymore, we set the right value
-    {
-      pocCurr = 1;
-      iTimeOffset = 1;
-    }
-    else
-    {
-      pocCurr = iPOCLast - iNumPicRcvd + m_pcCfg->getGOPEntry(iGOPid).m_POC - ((isField && m_iGopSize>1) ? 1:0);
-      iTimeOffset = m_pcCfg->getGOPEntry(iGOPid).m_POC;
-    }
+    xGetPOC( iGOPid, iPOCLast, iNumPicRcvd, isField, pocCurr, iTimeOffset );
 
     if(pocCurr>=m_pcCfg->getFramesToBeEncoded())
     {
@@ -1150,391 +1152,27 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       continue;
     }
 
-    if( getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_W_RADL || getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_N_LP )
-    {
-      m_iLastIDR = pocCurr;
-    }
-    // start a new access unit: create an entry in the list of output access units
-    accessUnitsInGOP.push_back(AccessUnit());
-    AccessUnit& accessUnit = accessUnitsInGOP.back();
-    xGetBuffer( rcListPic, rcListPicYuvRecOut, iNumPicRcvd, iTimeOffset, pcPic, pcPicYuvRecOut, pocCurr, isField );
-
-    //  Slice data initialization
-    pcPic->clearSliceBuffer();
-    pcPic->allocateNewSlice();
-    m_pcSliceEncoder->setSliceIdx(0);
-    pcPic->setCurrSliceIdx(0);
-
-    m_pcSliceEncoder->initEncSlice ( pcPic, iPOCLast, pocCurr, iGOPid, pcSlice, isField );
-
-    //Set Frame/Field coding
-    pcSlice->getPic()->setField(isField);
-
-    pcSlice->setLastIDR(m_iLastIDR);
-    pcSlice->setSliceIdx(0);
-    //set default slice level flag to the same as SPS level flag
-    pcSlice->setLFCrossSliceBoundaryFlag(  pcSlice->getPPS()->getLoopFilterAcrossSlicesEnabledFlag()  );
-
-    if(pcSlice->getSliceType()==B_SLICE&&m_pcCfg->getGOPEntry(iGOPid).m_sliceType=='P')
-    {
-      pcSlice->setSliceType(P_SLICE);
-    }
-    if(pcSlice->getSliceType()==B_SLICE&&m_pcCfg->getGOPEntry(iGOPid).m_sliceType=='I')
-    {
-      pcSlice->setSliceType(I_SLICE);
-    }
-    
-    // Set the nal unit type
-    pcSlice->setNalUnitType(getNalUnitType(pocCurr, m_iLastIDR, isField));
-    if(pcSlice->getTemporalLayerNonReferenceFlag())
-    {
-      if (pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_TRAIL_R &&
-          !(m_iGopSize == 1 && pcSlice->getSliceType() == I_SLICE))
-        // Add this condition to avoid POC issues with encoder_intra_main.cfg configuration (see #1127 in bug tracker)
-      {
-        pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TRAIL_N);
-      }
-      if(pcSlice->getNalUnitType()==NAL_UNIT_CODED_SLICE_RADL_R)
-      {
-        pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_RADL_N);
-      }
-      if(pcSlice->getNalUnitType()==NAL_UNIT_CODED_SLICE_RASL_R)
-      {
-        pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_RASL_N);
-      }
-    }
-
-    if (m_pcCfg->getEfficientFieldIRAPEnabled())
-    {
-      if ( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_RADL
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_N_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_W_RADL
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_N_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA )  // IRAP picture
-      {
-        m_associatedIRAPType = pcSlice->getNalUnitType();
-        m_associatedIRAPPOC = pocCurr;
-      }
-      pcSlice->setAssociatedIRAPType(m_associatedIRAPType);
-      pcSlice->setAssociatedIRAPPOC(m_associatedIRAPPOC);
-    }
-    // Do decoding refresh marking if any
-    pcSlice->decodingRefreshMarking(m_pocCRA, m_bRefreshPending, rcListPic, m_pcCfg->getEfficientFieldIRAPEnabled());
-    m_pcEncTop->selectReferencePictureSet(pcSlice, pocCurr, iGOPid);
-    if (!m_pcCfg->getEfficientFieldIRAPEnabled())
-    {
-      if ( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_RADL
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_N_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_W_RADL
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_N_LP
-        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA )  // IRAP picture
-      {
-        m_associatedIRAPType = pcSlice->getNalUnitType();
-        m_associatedIRAPPOC = pocCurr;
-      }
-      pcSlice->setAssociatedIRAPType(m_associatedIRAPType);
-      pcSlice->setAssociatedIRAPPOC(m_associatedIRAPPOC);
-    }
-
-    if ((pcSlice->checkThatAllRefPicsAreAvailable(rcListPic, pcSlice->getRPS(), false, m_iLastRecoveryPicPOC, m_pcCfg->getDecodingRefreshType() == 3) != 0) || (pcSlice->isIRAP()) 
-      || (m_pcCfg->getEfficientFieldIRAPEnabled() && isField && pcSlice->getAssociatedIRAPType() >= NAL_UNIT_CODED_SLICE_BLA_W_LP && pcSlice->getAssociatedIRAPType() <= NAL_UNIT_CODED_SLICE_CRA && pcSlice->getAssociatedIRAPPOC() == pcSlice->getPOC()+1)
-      )
-    {
-      pcSlice->createExplicitReferencePictureSetFromReference(rcListPic, pcSlice->getRPS(), pcSlice->isIRAP(), m_iLastRecoveryPicPOC, m_pcCfg->getDecodingRefreshType() == 3, m_pcCfg->getEfficientFieldIRAPEnabled());
-    }
-
-    pcSlice->applyReferencePictureSet(rcListPic, pcSlice->getRPS());
-
-    if(pcSlice->getTLayer() > 0 
-      &&  !( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_N     // Check if not a leading picture
-          || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_R
-          || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RASL_N
-          || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RASL_R )
-        )
-    {
-      if(pcSlice->isTemporalLayerSwitchingPoint(rcListPic) || pcSlice->getSPS()->getTemporalIdNestingFlag())
-      {
-        if(pcSlice->getTemporalLayerNonReferenceFlag())
-        {
-          pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TSA_N);
-        }
-        else
-        {
-          pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TSA_R);
-        }
-      }
-      else if(pcSlice->isStepwiseTemporalLayerSwitchingPointCandidate(rcListPic))
-      {
-        Bool isSTSA=true;
-        for(Int ii=iGOPid+1;(ii<m_pcCfg->getGOPSize() && isSTSA==true);ii++)
-        {
-          Int lTid= m_pcCfg->getGOPEntry(ii).m_temporalId;
-          if(lTid==pcSlice->getTLayer())
-          {
-            const TComReferencePictureSet* nRPS = pcSlice->getSPS()->getRPSList()->getReferencePictureSet(ii);
-            for(Int jj=0;jj<nRPS->getNumberOfPictures();jj++)
-            {
-              if(nRPS->getUsed(jj))
-              {
-                Int tPoc=m_pcCfg->getGOPEntry(ii).m_POC+nRPS->getDeltaPOC(jj);
-                Int kk=0;
-                for(kk=0;kk<m_pcCfg->getGOPSize();kk++)
-                {
-                  if(m_pcCfg->getGOPEntry(kk).m_POC==tPoc)
-                  {
-                    break;
-                  }
-                }
-                Int tTid=m_pcCfg->getGOPEntry(kk).m_temporalId;
-                if(tTid >= pcSlice->getTLayer())
-                {
-                  isSTSA=false;
-                  break;
-                }
-              }
-            }
-          }
-        }
-        if(isSTSA==true)
-        {
-          if(pcSlice->getTemporalLayerNonReferenceFlag())
-          {
-            pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_STSA_N);
-          }
-          else
-          {
-            pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_STSA_R);
-          }
-        }
-      }
-    }
-    arrangeLongtermPicturesInRPS(pcSlice, rcListPic);
-    TComRefPicListModification* refPicListModification = pcSlice->getRefPicListModification();
-    refPicListModification->setRefPicListModificationFlagL0(0);
-    refPicListModification->setRefPicListModificationFlagL1(0);
-    pcSlice->setNumRefIdx(REF_PIC_LIST_0,min(m_pcCfg->getGOPEntry(iGOPid).m_numRefPicsActive,pcSlice->getRPS()->getNumberOfPictures()));
-    pcSlice->setNumRefIdx(REF_PIC_LIST_1,min(m_pcCfg->getGOPEntry(iGOPid).m_numRefPicsActive,pcSlice->getRPS()->getNumberOfPictures()));
-
-    //  Set reference list
-    pcSlice->setRefPicList ( rcListPic );
-
-    //  Slice info. refinement
-    if ( (pcSlice->getSliceType() == B_SLICE) && (pcSlice->getNumRefIdx(REF_PIC_LIST_1) == 0) )
-    {
-      pcSlice->setSliceType ( P_SLICE );
-    }
-    pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
-
-    if (pcSlice->getSliceType() == B_SLICE)
-    {
-      pcSlice->setColFromL0Flag(1-uiColDir);
-      Bool bLowDelay = true;
-      Int  iCurrPOC  = pcSlice->getPOC();
-      Int iRefIdx = 0;
-
-      for (iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx(REF_PIC_LIST_0) && bLowDelay; iRefIdx++)
-      {
-        if ( pcSlice->getRefPic(REF_PIC_LIST_0, iRefIdx)->getPOC() > iCurrPOC )
-        {
-          bLowDelay = false;
-        }
-      }
-      for (iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx(REF_PIC_LIST_1) && bLowDelay; iRefIdx++)
-      {
-        if ( pcSlice->getRefPic(REF_PIC_LIST_1, iRefIdx)->getPOC() > iCurrPOC )
-        {
-          bLowDelay = false;
-        }
-      }
-
-      pcSlice->setCheckLDC(bLowDelay);
-    }
-    else
-    {
-      pcSlice->setCheckLDC(true);
-    }
-
-    uiColDir = 1-uiColDir;
-
-    //-------------------------------------------------------------
-    pcSlice->setRefPOCList();
-
-    pcSlice->setList1IdxToList0Idx();
-
-    if (m_pcEncTop->getTMVPModeId() == 2)
-    {
-      if (iGOPid == 0) // first picture in SOP (i.e. forward B)
-      {
-        pcSlice->setEnableTMVPFlag(0);
-      }
-      else
-      {
-        // Note: pcSlice->getColFromL0Flag() is assumed to be always 0 and getcolRefIdx() is always 0.
-        pcSlice->setEnableTMVPFlag(1);
-      }
-    }
-    else if (m_pcEncTop->getTMVPModeId() == 1)
-    {
-      pcSlice->setEnableTMVPFlag(1);
-    }
-    else
-    {
-      pcSlice->setEnableTMVPFlag(0);
-    }
-    
-    // set adaptive search range for non-intra-slices
-    if (m_pcCfg->getUseASR() && pcSlice->getSliceType()!=I_SLICE)
-    {
-      m_pcSliceEncoder->setSearchRange(pcSlice);
-    }
-
-    Bool bGPBcheck=false;
-    if ( pcSlice->getSliceType() == B_SLICE)
-    {
-      if ( pcSlice->getNumRefIdx(RefPicList( 0 ) ) == pcSlice->getNumRefIdx(RefPicList( 1 ) ) )
-      {
-        bGPBcheck=true;
-        Int i;
-        for ( i=0; i < pcSlice->getNumRefIdx(RefPicList( 1 ) ); i++ )
-        {
-          if ( pcSlice->getRefPOC(RefPicList(1), i) != pcSlice->getRefPOC(RefPicList(0), i) )
-          {
-            bGPBcheck=false;
-            break;
-          }
-        }
-      }
-    }
-    if(bGPBcheck)
+    PicState& rcPic = acPics[iGOPid];
+    if ( !bFrameParallel )
     {
-      pcSlice->setMvdL1ZeroFlag(true);
+      rcPic.pcSliceEncoder = m_pcSliceEncoder;
+      xPreparePicture( rcPic, iGOPid, pocCurr, iTimeOffset, iPOCLast, iNumPicRcvd, rcListPic, rcListPicYuvRecOut, accessUnitsInGOP, isField );
+      xCompressPicture( rcPic );
     }
-    else
+    else if ( rcPic.pcPic == NULL )
     {
-      pcSlice->setMvdL1ZeroFlag(false);
+      xCompressPicturesInParallel( acPics, iGOPid, iPOCLast, iNumPicRcvd, rcListPic, rcListPicYuvRecOut, accessUnitsInGOP );
     }
-    pcPic->getSlice(pcSlice->getSliceIdx())->setMvdL1ZeroFlag(pcSlice->getMvdL1ZeroFlag());
 
-
-    Double lambda            = 0.0;
+    /////////////////////////////////////////////////////////////////////////////////////////////////// Loop filter and file writing
+    pcPic          = rcPic.pcPic;
+    pcPicYuvRecOut = rcPic.pcPicYuvRecOut;
+    pcSlice        = pcPic->getSlice(0);
+    AccessUnit& accessUnit        = *rcPic.pcAccessUnit;
+    const UInt uiNumSliceSegments = rcPic.uiNumSliceSegments;
     Int actualHeadBits       = 0;
     Int actualTotalBits      = 0;
-    Int estimatedBits        = 0;
     Int tmpBitsBeforeWriting = 0;
-    if ( m_pcCfg->getUseRateCtrl() ) // TODO: does this work with multiple slices and slice-segments?
-    {
-      Int frameLevel = m_pcRateCtrl->getRCSeq()->getGOPID2Level( iGOPid );
-      if ( pcPic->getSlice(0)->getSliceType() == I_SLICE )
-      {
-        frameLevel = 0;
-      }
-      m_pcRateCtrl->initRCPic( frameLevel );
-      estimatedBits = m_pcRateCtrl->getRCPic()->getTargetBits();
-
-#if U0132_TARGET_BITS_SATURATION
-      if (m_pcRateCtrl->getCpbSaturationEnabled() && frameLevel != 0)
-      {
-        Int estimatedCpbFullness = m_pcRateCtrl->getCpbState() + m_pcRateCtrl->getBufferingRate();
-
-        // prevent overflow
-        if (estimatedCpbFullness - estimatedBits > (Int)(m_pcRateCtrl->getCpbSize()*0.9f))
-        {
-          estimatedBits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.9f);
-        }
-
-        estimatedCpbFullness -= m_pcRateCtrl->getBufferingRate();
-        // prevent underflow
-#if V0078_ADAPTIVE_LOWER_BOUND
-        if (estimatedCpbFullness - estimatedBits < m_pcRateCtrl->getRCPic()->getLowerBound())
-        {
-          estimatedBits = max(200, estimatedCpbFullness - m_pcRateCtrl->getRCPic()->getLowerBound());
-        }
-#else
-        if (estimatedCpbFullness - estimatedBits < (Int)(m_pcRateCtrl->getCpbSize()*0.1f))
-        {
-          estimatedBits = max(200, estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.1f));
-        }
-#endif
-
-        m_pcRateCtrl->getRCPic()->setTargetBits(estimatedBits);
-      }
-#endif
-
-      Int sliceQP = m_pcCfg->getInitialQP();
-      if ( ( pcSlice->getPOC() == 0 && m_pcCfg->getInitialQP() > 0 ) || ( frameLevel == 0 && m_pcCfg->getForceIntraQP() ) ) // QP is specified
-      {
-        Int    NumberBFrames = ( m_pcCfg->getGOPSize() - 1 );
-        Double dLambda_scale = 1.0 - Clip3( 0.0, 0.5, 0.05*(Double)NumberBFrames );
-        Double dQPFactor     = 0.57*dLambda_scale;
-        Int    SHIFT_QP      = 12;
-        Int    bitdepth_luma_qp_scale = 0;
-        Double qp_temp = (Double) sliceQP + bitdepth_luma_qp_scale - SHIFT_QP;
-        lambda = dQPFactor*pow( 2.0, qp_temp/3.0 );
-      }
-      else if ( frameLevel == 0 )   // intra case, but use the model
-      {
-        m_pcSliceEncoder->calCostSliceI(pcPic); // TODO: This only analyses the first slice segment - what about the others?
-
-        if ( m_pcCfg->getIntraPeriod() != 1 )   // do not refine allocated bits for all intra case
-        {
-          Int bits = m_pcRateCtrl->getRCSeq()->getLeftAverageBits();
-          bits = m_pcRateCtrl->getRCPic()->getRefineBitsForIntra( bits );
-
-#if U0132_TARGET_BITS_SATURATION
-          if (m_pcRateCtrl->getCpbSaturationEnabled() )
-          {
-            Int estimatedCpbFullness = m_pcRateCtrl->getCpbState() + m_pcRateCtrl->getBufferingRate();
-
-            // prevent overflow
-            if (estimatedCpbFullness - bits > (Int)(m_pcRateCtrl->getCpbSize()*0.9f))
-            {
-              bits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.9f);
-            }
-
-            estimatedCpbFullness -= m_pcRateCtrl->getBufferingRate();
-            // prevent underflow
-#if V0078_ADAPTIVE_LOWER_BOUND
-            if (estimatedCpbFullness - bits < m_pcRateCtrl->getRCPic()->getLowerBound())
-            {
-              bits = estimatedCpbFullness - m_pcRateCtrl->getRCPic()->getLowerBound();
-            }
-#else
-            if (estimatedCpbFullness - bits < (Int)(m_pcRateCtrl->getCpbSize()*0.1f))
-            {
-              bits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.1f);
-            }
-#endif
-          }
-#endif
-
-          if ( bits < 200 )
-          {
-            bits = 200;
-          }
-          m_pcRateCtrl->getRCPic()->setTargetBits( bits );
-        }
-
-        list<TEncRCPic*> listPreviousPicture = m_pcRateCtrl->getPicList();
-        m_pcRateCtrl->getRCPic()->getLCUInitTargetBits();
-        lambda  = m_pcRateCtrl->getRCPic()->estimatePicLambda( listPreviousPicture, pcSlice->getSliceType());
-        sliceQP = m_pcRateCtrl->getRCPic()->estimatePicQP( lambda, listPreviousPicture );
-      }
-      else    // normal case
-      {
-        list<TEncRCPic*> listPreviousPicture = m_pcRateCtrl->getPicList();
-        lambda  = m_pcRateCtrl->getRCPic()->estimatePicLambda( listPreviousPicture, pcSlice->getSliceType());
-        sliceQP = m_pcRateCtrl->getRCPic()->estimatePicQP( lambda, listPreviousPicture );
-      }
-
-      sliceQP = Clip3( -pcSlice->getSPS()->getQpBDOffset(CHANNEL_TYPE_LUMA), MAX_QP, sliceQP );
-      m_pcRateCtrl->getRCPic()->setPicEstQP( sliceQP );
-
-      m_pcSliceEncoder->resetQP( pcPic, sliceQP, lambda );
-    }
-
-    UInt uiNumSliceSegments = 1;
 
     // Allocate some coders, now the number of tiles are known.
     const Int numSubstreamsColumns = (pcSlice->getPPS()->getNumTileColumnsMinus1() + 1);
@@ -1542,51 +1180,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     const Int numSubstreams        = numSubstreamRows * numSubstreamsColumns;
     std::vector<TComOutputBitstream> substreamsOut(numSubstreams);
 
-    // now compress (trial encode) the various slice segments (slices, and dependent slices)
-    {
-      const UInt numberOfCtusInFrame=pcPic->getPicSym()->getNumberOfCtusInFrame();
-      pcSlice->setSliceCurStartCtuTsAddr( 0 );
-      pcSlice->setSliceSegmentCurStartCtuTsAddr( 0 );
-
-      for(UInt nextCtuTsAddr = 0; nextCtuTsAddr < numberOfCtusInFrame; )
-      {
-        m_pcSliceEncoder->precompressSlice( pcPic );
-        m_pcSliceEncoder->compressSlice   ( pcPic, false, false );
-
-        const UInt curSliceSegmentEnd = pcSlice->getSliceSegmentCurEndCtuTsAddr();
-        if (curSliceSegmentEnd < numberOfCtusInFrame)
-        {
-          const Bool bNextSegmentIsDependentSlice=curSliceSegmentEnd<pcSlice->getSliceCurEndCtuTsAddr();
-          const UInt sliceBits=pcSlice->getSliceBits();
-          pcPic->allocateNewSlice();
-          // prepare for next slice
-          pcPic->setCurrSliceIdx                    ( uiNumSliceSegments );
-          m_pcSliceEncoder->setSliceIdx             ( uiNumSliceSegments   );
-          pcSlice = pcPic->getSlice                 ( uiNumSliceSegments   );
-          assert(pcSlice->getPPS()!=0);
-          pcSlice->copySliceInfo                    ( pcPic->getSlice(uiNumSliceSegments-1)  );
-          pcSlice->setSliceIdx                      ( uiNumSliceSegments   );
-          if (bNextSegmentIsDependentSlice)
-          {
-            pcSlice->setSliceBits(sliceBits);
-          }
-          else
-          {
-            pcSlice->setSliceCurStartCtuTsAddr      ( curSliceSegmentEnd );
-            pcSlice->setSliceBits(0);
-          }
-          pcSlice->setDependentSliceSegmentFlag(bNextSegmentIsDependentSlice);
-          pcSlice->setSliceSegmentCurStartCtuTsAddr ( curSliceSegmentEnd );
-          // TODO: optimise cabac_init during compress slice to improve multi-slice operation
-          // pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
-          uiNumSliceSegments ++;
-        }
-        nextCtuTsAddr = curSliceSegmentEnd;
-      }
-    }
-
     duData.clear();
-    pcSlice = pcPic->getSlice(0);
 
     // SAO parameter estimation using non-deblocked pixels for CTU bottom and right boundary areas
     if( pcSlice->getSPS()->getUseSAO() && m_pcCfg->getSaoCtuBoundary() )
@@ -1792,7 +1386,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     pcPic->compressMotion();
 
     //-- For time output for each slice
-    Double dEncTime = (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
+    Double dEncTime = (Double)(clock()-rcPic.iBeforeTime) / CLOCKS_PER_SEC;
 
     std::string digestStr;
     if (m_pcCfg->getDecodedPictureHashSEIType()!=HASHTYPE_NONE)
@@ -1815,7 +1409,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       Double avgLambda = m_pcRateCtrl->getRCPic()->calAverageLambda();
       if ( avgLambda < 0.0 )
       {
-        avgLambda = lambda;
+        avgLambda = rcPic.dLambda;
       }
 
       m_pcRateCtrl->getRCPic()->updateAfterPicture( actualHeadBits, actualTotalBits, avgQP, avgLambda, pcSlice->getSliceType());
@@ -1828,7 +1422,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       }
       else    // for intra picture, the estimated bits are used to update the current status in the GOP
       {
-        m_pcRateCtrl->getRCGOP()->updateAfterPicture( estimatedBits );
+        m_pcRateCtrl->getRCGOP()->updateAfterPicture( rcPic.iEstimatedBits );
       }
 #if U0132_TARGET_BITS_SATURATION
       if (m_pcRateCtrl->getCpbSaturationEnabled())
@@ -1927,6 +1521,16 @@ Void TEncGOP::printOutSummary(UInt uiNumAllPicCoded, Bool isField, const Bool pr
   }
 
   printf("\nRVM: %.3lf\n" , xCalculateRVM());
+
+  if (m_pcCfg->getZeroBlockDetection() != ZERO_BLOCK_DETECTION_OFF)
+  {
+    TEncSearch::printZeroBlockStatistics(m_pcCfg->getZeroBlockDetection());
+  }
+
+  if (m_pcCfg->getUseInterResidualCache())
+  {
+    TEncSearch::printResidualCacheStatistics();
+  }
 }
 
 Void TEncGOP::preLoopFilterPicAll( TComPic* pcPic, UInt64& ruiDist )
@@ -2008,6 +1612,579 @@ Void TEncGOP::xGetBuffer( TComList<TComPic*>&      rcListPic,
   return;
 }
 
+/** Determine the POC of a picture of the GOP and its offset to the last received picture
+ */
+Void TEncGOP::xGetPOC( Int iGOPid, Int iPOCLast, Int iNumPicRcvd, Bool isField, Int& rpocCurr, Int& riTimeOffset )
+{
+  if(iPOCLast == 0) //case first frame or first top field
+  {
+    rpocCurr=0;
+    riTimeOffset = 1;
+  }
+  else if(iPOCLast == 1 && isField) //case first bottom field, just like the first frame, the poc computation is not right anymore, we set the right value
+  {
+    rpocCurr = 1;
+    riTimeOffset = 1;
+  }
+  else
+  {
+    rpocCurr = iPOCLast - iNumPicRcvd + m_pcCfg->getGOPEntry(iGOPid).m_POC - ((isField && m_iGopSize>1) ? 1:0);
+    riTimeOffset = m_pcCfg->getGOPEntry(iGOPid).m_POC;
+  }
+}
+
+/** Prepare a picture of the GOP for its compression: slice initialisation, NAL unit type, reference picture set and lists,
+ * QP and lambda. An access unit is appended to the list of the GOP for it.
+ * \param rcPic  coding state of the picture, with the slice encoder to use set
+ */
+Void TEncGOP::xPreparePicture( PicState& rcPic, Int iGOPid, Int pocCurr, Int iTimeOffset, Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic,
+                               TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsInGOP, Bool isField )
+{
+  TEncSlice* pcSliceEncoder = rcPic.pcSliceEncoder;
+
+  //-- For time output for each slice
+  rcPic.iBeforeTime = clock();
+
+  UInt uiColDir = calculateCollocatedFromL1Flag(m_pcCfg, iGOPid, m_iGopSize);
+
+  if( getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_W_RADL || getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_N_LP )
+  {
+    m_iLastIDR = pocCurr;
+  }
+  // start a new access unit: create an entry in the list of output access units
+  accessUnitsInGOP.push_back(AccessUnit());
+  rcPic.pcAccessUnit = &accessUnitsInGOP.back();
+  xGetBuffer( rcListPic, rcListPicYuvRecOut, iNumPicRcvd, iTimeOffset, rcPic.pcPic, rcPic.pcPicYuvRecOut, pocCurr, isField );
+  TComPic* pcPic = rcPic.pcPic;
+
+  //  Slice data initialization
+  pcPic->clearSliceBuffer();
+  pcPic->allocateNewSlice();
+  pcSliceEncoder->setSliceIdx(0);
+  pcPic->setCurrSliceIdx(0);
+
+  TComSlice* pcSlice;
+  pcSliceEncoder->initEncSlice ( pcPic, iPOCLast, pocCurr, iGOPid, pcSlice, isField );
+
+  //Set Frame/Field coding
+  pcSlice->getPic()->setField(isField);
+
+  pcSlice->setLastIDR(m_iLastIDR);
+  pcSlice->setSliceIdx(0);
+  //set default slice level flag to the same as SPS level flag
+  pcSlice->setLFCrossSliceBoundaryFlag(  pcSlice->getPPS()->getLoopFilterAcrossSlicesEnabledFlag()  );
+
+  if(pcSlice->getSliceType()==B_SLICE&&m_pcCfg->getGOPEntry(iGOPid).m_sliceType=='P')
+  {
+    pcSlice->setSliceType(P_SLICE);
+  }
+  if(pcSlice->getSliceType()==B_SLICE&&m_pcCfg->getGOPEntry(iGOPid).m_sliceType=='I')
+  {
+    pcSlice->setSliceType(I_SLICE);
+  }
+  
+  // Set the nal unit type
+  pcSlice->setNalUnitType(getNalUnitType(pocCurr, m_iLastIDR, isField));
+  if(pcSlice->getTemporalLayerNonReferenceFlag())
+  {
+    if (pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_TRAIL_R &&
+        !(m_iGopSize == 1 && pcSlice->getSliceType() == I_SLICE))
+      // Add this condition to avoid POC issues with encoder_intra_main.cfg configuration (see #1127 in bug tracker)
+    {
+      pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TRAIL_N);
+    }
+    if(pcSlice->getNalUnitType()==NAL_UNIT_CODED_SLICE_RADL_R)
+    {
+      pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_RADL_N);
+    }
+    if(pcSlice->getNalUnitType()==NAL_UNIT_CODED_SLICE_RASL_R)
+    {
+      pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_RASL_N);
+    }
+  }
+
+  if (m_pcCfg->getEfficientFieldIRAPEnabled())
+  {
+    if ( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_RADL
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_N_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_W_RADL
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_N_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA )  // IRAP picture
+    {
+      m_associatedIRAPType = pcSlice->getNalUnitType();
+      m_associatedIRAPPOC = pocCurr;
+    }
+    pcSlice->setAssociatedIRAPType(m_associatedIRAPType);
+    pcSlice->setAssociatedIRAPPOC(m_associatedIRAPPOC);
+  }
+  // Do decoding refresh marking if any
+  pcSlice->decodingRefreshMarking(m_pocCRA, m_bRefreshPending, rcListPic, m_pcCfg->getEfficientFieldIRAPEnabled());
+  m_pcEncTop->selectReferencePictureSet(pcSlice, pocCurr, iGOPid);
+  if (!m_pcCfg->getEfficientFieldIRAPEnabled())
+  {
+    if ( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_W_RADL
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_BLA_N_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_W_RADL
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_IDR_N_LP
+      || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA )  // IRAP picture
+    {
+      m_associatedIRAPType = pcSlice->getNalUnitType();
+      m_associatedIRAPPOC = pocCurr;
+    }
+    pcSlice->setAssociatedIRAPType(m_associatedIRAPType);
+    pcSlice->setAssociatedIRAPPOC(m_associatedIRAPPOC);
+  }
+
+  if ((pcSlice->checkThatAllRefPicsAreAvailable(rcListPic, pcSlice->getRPS(), false, m_iLastRecoveryPicPOC, m_pcCfg->getDecodingRefreshType() == 3) != 0) || (pcSlice->isIRAP()) 
+    || (m_pcCfg->getEfficientFieldIRAPEnabled() && isField && pcSlice->getAssociatedIRAPType() >= NAL_UNIT_CODED_SLICE_BLA_W_LP && pcSlice->getAssociatedIRAPType() <= NAL_UNIT_CODED_SLICE_CRA && pcSlice->getAssociatedIRAPPOC() == pcSlice->getPOC()+1)
+    )
+  {
+    pcSlice->createExplicitReferencePictureSetFromReference(rcListPic, pcSlice->getRPS(), pcSlice->isIRAP(), m_iLastRecoveryPicPOC, m_pcCfg->getDecodingRefreshType() == 3, m_pcCfg->getEfficientFieldIRAPEnabled());
+  }
+
+  pcSlice->applyReferencePictureSet(rcListPic, pcSlice->getRPS());
+
+  if(pcSlice->getTLayer() > 0 
+    &&  !( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_N     // Check if not a leading picture
+        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_R
+        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RASL_N
+        || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RASL_R )
+      )
+  {
+    if(pcSlice->isTemporalLayerSwitchingPoint(rcListPic) || pcSlice->getSPS()->getTemporalIdNestingFlag())
+    {
+      if(pcSlice->getTemporalLayerNonReferenceFlag())
+      {
+        pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TSA_N);
+      }
+      else
+      {
+        pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_TSA_R);
+      }
+    }
+    else if(pcSlice->isStepwiseTemporalLayerSwitchingPointCandidate(rcListPic))
+    {
+      Bool isSTSA=true;
+      for(Int ii=iGOPid+1;(ii<m_pcCfg->getGOPSize() && isSTSA==true);ii++)
+      {
+        Int lTid= m_pcCfg->getGOPEntry(ii).m_temporalId;
+        if(lTid==pcSlice->getTLayer())
+        {
+          const TComReferencePictureSet* nRPS = pcSlice->getSPS()->getRPSList()->getReferencePictureSet(ii);
+          for(Int jj=0;jj<nRPS->getNumberOfPictures();jj++)
+          {
+            if(nRPS->getUsed(jj))
+            {
+              Int tPoc=m_pcCfg->getGOPEntry(ii).m_POC+nRPS->getDeltaPOC(jj);
+              Int kk=0;
+              for(kk=0;kk<m_pcCfg->getGOPSize();kk++)
+              {
+                if(m_pcCfg->getGOPEntry(kk).m_POC==tPoc)
+                {
+                  break;
+                }
+              }
+              Int tTid=m_pcCfg->getGOPEntry(kk).m_temporalId;
+              if(tTid >= pcSlice->getTLayer())
+              {
+                isSTSA=false;
+                break;
+              }
+            }
+          }
+        }
+      }
+      if(isSTSA==true)
+      {
+        if(pcSlice->getTemporalLayerNonReferenceFlag())
+        {
+          pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_STSA_N);
+        }
+        else
+        {
+          pcSlice->setNalUnitType(NAL_UNIT_CODED_SLICE_STSA_R);
+        }
+      }
+    }
+  }
+  arrangeLongtermPicturesInRPS(pcSlice, rcListPic);
+  TComRefPicListModification* refPicListModification = pcSlice->getRefPicListModification();
+  refPicListModification->setRefPicListModificationFlagL0(0);
+  refPicListModification->setRefPicListModificationFlagL1(0);
+  pcSlice->setNumRefIdx(REF_PIC_LIST_0,min(m_pcCfg->getGOPEntry(iGOPid).m_numRefPicsActive,pcSlice->getRPS()->getNumberOfPictures()));
+  pcSlice->setNumRefIdx(REF_PIC_LIST_1,min(m_pcCfg->getGOPEntry(iGOPid).m_numRefPicsActive,pcSlice->getRPS()->getNumberOfPictures()));
+
+  //  Set reference list
+  pcSlice->setRefPicList ( rcListPic );
+
+  //  Slice info. refinement
+  if ( (pcSlice->getSliceType() == B_SLICE) && (pcSlice->getNumRefIdx(REF_PIC_LIST_1) == 0) )
+  {
+    pcSlice->setSliceType ( P_SLICE );
+  }
+  pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
+
+  if (pcSlice->getSliceType() == B_SLICE)
+  {
+    pcSlice->setColFromL0Flag(1-uiColDir);
+    Bool bLowDelay = true;
+    Int  iCurrPOC  = pcSlice->getPOC();
+    Int iRefIdx = 0;
+
+    for (iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx(REF_PIC_LIST_0) && bLowDelay; iRefIdx++)
+    {
+      if ( pcSlice->getRefPic(REF_PIC_LIST_0, iRefIdx)->getPOC() > iCurrPOC )
+      {
+        bLowDelay = false;
+      }
+    }
+    for (iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx(REF_PIC_LIST_1) && bLowDelay; iRefIdx++)
+    {
+      if ( pcSlice->getRefPic(REF_PIC_LIST_1, iRefIdx)->getPOC() > iCurrPOC )
+      {
+        bLowDelay = false;
+      }
+    }
+
+    pcSlice->setCheckLDC(bLowDelay);
+  }
+  else
+  {
+    pcSlice->setCheckLDC(true);
+  }
+
+  uiColDir = 1-uiColDir;
+
+  //-------------------------------------------------------------
+  pcSlice->setRefPOCList();
+
+  pcSlice->setList1IdxToList0Idx();
+
+  if (m_pcEncTop->getTMVPModeId() == 2)
+  {
+    if (iGOPid == 0) // first picture in SOP (i.e. forward B)
+    {
+      pcSlice->setEnableTMVPFlag(0);
+    }
+    else
+    {
+      // Note: pcSlice->getColFromL0Flag() is assumed to be always 0 and getcolRefIdx() is always 0.
+      pcSlice->setEnableTMVPFlag(1);
+    }
+  }
+  else if (m_pcEncTop->getTMVPModeId() == 1)
+  {
+    pcSlice->setEnableTMVPFlag(1);
+  }
+  else
+  {
+    pcSlice->setEnableTMVPFlag(0);
+  }
+  
+  // set adaptive search range for non-intra-slices
+  if (m_pcCfg->getUseASR() && pcSlice->getSliceType()!=I_SLICE)
+  {
+    pcSliceEncoder->setSearchRange(pcSlice);
+  }
+
+  Bool bGPBcheck=false;
+  if ( pcSlice->getSliceType() == B_SLICE)
+  {
+    if ( pcSlice->getNumRefIdx(RefPicList( 0 ) ) == pcSlice->getNumRefIdx(RefPicList( 1 ) ) )
+    {
+      bGPBcheck=true;
+      Int i;
+      for ( i=0; i < pcSlice->getNumRefIdx(RefPicList( 1 ) ); i++ )
+      {
+        if ( pcSlice->getRefPOC(RefPicList(1), i) != pcSlice->getRefPOC(RefPicList(0), i) )
+        {
+          bGPBcheck=false;
+          break;
+        }
+      }
+    }
+  }
+  if(bGPBcheck)
+  {
+    pcSlice->setMvdL1ZeroFlag(true);
+  }
+  else
+  {
+    pcSlice->setMvdL1ZeroFlag(false);
+  }
+  pcPic->getSlice(pcSlice->getSliceIdx())->setMvdL1ZeroFlag(pcSlice->getMvdL1ZeroFlag());
+
+
+  Double lambda            = 0.0;
+  Int estimatedBits        = 0;
+  if ( m_pcCfg->getUseRateCtrl() ) // TODO: does this work with multiple slices and slice-segments?
+  {
+    Int frameLevel = m_pcRateCtrl->getRCSeq()->getGOPID2Level( iGOPid );
+    if ( pcPic->getSlice(0)->getSliceType() == I_SLICE )
+    {
+      frameLevel = 0;
+    }
+    m_pcRateCtrl->initRCPic( frameLevel );
+    estimatedBits = m_pcRateCtrl->getRCPic()->getTargetBits();
+
+#if U0132_TARGET_BITS_SATURATION
+    if (m_pcRateCtrl->getCpbSaturationEnabled() && frameLevel != 0)
+    {
+      Int estimatedCpbFullness = m_pcRateCtrl->getCpbState() + m_pcRateCtrl->getBufferingRate();
+
+      // prevent overflow
+      if (estimatedCpbFullness - estimatedBits > (Int)(m_pcRateCtrl->getCpbSize()*0.9f))
+      {
+        estimatedBits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.9f);
+      }
+
+      estimatedCpbFullness -= m_pcRateCtrl->getBufferingRate();
+      // prevent underflow
+#if V0078_ADAPTIVE_LOWER_BOUND
+      if (estimatedCpbFullness - estimatedBits < m_pcRateCtrl->getRCPic()->getLowerBound())
+      {
+        estimatedBits = max(200, estimatedCpbFullness - m_pcRateCtrl->getRCPic()->getLowerBound());
+      }
+#else
+      if (estimatedCpbFullness - estimatedBits < (Int)(m_pcRateCtrl->getCpbSize()*0.1f))
+      {
+        estimatedBits = max(200, estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.1f));
+      }
+#endif
+
+      m_pcRateCtrl->getRCPic()->setTargetBits(estimatedBits);
+    }
+#endif
+
+    Int sliceQP = m_pcCfg->getInitialQP();
+    if ( ( pcSlice->getPOC() == 0 && m_pcCfg->getInitialQP() > 0 ) || ( frameLevel == 0 && m_pcCfg->getForceIntraQP() ) ) // QP is specified
+    {
+      Int    NumberBFrames = ( m_pcCfg->getGOPSize() - 1 );
+      Double dLambda_scale = 1.0 - Clip3( 0.0, 0.5, 0.05*(Double)NumberBFrames );
+      Double dQPFactor     = 0.57*dLambda_scale;
+      Int    SHIFT_QP      = 12;
+      Int    bitdepth_luma_qp_scale = 0;
+      Double qp_temp = (Double) sliceQP + bitdepth_luma_qp_scale - SHIFT_QP;
+      lambda = dQPFactor*pow( 2.0, qp_temp/3.0 );
+    }
+    else if ( frameLevel == 0 )   // intra case, but use the model
+    {
+      pcSliceEncoder->calCostSliceI(pcPic); // TODO: This only analyses the first slice segment - what about the others?
+
+      if ( m_pcCfg->getIntraPeriod() != 1 )   // do not refine allocated bits for all intra case
+      {
+        Int bits = m_pcRateCtrl->getRCSeq()->getLeftAverageBits();
+        bits = m_pcRateCtrl->getRCPic()->getRefineBitsForIntra( bits );
+
+#if U0132_TARGET_BITS_SATURATION
+        if (m_pcRateCtrl->getCpbSaturationEnabled() )
+        {
+          Int estimatedCpbFullness = m_pcRateCtrl->getCpbState() + m_pcRateCtrl->getBufferingRate();
+
+          // prevent overflow
+          if (estimatedCpbFullness - bits > (Int)(m_pcRateCtrl->getCpbSize()*0.9f))
+          {
+            bits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.9f);
+          }
+
+          estimatedCpbFullness -= m_pcRateCtrl->getBufferingRate();
+          // prevent underflow
+#if V0078_ADAPTIVE_LOWER_BOUND
+          if (estimatedCpbFullness - bits < m_pcRateCtrl->getRCPic()->getLowerBound())
+          {
+            bits = estimatedCpbFullness - m_pcRateCtrl->getRCPic()->getLowerBound();
+          }
+#else
+          if (estimatedCpbFullness - bits < (Int)(m_pcRateCtrl->getCpbSize()*0.1f))
+          {
+            bits = estimatedCpbFullness - (Int)(m_pcRateCtrl->getCpbSize()*0.1f);
+          }
+#endif
+        }
+#endif
+
+        if ( bits < 200 )
+        {
+          bits = 200;
+        }
+        m_pcRateCtrl->getRCPic()->setTargetBits( bits );
+      }
+
+      list<TEncRCPic*> listPreviousPicture = m_pcRateCtrl->getPicList();
+      m_pcRateCtrl->getRCPic()->getLCUInitTargetBits();
+      lambda  = m_pcRateCtrl->getRCPic()->estimatePicLambda( listPreviousPicture, pcSlice->getSliceType());
+      sliceQP = m_pcRateCtrl->getRCPic()->estimatePicQP( lambda, listPreviousPicture );
+    }
+    else    // normal case
+    {
+      list<TEncRCPic*> listPreviousPicture = m_pcRateCtrl->getPicList();
+      lambda  = m_pcRateCtrl->getRCPic()->estimatePicLambda( listPreviousPicture, pcSlice->getSliceType());
+      sliceQP = m_pcRateCtrl->getRCPic()->estimatePicQP( lambda, listPreviousPicture );
+    }
+
+    sliceQP = Clip3( -pcSlice->getSPS()->getQpBDOffset(CHANNEL_TYPE_LUMA), MAX_QP, sliceQP );
+    m_pcRateCtrl->getRCPic()->setPicEstQP( sliceQP );
+
+    pcSliceEncoder->resetQP( pcPic, sliceQP, lambda );
+  }
+
+  rcPic.dLambda        = lambda;
+  rcPic.iEstimatedBits = estimatedBits;
+}
+
+/** Compress (trial encode) the slice segments of a prepared picture with its slice encoder
+ * \param rcPic  coding state of the picture
+ */
+Void TEncGOP::xCompressPicture( PicState& rcPic )
+{
+  TComPic*   pcPic          = rcPic.pcPic;
+  TEncSlice* pcSliceEncoder = rcPic.pcSliceEncoder;
+  TComSlice* pcSlice        = pcPic->getSlice(0);
+
+  UInt uiNumSliceSegments = 1;
+
+  // now compress (trial encode) the various slice segments (slices, and dependent slices)
+  const UInt numberOfCtusInFrame=pcPic->getPicSym()->getNumberOfCtusInFrame();
+  pcSlice->setSliceCurStartCtuTsAddr( 0 );
+  pcSlice->setSliceSegmentCurStartCtuTsAddr( 0 );
+
+  for(UInt nextCtuTsAddr = 0; nextCtuTsAddr < numberOfCtusInFrame; )
+  {
+    pcSliceEncoder->precompressSlice( pcPic );
+    pcSliceEncoder->compressSlice   ( pcPic, false, false );
+
+    const UInt curSliceSegmentEnd = pcSlice->getSliceSegmentCurEndCtuTsAddr();
+    if (curSliceSegmentEnd < numberOfCtusInFrame)
+    {
+      const Bool bNextSegmentIsDependentSlice=curSliceSegmentEnd<pcSlice->getSliceCurEndCtuTsAddr();
+      const UInt sliceBits=pcSlice->getSliceBits();
+      pcPic->allocateNewSlice();
+      // prepare for next slice
+      pcPic->setCurrSliceIdx                    ( uiNumSliceSegments );
+      pcSliceEncoder->setSliceIdx               ( uiNumSliceSegments   );
+      pcSlice = pcPic->getSlice                 ( uiNumSliceSegments   );
+      assert(pcSlice->getPPS()!=0);
+      pcSlice->copySliceInfo                    ( pcPic->getSlice(uiNumSliceSegments-1)  );
+      pcSlice->setSliceIdx                      ( uiNumSliceSegments   );
+      if (bNextSegmentIsDependentSlice)
+      {
+        pcSlice->setSliceBits(sliceBits);
+      }
+      else
+      {
+        pcSlice->setSliceCurStartCtuTsAddr      ( curSliceSegmentEnd );
+        pcSlice->setSliceBits(0);
+      }
+      pcSlice->setDependentSliceSegmentFlag(bNextSegmentIsDependentSlice);
+      pcSlice->setSliceSegmentCurStartCtuTsAddr ( curSliceSegmentEnd );
+      // TODO: optimise cabac_init during compress slice to improve multi-slice operation
+      // pcSlice->setEncCABACTableIdx(pcSliceEncoder->getEncCABACTableIdx());
+      uiNumSliceSegments ++;
+    }
+    nextCtuTsAddr = curSliceSegmentEnd;
+  }
+
+
+  rcPic.uiNumSliceSegments = uiNumSliceSegments;
+}
+
+/** Check whether the frame-parallel compression is used for the pictures of the GOP
+ * It is not used with rate control or adaptive QP selection, whose state is carried from picture to picture, nor for field coding.
+ */
+Bool TEncGOP::xUseFrameParallel( Bool isField ) const
+{
+  if ( m_apcPicEncoders.empty() || isField || m_pcCfg->getUseRateCtrl() )
+  {
+    return false;
+  }
+#if ADAPTIVE_QP_SELECTION
+  if ( m_pcCfg->getUseAdaptQpSelect() )
+  {
+    return false;
+  }
+#endif
+  return true;
+}
+
+/** Check whether a picture of the GOP may reference one of the given pictures, according to its reference picture set
+ * \param iGOPid   index of the picture in the GOP
+ * \param pocCurr  POC of the picture
+ * \param raiPOCs  POCs of the pictures
+ */
+Bool TEncGOP::xReferencesPictures( Int iGOPid, Int pocCurr, const std::vector<Int>& raiPOCs )
+{
+  const GOPEntry& rcRPS = m_pcCfg->getGOPEntry( m_pcEncTop->getReferencePictureSetIdxForSOP( pocCurr, iGOPid ) );
+  for ( Int i = 0; i < rcRPS.m_numRefPics; i++ )
+  {
+    if ( rcRPS.m_usedByCurrPic[i] && std::find( raiPOCs.begin(), raiPOCs.end(), pocCurr + rcRPS.m_referencePics[i] ) != raiPOCs.end() )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Compress a picture of the GOP together with the following pictures in coding order that do not reference any picture of the batch
+ * The pictures are prepared in coding order and then compressed in parallel, each by its own picture encoder. Their references are
+ * pictures written before, so they are fully reconstructed and filtered; loop filtering and writing of the batch happen afterwards
+ * in compressGOP, in coding order.
+ * \param racPics  coding states of the pictures of the GOP
+ * \param iGOPid   index of the first picture of the batch in the GOP
+ */
+Void TEncGOP::xCompressPicturesInParallel( std::vector<PicState>& racPics, Int iGOPid, Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic,
+                                           TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsInGOP )
+{
+  std::vector<Int> aiBatchGOPid;
+  std::vector<Int> aiBatchPOC;
+  for ( Int iGOPidNext = iGOPid; iGOPidNext < m_iGopSize && aiBatchGOPid.size() < m_apcPicEncoders.size(); iGOPidNext++ )
+  {
+    Int pocCurr;
+    Int iTimeOffset;
+    xGetPOC( iGOPidNext, iPOCLast, iNumPicRcvd, false, pocCurr, iTimeOffset );
+    if ( pocCurr >= m_pcCfg->getFramesToBeEncoded() )
+    {
+      continue;
+    }
+    if ( xReferencesPictures( iGOPidNext, pocCurr, aiBatchPOC ) )
+    {
+      break;
+    }
+
+    PicState& rcPic = racPics[iGOPidNext];
+    rcPic.pcSliceEncoder = &m_apcPicEncoders[aiBatchGOPid.size()]->m_cSliceEncoder;
+    xPreparePicture( rcPic, iGOPidNext, pocCurr, iTimeOffset, iPOCLast, iNumPicRcvd, rcListPic, rcListPicYuvRecOut, accessUnitsInGOP, false );
+
+    const TComSlice* pcSlice = rcPic.pcPic->getSlice(0);
+    for ( UInt uiRefList = 0; uiRefList < NUM_REF_PIC_LIST_01; uiRefList++ )
+    {
+      for ( Int iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx( RefPicList(uiRefList) ); iRefIdx++ )
+      {
+        assert( std::find( aiBatchPOC.begin(), aiBatchPOC.end(), pcSlice->getRefPOC( RefPicList(uiRefList), iRefIdx ) ) == aiBatchPOC.end() );
+      }
+    }
+    aiBatchGOPid.push_back( iGOPidNext );
+    aiBatchPOC.push_back( pocCurr );
+  }
+
+  if ( !m_bPicEncoderScalingListSet )
+  {
+    for ( UInt i = 0; i < m_apcPicEncoders.size(); i++ )
+    {
+      m_apcPicEncoders[i]->m_cModules.initScalingList( m_pcCfg, racPics[iGOPid].pcPic->getSlice(0)->getSPS() );
+    }
+    m_bPicEncoderScalingListSet = true;
+  }
+
+  m_pcEncTop->getThreadPool()->parallelFor( Int(aiBatchGOPid.size()), [&]( Int i )
+  {
+    // the coding-order dependent state of the search starts afresh in every picture, whichever thread compresses it
+    m_apcPicEncoders[i]->m_cModules.m_cSearch.resetNNState();
+    xCompressPicture( racPics[aiBatchGOPid[i]] );
+  } );
+}
+
 UInt64 TEncGOP::xFindDistortionFrame (TComPicYuv* pcPic0, TComPicYuv* pcPic1, const BitDepths &bitDepths)
 {
   UInt64  uiTotalDiff = 0;
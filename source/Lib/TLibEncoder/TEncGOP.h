@@ -41,6 +41,7 @@
 #include <list>
 
 #include <stdlib.h>
+#include <time.h>
 
 #include "TLibCommon/TComList.h"
 #include "TLibCommon/TComPic.h"
@@ -68,6 +69,14 @@ class TEncTop;
 // Class definition
 // ====================================================================================================================
 
+/// picture encoder of the frame-parallel compression: slice encoder with a private set of CTU encoding modules
+class TEncPicEncoder
+{
+public:
+  TEncWorkerContext          m_cModules;
+  TEncSlice               m_cSliceEncoder;
+};
+
 class TEncGOP
 {
   class DUData
@@ -81,6 +90,30 @@ class TEncGOP
     Int accumNalsDU;
   };
 
+  /// coding state of a picture of the GOP, from its preparation until it is written
+  class PicState
+  {
+  public:
+    PicState()
+    :pcPic(NULL)
+    ,pcPicYuvRecOut(NULL)
+    ,pcAccessUnit(NULL)
+    ,pcSliceEncoder(NULL)
+    ,iBeforeTime(0)
+    ,dLambda(0.0)
+    ,iEstimatedBits(0)
+    ,uiNumSliceSegments(1) {};
+
+    TComPic*      pcPic;
+    TComPicYuv*   pcPicYuvRecOut;
+    AccessUnit*   pcAccessUnit;
+    TEncSlice*    pcSliceEncoder;        ///< slice encoder compressing the picture
+    clock_t       iBeforeTime;
+    Double        dLambda;               ///< picture lambda of the rate control
+    Int           iEstimatedBits;        ///< target bits of the rate control
+    UInt          uiNumSliceSegments;
+  };
+
 private:
 
   TEncAnalyze             m_gcAnalyzeAll;
@@ -118,6 +151,11 @@ private:
   //--Adaptive Loop filter
   TEncSampleAdaptiveOffset*  m_pcSAO;
   TEncRateCtrl*           m_pcRateCtrl;
+
+  // frame-parallel compression of the pictures of a GOP that do not reference each other
+  std::vector<TEncPicEncoder*>  m_apcPicEncoders;
+  Bool                          m_bPicEncoderScalingListSet;
+
   // indicate sequence first
   Bool                    m_bSeqFirst;
 
@@ -168,6 +206,15 @@ protected:
 
   Void  xInitGOP          ( Int iPOCLast, Int iNumPicRcvd, Bool isField );
   Void  xGetBuffer        ( TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut, Int iNumPicRcvd, Int iTimeOffset, TComPic*& rpcPic, TComPicYuv*& rpcPicYuvRecOut, Int pocCurr, Bool isField );
+  Void  xGetPOC           ( Int iGOPid, Int iPOCLast, Int iNumPicRcvd, Bool isField, Int& rpocCurr, Int& riTimeOffset );
+
+  Void  xPreparePicture   ( PicState& rcPic, Int iGOPid, Int pocCurr, Int iTimeOffset, Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic,
+                            TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsInGOP, Bool isField );
+  Void  xCompressPicture  ( PicState& rcPic );
+  Bool  xUseFrameParallel ( Bool isField ) const;
+  Bool  xReferencesPictures( Int iGOPid, Int pocCurr, const std::vector<Int>& raiPOCs );
+  Void  xCompressPicturesInParallel( std::vector<PicState>& racPics, Int iGOPid, Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic,
+                                     TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsInGOP );
 
   Void  xCalculateAddPSNRs         ( const Bool isField, const Bool isFieldTopFieldFirst, const Int iGOPid, TComPic* pcPic, const AccessUnit&accessUnit, TComList<TComPic*> &rcListPic, Double dEncTime, const InputColourSpaceConversion snr_conversion, const Bool printFrameMSE );
   Void  xCalculateAddPSNR          ( TComPic* pcPic, TComPicYuv* pcPicD, const AccessUnit&, Double dEncTime, const InputColourSpaceConversion snr_conversion, const Bool printFrameMSE );
@@ -105,6 +105,15 @@ Void TEncPicQPAdaptationLayer::destroy()
 TEncPic::TEncPic()
 : m_acAQLayer(NULL)
 , m_uiMaxAQDepth(0)
+, m_acCoarseMv(NULL)
+, m_uiCoarseMvBlkSize(0)
+, m_uiNumCoarseMvBlkInWidth(0)
+, m_uiNumCoarseMvBlkInHeight(0)
+, m_iCoarseMvRefPOC(0)
+, m_bCoarseMvValid(false)
+, m_iRecIntegralStride(0)
+, m_iRecIntegralOrigin(0)
+, m_iRecIntegralPOC(MAX_INT)
 {
 }
 
@@ -139,14 +148,112 @@ Void TEncPic::create( const TComSPS &sps, const TComPPS &pps, UInt uiMaxAdaptive
   }
 }
 
+/** Allocate the motion field of the hierarchical motion pre-analysis
+ * \param uiBlkSize Size of the luma blocks carrying one motion vector
+ */
+Void TEncPic::createCoarseMvField( UInt uiBlkSize )
+{
+  const TComPicYuv* pcPicYuv = getPicYuvOrg();
+  m_uiCoarseMvBlkSize        = uiBlkSize;
+  m_uiNumCoarseMvBlkInWidth  = (pcPicYuv->getWidth (COMPONENT_Y) + uiBlkSize - 1) / uiBlkSize;
+  m_uiNumCoarseMvBlkInHeight = (pcPicYuv->getHeight(COMPONENT_Y) + uiBlkSize - 1) / uiBlkSize;
+  m_acCoarseMv               = new TComMv[ m_uiNumCoarseMvBlkInWidth * m_uiNumCoarseMvBlkInHeight ];
+  m_bCoarseMvValid           = false;
+}
+
+/** Get the coarse motion vector covering a luma sample position
+ * \param uiPelX Horizontal luma sample position
+ * \param uiPelY Vertical luma sample position
+ * \returns integer-pel motion vector pointing to the picture with POC getCoarseMvRefPOC()
+ */
+const TComMv& TEncPic::getCoarseMv( UInt uiPelX, UInt uiPelY ) const
+{
+  const UInt uiBlkX = std::min( uiPelX / m_uiCoarseMvBlkSize, m_uiNumCoarseMvBlkInWidth  - 1 );
+  const UInt uiBlkY = std::min( uiPelY / m_uiCoarseMvBlkSize, m_uiNumCoarseMvBlkInHeight - 1 );
+  return m_acCoarseMv[ uiBlkY * m_uiNumCoarseMvBlkInWidth + uiBlkX ];
+}
+
+/** Build the integral images of the reconstructed luma samples used by the successive elimination full search, unless they are valid already
+ * Must be called once the reconstruction is final and its borders are extended. The sums are kept modulo 2^32 (2^64 for the
+ * squares): the sum over a block is then exact as long as it fits, which holds for any block size up to the CTU size.
+ * Several picture encoders may call it for a shared reference at the same time.
+ */
+Void TEncPic::buildRecIntegralImages()
+{
+  std::lock_guard<std::mutex> cLock( m_cRecIntegralMutex );
+  if ( getRecIntegralValid() )
+  {
+    return;
+  }
+
+  const TComPicYuv* pcPicYuv = getPicYuvRec();
+  const Int  iMarginX  = pcPicYuv->getMarginX(COMPONENT_Y);
+  const Int  iMarginY  = pcPicYuv->getMarginY(COMPONENT_Y);
+  const Int  iWidth    = pcPicYuv->getWidth (COMPONENT_Y) + 2 * iMarginX;
+  const Int  iHeight   = pcPicYuv->getHeight(COMPONENT_Y) + 2 * iMarginY;
+  const Int  iStride   = pcPicYuv->getStride(COMPONENT_Y);
+  const Pel* piSrc     = pcPicYuv->getAddr(COMPONENT_Y) - iMarginY * iStride - iMarginX;
+
+  m_iRecIntegralStride = iWidth + 1;
+  m_iRecIntegralOrigin = iMarginY * m_iRecIntegralStride + iMarginX;
+  m_auiRecLumaSum  .assign( m_iRecIntegralStride * (iHeight + 1), 0 );
+  m_auiRecLumaSumSq.assign( m_iRecIntegralStride * (iHeight + 1), 0 );
+
+  for ( Int y = 0; y < iHeight; y++ )
+  {
+    const UInt*   puiAbove   = &m_auiRecLumaSum  [  y      * m_iRecIntegralStride ];
+    const UInt64* puiAboveSq = &m_auiRecLumaSumSq[  y      * m_iRecIntegralStride ];
+    UInt*         puiCur     = &m_auiRecLumaSum  [ (y + 1) * m_iRecIntegralStride ];
+    UInt64*       puiCurSq   = &m_auiRecLumaSumSq[ (y + 1) * m_iRecIntegralStride ];
+    UInt          uiRowSum   = 0;
+    UInt64        uiRowSumSq = 0;
+    for ( Int x = 0; x < iWidth; x++ )
+    {
+      uiRowSum        += UInt( piSrc[x] );
+      uiRowSumSq      += UInt64( Int(piSrc[x]) * Int(piSrc[x]) );
+      puiCur  [x + 1]  = puiAbove  [x + 1] + uiRowSum;
+      puiCurSq[x + 1]  = puiAboveSq[x + 1] + uiRowSumSq;
+    }
+    piSrc += iStride;
+  }
+  m_iRecIntegralPOC = getPOC();
+}
+
+/** Get the sum and the sum of squares of the reconstructed luma samples of a block
+ * \param iPelX    Horizontal position of the block, may point into the left border
+ * \param iPelY    Vertical position of the block, may point into the top border
+ * \param iWidth   Block width
+ * \param iHeight  Block height
+ * \param ruiSum   Sum of the samples
+ * \param ruiSumSq Sum of the squared samples
+ */
+Void TEncPic::getRecBlockSums( Int iPelX, Int iPelY, Int iWidth, Int iHeight, UInt& ruiSum, UInt64& ruiSumSq ) const
+{
+  const Int iTL = m_iRecIntegralOrigin + iPelY * m_iRecIntegralStride + iPelX;
+  const Int iTR = iTL + iWidth;
+  const Int iBL = iTL + iHeight * m_iRecIntegralStride;
+  const Int iBR = iBL + iWidth;
+  ruiSum   = m_auiRecLumaSum  [iBR] - m_auiRecLumaSum  [iTR] - m_auiRecLumaSum  [iBL] + m_auiRecLumaSum  [iTL];
+  ruiSumSq = m_auiRecLumaSumSq[iBR] - m_auiRecLumaSumSq[iTR] - m_auiRecLumaSumSq[iBL] + m_auiRecLumaSumSq[iTL];
+}
+
 //! Clean up
 Void TEncPic::destroy()
 {
+  m_auiRecLumaSum.clear();
+  m_auiRecLumaSumSq.clear();
+  m_iRecIntegralPOC = MAX_INT;
   if (m_acAQLayer)
   {
     delete[] m_acAQLayer;
     m_acAQLayer = NULL;
   }
+  if (m_acCoarseMv)
+  {
+    delete[] m_acCoarseMv;
+    m_acCoarseMv = NULL;
+  }
+  m_bCoarseMvValid = false;
   TComPic::destroy();
 }
 //! \}
@@ -40,6 +40,9 @@
 
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComPic.h"
+#include "TLibCommon/TComMv.h"
+#include <vector>
+#include <mutex>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -91,22 +94,51 @@ public:
   Void                   setAvgActivity( Double d )  { m_dAvgActivity = d; }
 };
 
-/// Picture class including local image characteristics information for QP adaptation
+/// Picture class including local image characteristics information for QP adaptation and coarse motion
 class TEncPic : public TComPic
 {
 private:
   TEncPicQPAdaptationLayer* m_acAQLayer;
   UInt                      m_uiMaxAQDepth;
 
+  TComMv*                   m_acCoarseMv;                  ///< integer-pel motion field from the hierarchical motion pre-analysis
+  UInt                      m_uiCoarseMvBlkSize;
+  UInt                      m_uiNumCoarseMvBlkInWidth;
+  UInt                      m_uiNumCoarseMvBlkInHeight;
+  Int                       m_iCoarseMvRefPOC;             ///< POC of the original picture the coarse motion field points to
+  Bool                      m_bCoarseMvValid;
+
+  std::vector<UInt>         m_auiRecLumaSum;               ///< integral image of the reconstructed luma samples, borders included
+  std::vector<UInt64>       m_auiRecLumaSumSq;             ///< integral image of the squared reconstructed luma samples
+  Int                       m_iRecIntegralStride;
+  Int                       m_iRecIntegralOrigin;          ///< offset of the top-left picture sample in the integral images
+  Int                       m_iRecIntegralPOC;             ///< POC of the picture the integral images were built for
+  std::mutex                m_cRecIntegralMutex;           ///< serialises the builds of picture encoders sharing the reference
+
 public:
   TEncPic();
   virtual ~TEncPic();
 
   Void          create( const TComSPS &sps, const TComPPS &pps, UInt uiMaxAdaptiveQPDepth, Bool bIsVirtual /* = false*/ );
+  Void          createCoarseMvField( UInt uiBlkSize );
   virtual Void  destroy();
 
   TEncPicQPAdaptationLayer* getAQLayer( UInt uiDepth )  { return &m_acAQLayer[uiDepth]; }
   UInt                      getMaxAQDepth()             { return m_uiMaxAQDepth;        }
+
+  TComMv*                   getCoarseMvField()               { return m_acCoarseMv;               }
+  UInt                      getCoarseMvBlkSize()       const { return m_uiCoarseMvBlkSize;        }
+  UInt                      getNumCoarseMvBlkInWidth() const { return m_uiNumCoarseMvBlkInWidth;  }
+  UInt                      getNumCoarseMvBlkInHeight()const { return m_uiNumCoarseMvBlkInHeight; }
+  Int                       getCoarseMvRefPOC()        const { return m_iCoarseMvRefPOC;          }
+  Bool                      getCoarseMvValid()         const { return m_bCoarseMvValid;           }
+  Void                      setCoarseMvRefPOC( Int i )       { m_iCoarseMvRefPOC = i;             }
+  Void                      setCoarseMvValid( Bool b )       { m_bCoarseMvValid = b;              }
+  const TComMv&             getCoarseMv( UInt uiPelX, UInt uiPelY ) const;
+
+  Void                      buildRecIntegralImages();
+  Bool                      getRecIntegralValid()      const { return !m_auiRecLumaSum.empty() && m_iRecIntegralPOC == getPOC(); }
+  Void                      getRecBlockSums( Int iPelX, Int iPelY, Int iWidth, Int iHeight, UInt& ruiSum, UInt64& ruiSumSq ) const;
 };
 
 //! \}
@@ -48,7 +48,14 @@ using namespace std;
 /** Constructor
  */
 TEncPreanalyzer::TEncPreanalyzer()
+: m_iPrevPOC(0)
+, m_bPrevValid(false)
 {
+  for ( Int i = 0; i <= NUM_PYRAMID_LEVELS; i++ )
+  {
+    m_aiPyramidWidth[i]  = 0;
+    m_aiPyramidHeight[i] = 0;
+  }
 }
 
 /** Destructor
@@ -149,5 +156,169 @@ Void TEncPreanalyzer::xPreanalyze( TEncPic* pcEPic )
     pcAQLayer->setAvgActivity( dAvgAct );
   }
 }
+
+/** Hierarchical motion pre-analysis against the previous input picture
+ *
+ * Builds 1/2 and 1/4 downscaled luma pyramids of the input picture, runs a full block search on the 1/4 level
+ * against the pyramid of the previous input picture, refines the result on the 1/2 level and stores the
+ * resulting integer-pel motion field in the picture. The field is used to seed the integer motion search.
+ * \param pcEPic Picture object to be analyzed
+ * \param iSearchRange Motion search range at full resolution
+ * \return Void
+ */
+Void TEncPreanalyzer::xPreanalyzeMotion( TEncPic* pcEPic, Int iSearchRange )
+{
+  const TComPicYuv* pcPicYuv = pcEPic->getPicYuvOrg();
+  const Int         iPOC     = pcEPic->getPOC();
+
+  if ( m_aiPyramidWidth[0] != pcPicYuv->getWidth(COMPONENT_Y) || m_aiPyramidHeight[0] != pcPicYuv->getHeight(COMPONENT_Y) )
+  {
+    m_bPrevValid = false;
+  }
+  for ( Int i = 0; i <= NUM_PYRAMID_LEVELS; i++ )
+  {
+    m_acPyramid[0][i].swap( m_acPyramid[1][i] );
+  }
+  xBuildPyramid( pcPicYuv );
+
+  pcEPic->setCoarseMvValid( m_bPrevValid );
+  pcEPic->setCoarseMvRefPOC( m_iPrevPOC );
+
+  if ( m_bPrevValid )
+  {
+    const Int iTopLevel      = NUM_PYRAMID_LEVELS;
+    const Int iTopBlkSize    = (COARSE_MV_BLOCK_SIZE << 1) >> iTopLevel;
+    const Int iRefineLevel   = iTopLevel - 1;
+    const Int iRefineBlkSize = COARSE_MV_BLOCK_SIZE >> iRefineLevel;
+    const Int iTopRange      = max( 1, iSearchRange >> iTopLevel );
+    TComMv*   pcCoarseMv     = pcEPic->getCoarseMvField();
+
+    const UInt uiNumBlkInWidth  = pcEPic->getNumCoarseMvBlkInWidth();
+    const UInt uiNumBlkInHeight = pcEPic->getNumCoarseMvBlkInHeight();
+
+    // one block on the top level covers 2x2 blocks of the motion field
+    for ( UInt uiTopY = 0; uiTopY < uiNumBlkInHeight; uiTopY += 2 )
+    {
+      for ( UInt uiTopX = 0; uiTopX < uiNumBlkInWidth; uiTopX += 2 )
+      {
+        TComMv cTopMv;
+        xCoarseBlockSearch( iTopLevel, (uiTopX>>1) * iTopBlkSize, (uiTopY>>1) * iTopBlkSize, iTopBlkSize, 0, 0, iTopRange, cTopMv );
+
+        for ( UInt uiBlkY = uiTopY; uiBlkY < min( uiTopY + 2, uiNumBlkInHeight ); uiBlkY++ )
+        {
+          for ( UInt uiBlkX = uiTopX; uiBlkX < min( uiTopX + 2, uiNumBlkInWidth ); uiBlkX++ )
+          {
+            TComMv cMv;
+            xCoarseBlockSearch( iRefineLevel, uiBlkX * iRefineBlkSize, uiBlkY * iRefineBlkSize, iRefineBlkSize, cTopMv.getHor() << 1, cTopMv.getVer() << 1, COARSE_MV_REFINE_RANGE, cMv );
+            cMv <<= iRefineLevel;
+            pcCoarseMv[uiBlkY * uiNumBlkInWidth + uiBlkX] = cMv;
+          }
+        }
+      }
+    }
+  }
+
+  m_iPrevPOC   = iPOC;
+  m_bPrevValid = true;
+}
+
+/** Build the downscaled luma pyramid of the current picture by 2x2 averaging
+ * \param pcPicYuv Original picture
+ * \return Void
+ */
+Void TEncPreanalyzer::xBuildPyramid( const TComPicYuv* pcPicYuv )
+{
+  m_aiPyramidWidth [0] = pcPicYuv->getWidth (COMPONENT_Y);
+  m_aiPyramidHeight[0] = pcPicYuv->getHeight(COMPONENT_Y);
+
+  for ( Int iLevel = 1; iLevel <= NUM_PYRAMID_LEVELS; iLevel++ )
+  {
+    const Int  iWidth    = m_aiPyramidWidth [iLevel-1] >> 1;
+    const Int  iHeight   = m_aiPyramidHeight[iLevel-1] >> 1;
+    const Pel* pSrc      = (iLevel == 1) ? pcPicYuv->getAddr(COMPONENT_Y) : &m_acPyramid[0][iLevel-1][0];
+    const Int  iSrcStride= (iLevel == 1) ? pcPicYuv->getStride(COMPONENT_Y) : m_aiPyramidWidth[iLevel-1];
+
+    m_aiPyramidWidth [iLevel] = iWidth;
+    m_aiPyramidHeight[iLevel] = iHeight;
+    m_acPyramid[0][iLevel].resize( iWidth * iHeight );
+    Pel* pDst = &m_acPyramid[0][iLevel][0];
+
+    for ( Int y = 0; y < iHeight; y++ )
+    {
+      const Pel* pSrc0 = pSrc + (2*y) * iSrcStride;
+      const Pel* pSrc1 = pSrc0 + iSrcStride;
+      for ( Int x = 0; x < iWidth; x++ )
+      {
+        pDst[x] = ( pSrc0[2*x] + pSrc0[2*x+1] + pSrc1[2*x] + pSrc1[2*x+1] + 2 ) >> 2;
+      }
+      pDst += iWidth;
+    }
+  }
+}
+
+/** SAD between a block of the current and the displaced block of the previous pyramid level
+ * \return sum of absolute differences
+ */
+Distortion TEncPreanalyzer::xGetCoarseSAD( Int iLevel, Int iPosX, Int iPosY, Int iBlkWidth, Int iBlkHeight, Int iMvX, Int iMvY ) const
+{
+  const Int  iStride = m_aiPyramidWidth[iLevel];
+  const Pel* pCur    = &m_acPyramid[0][iLevel][0] + iPosY * iStride + iPosX;
+  const Pel* pRef    = &m_acPyramid[1][iLevel][0] + (iPosY + iMvY) * iStride + iPosX + iMvX;
+
+  Distortion uiSAD = 0;
+  for ( Int y = 0; y < iBlkHeight; y++ )
+  {
+    for ( Int x = 0; x < iBlkWidth; x++ )
+    {
+      uiSAD += abs( pCur[x] - pRef[x] );
+    }
+    pCur += iStride;
+    pRef += iStride;
+  }
+  return uiSAD;
+}
+
+/** Full block search on one pyramid level, keeping the displaced block inside the picture
+ * \param iLevel Pyramid level
+ * \param iPosX,iPosY Block position on the level
+ * \param iBlkSize Block size on the level
+ * \param iCenterX,iCenterY Search centre
+ * \param iRange Search range around the centre
+ * \param rcMv Best motion vector on the level
+ * \return Void
+ */
+Void TEncPreanalyzer::xCoarseBlockSearch( Int iLevel, Int iPosX, Int iPosY, Int iBlkSize, Int iCenterX, Int iCenterY, Int iRange, TComMv& rcMv ) const
+{
+  const Int iWidth     = m_aiPyramidWidth [iLevel];
+  const Int iHeight    = m_aiPyramidHeight[iLevel];
+  const Int iBlkWidth  = min( iBlkSize, iWidth  - iPosX );
+  const Int iBlkHeight = min( iBlkSize, iHeight - iPosY );
+
+  rcMv.setZero();
+  if ( iBlkWidth <= 0 || iBlkHeight <= 0 )
+  {
+    return;
+  }
+
+  const Int iMinX = max( iCenterX - iRange, -iPosX );
+  const Int iMaxX = min( iCenterX + iRange, iWidth  - iBlkWidth  - iPosX );
+  const Int iMinY = max( iCenterY - iRange, -iPosY );
+  const Int iMaxY = min( iCenterY + iRange, iHeight - iBlkHeight - iPosY );
+
+  // the zero vector is the initial best match, other candidates have to be strictly better
+  Distortion uiBestSAD = xGetCoarseSAD( iLevel, iPosX, iPosY, iBlkWidth, iBlkHeight, 0, 0 );
+  for ( Int iMvY = iMinY; iMvY <= iMaxY; iMvY++ )
+  {
+    for ( Int iMvX = iMinX; iMvX <= iMaxX; iMvX++ )
+    {
+      const Distortion uiSAD = xGetCoarseSAD( iLevel, iPosX, iPosY, iBlkWidth, iBlkHeight, iMvX, iMvY );
+      if ( uiSAD < uiBestSAD )
+      {
+        uiBestSAD = uiSAD;
+        rcMv.set( iMvX, iMvY );
+      }
+    }
+  }
+}
 //! \}
 
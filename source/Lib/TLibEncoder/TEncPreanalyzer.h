@@ -39,6 +39,7 @@
 #define __TENCPREANALYZER__
 
 #include "TEncPic.h"
+#include <vector>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -47,14 +48,30 @@
 // Class definition
 // ====================================================================================================================
 
+static const Int  NUM_PYRAMID_LEVELS    = 2;  ///< number of downscaled luma levels (1/2 and 1/4) used by the motion pre-analysis
+static const UInt COARSE_MV_BLOCK_SIZE  = 16; ///< luma block size of the coarse motion field at full resolution
+static const Int  COARSE_MV_REFINE_RANGE = 2; ///< search range of the refinement on the 1/2 level
+
 /// Source picture analyzer class
 class TEncPreanalyzer
 {
+private:
+  std::vector<Pel> m_acPyramid[2][NUM_PYRAMID_LEVELS+1]; ///< [current, previous][level] downscaled luma of the input pictures
+  Int              m_aiPyramidWidth [NUM_PYRAMID_LEVELS+1];
+  Int              m_aiPyramidHeight[NUM_PYRAMID_LEVELS+1];
+  Int              m_iPrevPOC;
+  Bool             m_bPrevValid;
+
+  Void       xBuildPyramid     ( const TComPicYuv* pcPicYuv );
+  Distortion xGetCoarseSAD     ( Int iLevel, Int iPosX, Int iPosY, Int iBlkWidth, Int iBlkHeight, Int iMvX, Int iMvY ) const;
+  Void       xCoarseBlockSearch( Int iLevel, Int iPosX, Int iPosY, Int iBlkSize, Int iCenterX, Int iCenterY, Int iRange, TComMv& rcMv ) const;
+
 public:
   TEncPreanalyzer();
   virtual ~TEncPreanalyzer();
 
-  Void xPreanalyze( TEncPic* pcPic );
+  Void xPreanalyze      ( TEncPic* pcPic );
+  Void xPreanalyzeMotion( TEncPic* pcPic, Int iSearchRange );
 };
 
 //! \}
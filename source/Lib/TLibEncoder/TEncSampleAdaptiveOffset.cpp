@@ -250,13 +250,9 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
   TComPicYuv* orgYuv= pPic->getPicYuvOrg();
   TComPicYuv* resYuv= pPic->getPicYuvRec();
   memcpy(m_lambda, lambdas, sizeof(m_lambda));
-  TComPicYuv* srcYuv = m_tempPicYuv;
-  resYuv->copyToPic(srcYuv);
-  srcYuv->setBorderExtension(false);
-  srcYuv->extendPicBorder();
 
   //collect statistics
-  getStatistics(m_statData, orgYuv, srcYuv, pPic);
+  getStatistics(m_statData, orgYuv, resYuv, pPic);
   if(isPreDBFSamplesUsed)
   {
     addPreDBFStatistics(m_statData);
@@ -271,7 +267,10 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
 
   //block on/off
   SAOBlkParam* reconParams = new SAOBlkParam[m_numCTUsPic]; //temporary parameter buffer for storing reconstructed SAO parameters
-  decideBlkParams(pPic, sliceEnabled, m_statData, srcYuv, resYuv, reconParams, pPic->getPicSym()->getSAOBlkParam(), bTestSAODisableAtPictureLevel, saoEncodingRate, saoEncodingRateChroma);
+  decideBlkParams(pPic, sliceEnabled, m_statData, reconParams, pPic->getPicSym()->getSAOBlkParam(), bTestSAODisableAtPictureLevel, saoEncodingRate, saoEncodingRateChroma);
+
+  //apply reconstructed offsets
+  offsetPicture(pPic, reconParams);
   delete[] reconParams;
 }
 
@@ -294,51 +293,59 @@ Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats)
   }
 }
 
+/** Collect the statistics of every CTU, one CTU row per job.
+ * The statistics of a CTU only depend on its own samples and the neighbouring ones, and every job uses its own sign
+ * line buffers, so the result does not depend on the number of jobs.
+ */
 Void TEncSampleAdaptiveOffset::getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Bool isCalculatePreDeblockSamples)
 {
-  Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
-
   const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
 
-  for(Int ctuRsAddr= 0; ctuRsAddr < m_numCTUsPic; ctuRsAddr++)
+  processCtuRows([&](Int ctuRow, Int jobIdx)
   {
-    Int yPos   = (ctuRsAddr / m_numCTUInWidth)*m_maxCUHeight;
-    Int xPos   = (ctuRsAddr % m_numCTUInWidth)*m_maxCUWidth;
-    Int height = (yPos + m_maxCUHeight > m_picHeight)?(m_picHeight- yPos):m_maxCUHeight;
-    Int width  = (xPos + m_maxCUWidth  > m_picWidth )?(m_picWidth - xPos):m_maxCUWidth;
+    Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
 
-    pPic->getPicSym()->deriveLoopFilterBoundaryAvailibility(ctuRsAddr, isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail);
+    for(Int ctuRsAddr = ctuRow*m_numCTUInWidth; ctuRsAddr < (ctuRow+1)*m_numCTUInWidth; ctuRsAddr++)
+    {
+      Int yPos   = (ctuRsAddr / m_numCTUInWidth)*m_maxCUHeight;
+      Int xPos   = (ctuRsAddr % m_numCTUInWidth)*m_maxCUWidth;
+      Int height = (yPos + m_maxCUHeight > m_picHeight)?(m_picHeight- yPos):m_maxCUHeight;
+      Int width  = (xPos + m_maxCUWidth  > m_picWidth )?(m_picWidth - xPos):m_maxCUWidth;
 
-    //NOTE: The number of skipped lines during gathering CTU statistics depends on the slice boundary availabilities.
-    //For simplicity, here only picture boundaries are considered.
+      pPic->getPicSym()->deriveLoopFilterBoundaryAvailibility(ctuRsAddr, isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail);
 
-    isRightAvail      = (xPos + m_maxCUWidth  < m_picWidth );
-    isBelowAvail      = (yPos + m_maxCUHeight < m_picHeight);
-    isBelowRightAvail = (isRightAvail && isBelowAvail);
-    isBelowLeftAvail  = ((xPos > 0) && (isBelowAvail));
-    isAboveRightAvail = ((yPos > 0) && (isRightAvail));
+      //NOTE: The number of skipped lines during gathering CTU statistics depends on the slice boundary availabilities.
+      //For simplicity, here only picture boundaries are considered.
 
-    for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
-    {
-      const ComponentID component = ComponentID(compIdx);
+      isRightAvail      = (xPos + m_maxCUWidth  < m_picWidth );
+      isBelowAvail      = (yPos + m_maxCUHeight < m_picHeight);
+      isBelowRightAvail = (isRightAvail && isBelowAvail);
+      isBelowLeftAvail  = ((xPos > 0) && (isBelowAvail));
+      isAboveRightAvail = ((yPos > 0) && (isRightAvail));
+
+      for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
+      {
+        const ComponentID component = ComponentID(compIdx);
 
-      const UInt componentScaleX = getComponentScaleX(component, pPic->getChromaFormat());
-      const UInt componentScaleY = getComponentScaleY(component, pPic->getChromaFormat());
+        const UInt componentScaleX = getComponentScaleX(component, pPic->getChromaFormat());
+        const UInt componentScaleY = getComponentScaleY(component, pPic->getChromaFormat());
 
-      Int  srcStride  = srcYuv->getStride(component);
-      Pel* srcBlk     = srcYuv->getAddr(component) + ((yPos >> componentScaleY) * srcStride) + (xPos >> componentScaleX);
+        Int  srcStride  = srcYuv->getStride(component);
+        Pel* srcBlk     = srcYuv->getAddr(component) + ((yPos >> componentScaleY) * srcStride) + (xPos >> componentScaleX);
 
-      Int  orgStride  = orgYuv->getStride(component);
-      Pel* orgBlk     = orgYuv->getAddr(component) + ((yPos >> componentScaleY) * orgStride) + (xPos >> componentScaleX);
+        Int  orgStride  = orgYuv->getStride(component);
+        Pel* orgBlk     = orgYuv->getAddr(component) + ((yPos >> componentScaleY) * orgStride) + (xPos >> componentScaleX);
 
-      getBlkStats(component, pPic->getPicSym()->getSPS().getBitDepth(toChannelType(component)), blkStats[ctuRsAddr][component]
-                , srcBlk, orgBlk, srcStride, orgStride, (width  >> componentScaleX), (height >> componentScaleY)
-                , isLeftAvail,  isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail
-                , isCalculatePreDeblockSamples
-                );
+        getBlkStats(component, pPic->getPicSym()->getSPS().getBitDepth(toChannelType(component)), blkStats[ctuRsAddr][component]
+                  , srcBlk, orgBlk, srcStride, orgStride, (width  >> componentScaleX), (height >> componentScaleY)
+                  , isLeftAvail,  isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail
+                  , isCalculatePreDeblockSamples
+                  , m_signLineBuf1[jobIdx], m_signLineBuf2[jobIdx]
+                  );
 
+      }
     }
-  }
+  });
 }
 
 #if OPTIONAL_RESET_SAO_ENCODING_AFTER_IRAP
@@ -795,7 +802,7 @@ Void TEncSampleAdaptiveOffset::deriveModeMergeRDO(const BitDepths &bitDepths, In
   m_pcRDGoOnSbacCoder->load(cabacCoderRDO[SAO_CABACSTATE_BLK_TEMP]);
 }
 
-Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv,
+Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats,
                                                SAOBlkParam* reconParams, SAOBlkParam* codedParams, const Bool bTestSAODisableAtPictureLevel,
                                                const Double saoEncodingRate, const Double saoEncodingRateChroma)
 {
@@ -872,10 +879,9 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
 
     m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_BLK_NEXT ]);
 
-    //apply reconstructed offsets
+    //reconstructed offsets, applied by offsetPicture() once all CTUs are decided
     reconParams[ctuRsAddr] = codedParams[ctuRsAddr];
     reconstructBlkSAOParam(reconParams[ctuRsAddr], mergeList);
-    offsetCTU(ctuRsAddr, srcYuv, resYuv, reconParams[ctuRsAddr], pic);
   } //ctuRsAddr
 
   if (!allBlksDisabled && (totalCost >= 0) && bTestSAODisableAtPictureLevel) //SAO has not beneficial in this case - disable it
@@ -928,27 +934,9 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
                         , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
                         , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
                         , Bool isCalculatePreDeblockSamples
+                        , SChar* signLineBuf1, SChar* signLineBuf2
                         )
 {
-  if(m_lineBufWidth != m_maxCUWidth)
-  {
-    m_lineBufWidth = m_maxCUWidth;
-
-    if (m_signLineBuf1)
-    {
-      delete[] m_signLineBuf1;
-      m_signLineBuf1 = NULL;
-    }
-    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
-
-    if (m_signLineBuf2)
-    {
-      delete[] m_signLineBuf2;
-      m_signLineBuf2 = NULL;
-    }
-    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
-  }
-
   Int x,y, startX, startY, endX, endY, edgeType, firstLineStartX, firstLineEndX;
   SChar signLeft, signRight, signDown;
   Int64 *diff, *count;
@@ -1023,7 +1011,7 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
       {
         diff +=2;
         count+=2;
-        SChar *signUpLine = m_signLineBuf1;
+        SChar *signUpLine = signLineBuf1;
 
         startX = (!isCalculatePreDeblockSamples) ? 0
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
@@ -1094,8 +1082,8 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
         count+=2;
         SChar *signUpLine, *signDownLine, *signTmpLine;
 
-        signUpLine  = m_signLineBuf1;
-        signDownLine= m_signLineBuf2;
+        signUpLine  = signLineBuf1;
+        signDownLine= signLineBuf2;
 
         startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
@@ -1179,7 +1167,7 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
       {
         diff +=2;
         count+=2;
-        SChar *signUpLine = m_signLineBuf1+1;
+        SChar *signUpLine = signLineBuf1+1;
 
         startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
@@ -1240,7 +1240,6 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 
   const ChannelType  chType            = toChannelType(compID);
   const UInt         uiLog2BlockWidth  = g_aucConvertToBit[ uiWidth  ] + 2;
-  const UInt         uiLog2BlockHeight = g_aucConvertToBit[ uiHeight ] + 2;
 
   const ChannelType  channelType       = toChannelType(compID);
   const Bool         extendedPrecision = sps.getSpsRangeExtension().getExtendedPrecisionProcessingFlag();
@@ -1393,7 +1392,8 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
     // encode significant_coeff_flag
     if( uiSigCoeffGroupFlag[ iCGBlkPos ] )
     {
-      const Int patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, iCGPosX, iCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
+      const Int    patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, iCGPosX, iCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
+      const UChar *sigCtxInc     = TComTrQuant::getSigCtxIncTable(patternSigCtx, codingParameters, iSubSet);
 
       UInt uiBlkPos, uiSig, uiCtxSig;
       for( ; iScanPosSig >= iSubPos; iScanPosSig-- )
@@ -1402,7 +1402,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
         uiSig     = (pcCoef[ uiBlkPos ] != 0);
         if( iScanPosSig > iSubPos || iSubSet == 0 || numNonZero )
         {
-          uiCtxSig  = TComTrQuant::getSigCtxInc( patternSigCtx, codingParameters, iScanPosSig, uiLog2BlockWidth, uiLog2BlockHeight, chType );
+          uiCtxSig  = sigCtxInc[ iScanPosSig - iSubPos ];
           m_pcBinIf->encodeBin( uiSig, baseCtx[ uiCtxSig ] );
         }
         if( uiSig )
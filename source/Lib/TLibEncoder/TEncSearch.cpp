@@ -43,6 +43,7 @@ using namespace Eigen;
 #include "TLibCommon/TComRom.h"
 #include "TLibCommon/TComMotionInfo.h"
 #include "TEncSearch.h"
+#include "TEncPic.h"
 #include "TLibCommon/TComTU.h"
 #include "TLibCommon/Debug.h"
 #include <math.h>
@@ -51,13 +52,14 @@ using namespace Eigen;
 #include <iostream>
 
 // EMI: Parameters declaration
+// The per-PU working variables are thread-local, so that motion estimation can run on several threads (NumMEThreads)
 
-signed short MVX_HALF, MVX_QRTER, MVY_HALF, MVY_QRTER = 0;
-std::vector<uint> array_e;
-uint PUHeight, PUWidth, C;
+thread_local signed short MVX_HALF, MVX_QRTER, MVY_HALF, MVY_QRTER = 0;
+thread_local std::vector<uint> array_e;
+thread_local uint PUHeight, PUWidth, C;
 
 // Used to store index of Maximum element of Output layer
-MatrixXf::Index NN_out, maxCol;
+thread_local MatrixXf::Index NN_out, maxCol;
 
 /*
 The next set of variables are part of Eigen library for Matrix and Array manipulations
@@ -65,8 +67,8 @@ The "Array" object arithmetic performs element-wise operations, hence will be us
 The "Matrix" object arithmetic performs matrix operations, hence it's used mainly for weight multiplications
 We can transform to Array or to Matrix using .array() and .matrix()
 */
-Array<float, 22, 1> X1; Array<float, 20, 1> X2; Array<float, 49, 1> OUT;
-Array<float, 4, 1> IN_embs0, IN_embs1; Array<float, 17, 1> IN;
+thread_local Array<float, 22, 1> X1; thread_local Array<float, 20, 1> X2; thread_local Array<float, 49, 1> OUT;
+thread_local Array<float, 4, 1> IN_embs0, IN_embs1; thread_local Array<float, 17, 1> IN;
 Array<float, 8, 4> embs0, embs1;
 Matrix<float, 22, 17> in_h1;
 Matrix<float, 20, 22> h1_h2;
@@ -74,7 +76,8 @@ Matrix<float, 49, 20> h2_out;
 Array<float, 22, 1> b1, BN_gamma_1, BN_beta_1;
 Array<float, 20, 1> b2, BN_gamma_2, BN_beta_2;
 Array<float, 49, 1> bout;
-Array<float, 9, 1> IN_errors, BN_gamma_in, mean, stdev;
+Array<float, 9, 1> BN_gamma_in, mean, stdev;
+thread_local Array<float, 9, 1> IN_errors;
 
 /* ReLU function
 ReLU is achieved in Eigen by using the following code:
@@ -235,6 +238,11 @@ static const TComMv s_acMvRefineQ[9] =
   TComMv(  1,  1 )  // 8
 };
 
+std::atomic<UInt64> TEncSearch::s_auiZeroBlockTested [MAX_NUM_CHANNEL_TYPE][NUM_ZERO_BLOCK_SIZES];
+std::atomic<UInt64> TEncSearch::s_auiZeroBlockSkipped[MAX_NUM_CHANNEL_TYPE][NUM_ZERO_BLOCK_SIZES];
+std::atomic<UInt64> TEncSearch::s_auiResidualCacheLookups[MAX_CU_DEPTH];
+std::atomic<UInt64> TEncSearch::s_auiResidualCacheHits   [MAX_CU_DEPTH];
+
 static Void offsetSubTUCBFs(TComTU &rTu, const ComponentID compID)
 {
         TComDataCU *pcCU              = rTu.getCU();
@@ -278,8 +286,37 @@ TEncSearch::TEncSearch()
 , m_pppcRDSbacCoder (NULL)
 , m_pcRDGoOnSbacCoder (NULL)
 , m_pTempPel (NULL)
+, m_pcSADTreeCache (NULL)
+, m_eSADTreeMode (SADTREE_OFF)
+, m_uiSADTreeGeneration (0)
+, m_uiSADTreeCtuRsAddr (MAX_UINT)
+, m_uiSADTreeZorderIdx (MAX_UINT)
+, m_uiSADTreeDepth (MAX_UINT)
+, m_iSADTreePOC (MAX_INT)
+, m_iSADTreeRefList (0)
+, m_iSADTreeRefIdx (0)
+, m_iSADTreeSubSize (0)
+, m_bSADTreeRecordSAD (false)
+, m_iSADTreePUX0 (0)
+, m_iSADTreePUY0 (0)
+, m_iSADTreePUX1 (0)
+, m_iSADTreePUY1 (0)
+, m_pcMEThreadPool (NULL)
+, m_bMEWorker (false)
+, m_uiNNCenter (0)
+, m_uiNNPUHeight (0)
+, m_uiNNPUWidth (0)
 , m_isInitialized (false)
 {
+  memset( m_auiNNErrors, 0, sizeof(m_auiNNErrors) );
+  for (UInt d=0; d<MAX_CU_DEPTH; d++)
+  {
+    m_apcResidualCache[d]          = NULL;
+    m_auiResidualCacheNext[d]      = 0;
+    m_auiResidualCacheCtuRsAddr[d] = MAX_UINT;
+    m_auiResidualCacheZorderIdx[d] = MAX_UINT;
+    m_aiResidualCachePOC[d]        = MAX_INT;
+  }
   for (UInt ch=0; ch<MAX_NUM_COMPONENT; ch++)
   {
     m_ppcQTTempCoeff[ch]                           = NULL;
@@ -318,6 +355,31 @@ Void TEncSearch::destroy()
     m_pTempPel = NULL;
   }
 
+  delete [] m_pcSADTreeCache;
+  m_pcSADTreeCache = NULL;
+
+  for (UInt d = 0; d < MAX_CU_DEPTH; d++)
+  {
+    if ( m_apcResidualCache[d] )
+    {
+      for (UInt i = 0; i < RESIDUAL_CACHE_SIZE; i++)
+      {
+        m_apcResidualCache[d][i].destroy();
+      }
+      delete [] m_apcResidualCache[d];
+      m_apcResidualCache[d] = NULL;
+    }
+  }
+
+  for ( UInt i = 0; i < m_apcMEWorker.size(); i++ )
+  {
+    m_apcMEWorker[i]->destroy();
+    delete m_apcMEWorker[i];
+    delete m_apcMEWorkerRdCost[i];
+  }
+  m_apcMEWorker.clear();
+  m_apcMEWorkerRdCost.clear();
+
   if ( m_pcEncCfg )
   {
     const UInt uiNumLayersAllocated = m_pcEncCfg->getQuadtreeTULog2MaxSize()-m_pcEncCfg->getQuadtreeTULog2MinSize()+1;
@@ -385,7 +447,8 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
                       TEncEntropy*   pcEntropyCoder,
                       TComRdCost*    pcRdCost,
                       TEncSbac***    pppcRDSbacCoder,
-                      TEncSbac*      pcRDGoOnSbacCoder
+                      TEncSbac*      pcRDGoOnSbacCoder,
+                      TComThreadPool* pcThreadPool
                       )
 {
   assert (!m_isInitialized);
@@ -399,6 +462,7 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
 
   m_pppcRDSbacCoder              = pppcRDSbacCoder;
   m_pcRDGoOnSbacCoder            = pcRDGoOnSbacCoder;
+  m_pcMEThreadPool               = pcThreadPool;
   
   for (UInt iDir = 0; iDir < MAX_NUM_REF_LIST_ADAPT_SR; iDir++)
   {
@@ -429,6 +493,30 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
 
   m_pTempPel = new Pel[maxCUWidth*maxCUHeight];
 
+  if ( pcEncCfg->getUseSADTreeME() )
+  {
+    m_pcSADTreeCache = new SADTreeEntry[ 1 << (SADTREE_CACHE_LOG2_SIZE << 1) ];
+    memset( m_pcSADTreeCache, 0, sizeof(SADTreeEntry) * (1 << (SADTREE_CACHE_LOG2_SIZE << 1)) );
+    m_uiSADTreeGeneration = 1;
+  }
+
+  // the cached decisions carry no debug string, so the cache is not used when DEBUG_STRING is enabled
+  if ( pcEncCfg->getUseInterResidualCache() && !m_bMEWorker && !DEBUG_STRING )
+  {
+    for (UInt d = 0; d < std::min<UInt>(maxTotalCUDepth, MAX_CU_DEPTH); d++)
+    {
+      if ( (maxCUWidth >> d) < 8 ) // CUs are at least 8x8, deeper levels only split TUs
+      {
+        break;
+      }
+      m_apcResidualCache[d] = new ResidualCacheEntry[RESIDUAL_CACHE_SIZE];
+      for (UInt i = 0; i < RESIDUAL_CACHE_SIZE; i++)
+      {
+        m_apcResidualCache[d][i].create( cform, maxCUWidth >> d, maxCUHeight >> d, 1 << ((maxTotalCUDepth - d) << 1) );
+      }
+    }
+  }
+
   const UInt uiNumLayersToAllocate = pcEncCfg->getQuadtreeTULog2MaxSize()-pcEncCfg->getQuadtreeTULog2MinSize()+1;
   const UInt uiNumPartitions = 1<<(maxTotalCUDepth<<1);
   for (UInt ch=0; ch<MAX_NUM_COMPONENT; ch++)
@@ -465,6 +553,20 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
   }
   m_pcQTTempTransformSkipTComYuv.create( maxCUWidth, maxCUHeight, pcEncCfg->getChromaFormatIdc() );
   m_tmpYuvPred.create(MAX_CU_SIZE, MAX_CU_SIZE, pcEncCfg->getChromaFormatIdc());
+
+  if ( !m_bMEWorker && pcEncCfg->getNumMEThreads() > 1 )
+  {
+    const Int iNumWorkers = pcEncCfg->getNumMEThreads();
+    for ( Int i = 0; i < iNumWorkers; i++ )
+    {
+      m_apcMEWorkerRdCost.push_back( new TComRdCost );
+      m_apcMEWorker.push_back( new TEncSearch );
+      m_apcMEWorker[i]->m_bMEWorker = true;
+      m_apcMEWorker[i]->init( pcEncCfg, pcTrQuant, iSearchRange, bipredSearchRange, motionEstimationSearchMethod,
+                              maxCUWidth, maxCUHeight, maxTotalCUDepth, pcEntropyCoder, m_apcMEWorkerRdCost[i],
+                              pppcRDSbacCoder, pcRDGoOnSbacCoder, NULL );
+    }
+  }
   m_isInitialized = true;
 
   // EMI: Weights and Bias Initialization based on QP
@@ -1163,7 +1265,14 @@ __inline Void TEncSearch::xTZSearchHelp( const TComPattern* const pcPatternKey,
       }
     }
 
-    uiSad = m_cDistParam.DistFunc( &m_cDistParam );
+    if ( m_eSADTreeMode == SADTREE_RECORD )
+    {
+      uiSad = xSADTreeRecord( pcPatternKey, piRefSrch, rcStruct.iYStride, iSearchX, iSearchY );
+    }
+    else if ( m_eSADTreeMode != SADTREE_QUERY || !xSADTreeQuery( iSearchX, iSearchY, uiSad ) )
+    {
+      uiSad = m_cDistParam.DistFunc( &m_cDistParam );
+    }
 
     // EMI: If save is true, store the values of SSE in a dynamic array
     if(save) {array_e.push_back(uiSad);}
@@ -3783,6 +3892,13 @@ Void TEncSearch::predInterSearch( TComDataCU* pcCU, TComYuv* pcOrgYuv, TComYuv*
 #endif
 
     //  Uni-directional prediction
+    // AMVP candidates of all references first, then the (possibly parallel) motion searches, then the selection in reference order
+    Int          iNumSearches = 0;
+    Int          aiSearchRefList[2*MAX_NUM_REF];
+    Int          aiSearchRefIdx [2*MAX_NUM_REF];
+    UInt         auiBitsTemp[2][33];
+    Distortion   auiCostTemp[2][33];
+
     for ( Int iRefList = 0; iRefList < iNumPredDir; iRefList++ )
     {
       RefPicList  eRefPicList = ( iRefList ? REF_PIC_LIST_1 : REF_PIC_LIST_0 );
@@ -3810,31 +3926,51 @@ Void TEncSearch::predInterSearch( TComDataCU* pcCU, TComYuv* pcOrgYuv, TComYuv*
         }
 
         uiBitsTemp += m_auiMVPIdxCost[aaiMvpIdx[iRefList][iRefIdxTemp]][AMVP_MAX_NUM_CANDS];
+        auiBitsTemp[iRefList][iRefIdxTemp] = uiBitsTemp;
+
+        xCopyAMVPInfo(pcCU->getCUMvField(eRefPicList)->getAMVPInfo(), &aacAMVPInfo[iRefList][iRefIdxTemp]); // must always be done ( also when AMVP_MODE = AM_NONE )
 
-        if ( m_pcEncCfg->getFastMEForGenBLowDelayEnabled() && iRefList == 1 )    // list 1
+        if ( !( m_pcEncCfg->getFastMEForGenBLowDelayEnabled() && iRefList == 1 && pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp ) >= 0 ) )
         {
-          if ( pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp ) >= 0 )
-          {
-            cMvTemp[1][iRefIdxTemp] = cMvTemp[0][pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )];
-            uiCostTemp = uiCostTempL0[pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )];
-            /*first subtract the bit-rate part of the cost of the other list*/
-            uiCostTemp -= m_pcRdCost->getCost( uiBitsTempL0[pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )] );
-            /*correct the bit-rate part of the current ref*/
-            m_pcRdCost->setPredictor  ( cMvPred[iRefList][iRefIdxTemp] );
-            uiBitsTemp += m_pcRdCost->getBitsOfVectorWithPredictor( cMvTemp[1][iRefIdxTemp].getHor(), cMvTemp[1][iRefIdxTemp].getVer() );
-            /*calculate the correct cost*/
-            uiCostTemp += m_pcRdCost->getCost( uiBitsTemp );
-          }
-          else
-          {
-            xMotionEstimation ( pcCU, pcOrgYuv, iPartIdx, eRefPicList, &cMvPred[iRefList][iRefIdxTemp], iRefIdxTemp, cMvTemp[iRefList][iRefIdxTemp], uiBitsTemp, uiCostTemp );
-          }
+          aiSearchRefList[iNumSearches] = iRefList;
+          aiSearchRefIdx [iNumSearches] = iRefIdxTemp;
+          iNumSearches++;
+        }
+      }
+    }
+
+    xMotionEstimationRefs( pcCU, pcOrgYuv, iPartIdx, iNumSearches, aiSearchRefList, aiSearchRefIdx, cMvPred, cMvTemp, auiBitsTemp, auiCostTemp );
+
+    // motion cost state left behind by xMotionEstimation
+    m_pcRdCost->selectMotionLambda( true, 0, pcCU->getCUTransquantBypass(uiPartAddr) );
+    m_pcRdCost->setCostScale( 0 );
+
+    for ( Int iRefList = 0; iRefList < iNumPredDir; iRefList++ )
+    {
+      RefPicList  eRefPicList = ( iRefList ? REF_PIC_LIST_1 : REF_PIC_LIST_0 );
+
+      for ( Int iRefIdxTemp = 0; iRefIdxTemp < pcCU->getSlice()->getNumRefIdx(eRefPicList); iRefIdxTemp++ )
+      {
+        uiBitsTemp = auiBitsTemp[iRefList][iRefIdxTemp];
+
+        if ( m_pcEncCfg->getFastMEForGenBLowDelayEnabled() && iRefList == 1 && pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp ) >= 0 )
+        {
+          cMvTemp[1][iRefIdxTemp] = cMvTemp[0][pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )];
+          uiCostTemp = uiCostTempL0[pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )];
+          /*first subtract the bit-rate part of the cost of the other list*/
+          uiCostTemp -= m_pcRdCost->getCost( uiBitsTempL0[pcCU->getSlice()->getList1IdxToList0Idx( iRefIdxTemp )] );
+          /*correct the bit-rate part of the current ref*/
+          m_pcRdCost->setPredictor  ( cMvPred[iRefList][iRefIdxTemp] );
+          uiBitsTemp += m_pcRdCost->getBitsOfVectorWithPredictor( cMvTemp[1][iRefIdxTemp].getHor(), cMvTemp[1][iRefIdxTemp].getVer() );
+          /*calculate the correct cost*/
+          uiCostTemp += m_pcRdCost->getCost( uiBitsTemp );
         }
         else
         {
-          xMotionEstimation ( pcCU, pcOrgYuv, iPartIdx, eRefPicList, &cMvPred[iRefList][iRefIdxTemp], iRefIdxTemp, cMvTemp[iRefList][iRefIdxTemp], uiBitsTemp, uiCostTemp );
+          uiCostTemp = auiCostTemp[iRefList][iRefIdxTemp];
+          m_pcRdCost->setPredictor( cMvPred[iRefList][iRefIdxTemp] );
         }
-        xCopyAMVPInfo(pcCU->getCUMvField(eRefPicList)->getAMVPInfo(), &aacAMVPInfo[iRefList][iRefIdxTemp]); // must always be done ( also when AMVP_MODE = AM_NONE )
+        xCopyAMVPInfo(&aacAMVPInfo[iRefList][iRefIdxTemp], pcCU->getCUMvField(eRefPicList)->getAMVPInfo());
         xCheckBestMVP(pcCU, eRefPicList, cMvTemp[iRefList][iRefIdxTemp], cMvPred[iRefList][iRefIdxTemp], aaiMvpIdx[iRefList][iRefIdxTemp], uiBitsTemp, uiCostTemp);
 
         if ( iRefList == 0 )
@@ -4450,6 +4586,11 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   assert(eRefPicList < MAX_NUM_REF_LIST_ADAPT_SR && iRefIdxPred<Int(MAX_IDX_ADAPT_SR));
   m_iSearchRange = m_aaiAdaptSR[eRefPicList][iRefIdxPred];
 
+  // EMI: network inputs of the previous PU of this search context
+  C        = m_uiNNCenter;
+  PUHeight = m_uiNNPUHeight;
+  PUWidth  = m_uiNNPUWidth;
+
   Int           iSrchRng      = ( bBi ? m_bipredSearchRange : m_iSearchRange );
   TComPattern   tmpPattern;
   TComPattern*  pcPatternKey  = &tmpPattern;
@@ -4503,7 +4644,10 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   //  Do integer search
   if ( (m_motionEstimationSearchMethod==MESEARCH_FULL) || bBi )
   {
-    xPatternSearch      ( pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost );
+    const TEncPic* pcSEARef = m_pcEncCfg->getUseRecIntegralImages() ? dynamic_cast<const TEncPic*>( pcCU->getSlice()->getRefPic( eRefPicList, iRefIdxPred ) ) : NULL;
+    xPatternSearch      ( pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pcSEARef,
+                          pcCU->getCUPelX() + g_auiRasterToPelX[ g_auiZscanToRaster[uiPartAddr] ],
+                          pcCU->getCUPelY() + g_auiRasterToPelY[ g_auiZscanToRaster[uiPartAddr] ] );
   }
   else
   {
@@ -4519,7 +4663,16 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
     PUWidth = iRoiWidth;
 
 
-    xPatternSearchFast  ( pcCU, pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred );
+    TComMv cPyramidMvPred;
+    const TComMv *pPyramidMvPred=0;
+    if (m_pcEncCfg->getUsePyramidME() && xGetPyramidMvPred( pcCU, uiPartAddr, iRoiWidth, iRoiHeight, eRefPicList, iRefIdxPred, cPyramidMvPred ))
+    {
+      pPyramidMvPred = &cPyramidMvPred;
+    }
+
+    xSetSADTreeMode( pcCU, uiPartAddr, iRoiWidth, iRoiHeight, eRefPicList, iRefIdxPred );
+    xPatternSearchFast  ( pcCU, pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred, pPyramidMvPred );
+    m_eSADTreeMode = SADTREE_OFF;
     if (pcCU->getPartitionSize(0) == SIZE_2Nx2N)
     {
       m_integerMv2Nx2N[eRefPicList][iRefIdxPred] = rcMv;
@@ -4536,7 +4689,21 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   m_pcRdCost->setCostScale( 0 );
 
   // EMI: Big chunk of modifications!
-  
+
+  // Inputs that this search did not set (points of the final square search outside the search range, block size and
+  // centre error of a full search) keep the value of the previous PU of this search context
+  for ( UInt k = UInt(array_e.size()); k < NUM_NN_ERRORS; k++ )
+  {
+    array_e.push_back( m_auiNNErrors[k] );
+  }
+  for ( UInt k = 0; k < NUM_NN_ERRORS; k++ )
+  {
+    m_auiNNErrors[k] = array_e[k];
+  }
+  m_uiNNCenter   = C;
+  m_uiNNPUHeight = PUHeight;
+  m_uiNNPUWidth  = PUWidth;
+
   //Run our ANN model
   NN_pred();
   
@@ -4599,6 +4766,586 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
 }
 
 
+/** Uni-directional motion estimation of a PU for a set of reference pictures
+ * With NumMEThreads > 1 the searches run on the thread pool of the encoder. Search i is done by the context i % NumMEThreads, so the
+ * searches of one context stay in the same order and the result does not depend on the thread scheduling.
+ * \param pcCU          CU containing the PU
+ * \param pcYuvOrg      original CU
+ * \param iPartIdx      PU index
+ * \param iNumSearches  number of searches
+ * \param piRefList     reference list of each search
+ * \param piRefIdx      reference index of each search
+ * \param cMvPred       AMVP predictors, indexed by reference list and index
+ * \param cMv           resulting motion vectors
+ * \param auiBits       bits of the PU without the MVD on input, with the MVD on output
+ * \param auiCost       resulting motion costs
+ */
+Void TEncSearch::xMotionEstimationRefs( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPartIdx, Int iNumSearches,
+                                        const Int* piRefList, const Int* piRefIdx,
+                                        TComMv cMvPred[][33], TComMv cMv[][33], UInt auiBits[][33], Distortion auiCost[][33] )
+{
+  if ( m_apcMEWorker.empty() || iNumSearches < 2 )
+  {
+    for ( Int i = 0; i < iNumSearches; i++ )
+    {
+      const Int iList = piRefList[i];
+      const Int iRef  = piRefIdx[i];
+      xMotionEstimation( pcCU, pcYuvOrg, iPartIdx, RefPicList(iList), &cMvPred[iList][iRef], iRef, cMv[iList][iRef], auiBits[iList][iRef], auiCost[iList][iRef] );
+    }
+    return;
+  }
+
+  const Int iNumJobs = std::min<Int>( iNumSearches, Int(m_apcMEWorker.size()) );
+  for ( Int iJob = 0; iJob < iNumJobs; iJob++ )
+  {
+    TEncSearch* pcWorker = m_apcMEWorker[iJob];
+    *m_apcMEWorkerRdCost[iJob] = *m_pcRdCost;
+    memcpy( pcWorker->m_aaiAdaptSR,     m_aaiAdaptSR,     sizeof(m_aaiAdaptSR) );
+    memcpy( pcWorker->m_integerMv2Nx2N, m_integerMv2Nx2N, sizeof(m_integerMv2Nx2N) );
+    xCopyNNState( pcWorker, this );
+  }
+
+  m_pcMEThreadPool->parallelFor( iNumJobs, [&]( Int iJob )
+  {
+    TEncSearch* pcWorker = m_apcMEWorker[iJob];
+    for ( Int i = iJob; i < iNumSearches; i += iNumJobs )
+    {
+      const Int iList = piRefList[i];
+      const Int iRef  = piRefIdx[i];
+      pcWorker->xMotionEstimation( pcCU, pcYuvOrg, iPartIdx, RefPicList(iList), &cMvPred[iList][iRef], iRef, cMv[iList][iRef], auiBits[iList][iRef], auiCost[iList][iRef] );
+    }
+  } );
+
+  for ( Int i = 0; i < iNumSearches; i++ )
+  {
+    const Int iList = piRefList[i];
+    const Int iRef  = piRefIdx[i];
+    m_integerMv2Nx2N[iList][iRef] = m_apcMEWorker[i % iNumJobs]->m_integerMv2Nx2N[iList][iRef];
+  }
+  xCopyNNState( this, m_apcMEWorker[(iNumSearches - 1) % iNumJobs] );
+}
+
+
+Void TEncSearch::resetNNState()
+{
+  memset( m_auiNNErrors, 0, sizeof(m_auiNNErrors) );
+  m_uiNNCenter   = 0;
+  m_uiNNPUHeight = 0;
+  m_uiNNPUWidth  = 0;
+}
+
+
+/** Zero-block detection: test whether an inter residual TU can be coded with CBF=0 without transforming and quantising it.
+ * \param rTu        TU of the residual
+ * \param compID     component of the residual
+ * \param pcResidual residual samples
+ * \param uiStride   stride of the residual
+ * \param cQP        quantisation parameters of the component
+ * \returns true if the TU is short-circuited to all-zero levels
+ */
+Bool TEncSearch::xIsZeroBlock( TComTU &rTu, const ComponentID compID, const Pel* pcResidual, const UInt uiStride, const QpParam &cQP )
+{
+  const ZeroBlockDetectionMode mode = m_pcEncCfg->getZeroBlockDetection();
+  if (mode == ZERO_BLOCK_DETECTION_OFF)
+  {
+    return false;
+  }
+
+  const Bool bZeroBlock = m_pcTrQuant->isZeroBlock( rTu, compID, pcResidual, uiStride, cQP, mode );
+
+  const UInt uiSizeIdx = g_aucConvertToBit[rTu.getRect(compID).width];
+  if (uiSizeIdx < NUM_ZERO_BLOCK_SIZES)
+  {
+    const ChannelType chType = toChannelType(compID);
+    s_auiZeroBlockTested[chType][uiSizeIdx]++;
+    if (bZeroBlock)
+    {
+      s_auiZeroBlockSkipped[chType][uiSizeIdx]++;
+    }
+  }
+
+  return bZeroBlock;
+}
+
+
+Void TEncSearch::printZeroBlockStatistics( const ZeroBlockDetectionMode mode )
+{
+  printf("\nZero-block detection (%s): TUs short-circuited / TUs tested\n", mode == ZERO_BLOCK_DETECTION_AGGRESSIVE ? "aggressive" : "conservative");
+  for (UInt ch = 0; ch < MAX_NUM_CHANNEL_TYPE; ch++)
+  {
+    printf("  %-6s", ch == CHANNEL_TYPE_LUMA ? "Luma" : "Chroma");
+    for (UInt uiSizeIdx = 0; uiSizeIdx < NUM_ZERO_BLOCK_SIZES; uiSizeIdx++)
+    {
+      const UInt64 uiTested  = s_auiZeroBlockTested [ch][uiSizeIdx];
+      const UInt64 uiSkipped = s_auiZeroBlockSkipped[ch][uiSizeIdx];
+      printf(" %2dx%-2d %10llu / %10llu (%5.1f%%)", 4 << uiSizeIdx, 4 << uiSizeIdx, (unsigned long long)uiSkipped, (unsigned long long)uiTested,
+             uiTested ? (100.0 * uiSkipped) / uiTested : 0.0);
+    }
+    printf("\n");
+  }
+}
+
+
+Void TEncSearch::printResidualCacheStatistics()
+{
+  printf("\nInter residual cache: hits / lookups\n");
+  for (UInt d = 0; d < MAX_CU_DEPTH; d++)
+  {
+    const UInt64 uiLookups = s_auiResidualCacheLookups[d];
+    const UInt64 uiHits    = s_auiResidualCacheHits   [d];
+    if (uiLookups > 0)
+    {
+      printf("  CU depth %d: %10llu / %10llu (%5.1f%%)\n", d, (unsigned long long)uiHits, (unsigned long long)uiLookups, (100.0 * uiHits) / uiLookups);
+    }
+  }
+}
+
+
+Void TEncSearch::ResidualCacheEntry::create( const ChromaFormat chFmt, const UInt uiWidth, const UInt uiHeight, const UInt uiNumPartitions )
+{
+  bValid = false;
+  cResi    .create( uiWidth, uiHeight, chFmt );
+  cResiBest.create( uiWidth, uiHeight, chFmt );
+  puhTrIdx = new UChar[uiNumPartitions];
+  for (UInt ch = 0; ch < MAX_NUM_COMPONENT; ch++)
+  {
+    const UInt uiNumCoeffs = (uiWidth * uiHeight) >> (::getComponentScaleX(ComponentID(ch), chFmt) + ::getComponentScaleY(ComponentID(ch), chFmt));
+    apuhCbf               [ch] = new UChar [uiNumPartitions];
+    apuhTransformSkip     [ch] = new UChar [uiNumPartitions];
+    apcCrossComponentAlpha[ch] = new SChar [uiNumPartitions];
+    apuhExplicitRdpcmMode [ch] = new UChar [uiNumPartitions];
+    apcCoeff              [ch] = new TCoeff[uiNumCoeffs];
+#if ADAPTIVE_QP_SELECTION
+    apcArlCoeff           [ch] = new TCoeff[uiNumCoeffs];
+#endif
+  }
+}
+
+
+Void TEncSearch::ResidualCacheEntry::destroy()
+{
+  cResi    .destroy();
+  cResiBest.destroy();
+  delete [] puhTrIdx;
+  for (UInt ch = 0; ch < MAX_NUM_COMPONENT; ch++)
+  {
+    delete [] apuhCbf               [ch];
+    delete [] apuhTransformSkip     [ch];
+    delete [] apcCrossComponentAlpha[ch];
+    delete [] apuhExplicitRdpcmMode [ch];
+    delete [] apcCoeff              [ch];
+#if ADAPTIVE_QP_SELECTION
+    delete [] apcArlCoeff           [ch];
+#endif
+  }
+}
+
+
+UInt64 TEncSearch::xHashResidual( const TComYuv* pcResi, const UInt uiWidth, const UInt uiHeight ) const
+{
+  UInt64 uiHash = 14695981039346656037ULL; // FNV-1a over the residual samples
+  for (UInt ch = 0; ch < pcResi->getNumberValidComponents(); ch++)
+  {
+    const ComponentID compID    = ComponentID(ch);
+    const Pel*        piResi    = pcResi->getAddr(compID);
+    const UInt        uiStride  = pcResi->getStride(compID);
+    const UInt        uiCompW   = uiWidth  >> pcResi->getComponentScaleX(compID);
+    const UInt        uiCompH   = uiHeight >> pcResi->getComponentScaleY(compID);
+    for (UInt y = 0; y < uiCompH; y++, piResi += uiStride)
+    {
+      for (UInt x = 0; x < uiCompW; x++)
+      {
+        uiHash = (uiHash ^ UInt64(UShort(piResi[x]))) * 1099511628211ULL;
+      }
+    }
+  }
+  return uiHash;
+}
+
+
+/** Look up the residual quadtree decision of the CU under test for its residual.
+ * The decision of an inter CU depends on its residual and on the CABAC state at the start of the CU, which is the same for all the
+ * modes tested for a CU. The entries of a CU depth are therefore only kept while the same CU is tested, and are matched on the
+ * residual, the partitioning, the QP and the lambda.
+ * \param pcCU          CU under test
+ * \param pcYuvResi     residual of the CU
+ * \param pcYuvResiBest set to the coded residual of the cached decision, on a hit
+ * \param ruiHash       hash of the residual, for xStoreResidualCache
+ * \returns true if the transform data of the cached decision have been copied to pcCU
+ */
+Bool TEncSearch::xLookupResidualCache( TComDataCU* pcCU, const TComYuv* pcYuvResi, TComYuv* pcYuvResiBest, UInt64& ruiHash )
+{
+  const UInt uiDepth = pcCU->getDepth(0);
+  ResidualCacheEntry* pcEntries = (uiDepth < MAX_CU_DEPTH) ? m_apcResidualCache[uiDepth] : NULL;
+  if ( pcEntries == NULL )
+  {
+    return false;
+  }
+
+  if ( m_auiResidualCacheCtuRsAddr[uiDepth] != pcCU->getCtuRsAddr() || m_auiResidualCacheZorderIdx[uiDepth] != pcCU->getZorderIdxInCtu()
+    || m_aiResidualCachePOC[uiDepth] != pcCU->getSlice()->getPOC() )
+  {
+    for (UInt i = 0; i < RESIDUAL_CACHE_SIZE; i++)
+    {
+      pcEntries[i].bValid = false;
+    }
+    m_auiResidualCacheCtuRsAddr[uiDepth] = pcCU->getCtuRsAddr();
+    m_auiResidualCacheZorderIdx[uiDepth] = pcCU->getZorderIdxInCtu();
+    m_aiResidualCachePOC[uiDepth]        = pcCU->getSlice()->getPOC();
+  }
+
+  const UInt uiWidth  = pcCU->getWidth(0);
+  const UInt uiHeight = pcCU->getHeight(0);
+  ruiHash = xHashResidual( pcYuvResi, uiWidth, uiHeight );
+  s_auiResidualCacheLookups[uiDepth]++;
+
+  for (UInt i = 0; i < RESIDUAL_CACHE_SIZE; i++)
+  {
+    ResidualCacheEntry& rcEntry = pcEntries[i];
+    if ( !rcEntry.bValid || rcEntry.uiHash != ruiHash || rcEntry.ePartSize != pcCU->getPartitionSize(0) || rcEntry.iQP != pcCU->getQP(0)
+      || rcEntry.ucChromaQpAdj != pcCU->getChromaQpAdj(0) || rcEntry.bLossless != pcCU->getCUTransquantBypass(0) || rcEntry.dLambda != m_pcRdCost->getLambda() )
+    {
+      continue;
+    }
+
+    Bool bSameResidual = true;
+    for (UInt ch = 0; ch < pcYuvResi->getNumberValidComponents() && bSameResidual; ch++)
+    {
+      const ComponentID compID = ComponentID(ch);
+      const UInt        uiCompW = uiWidth  >> pcYuvResi->getComponentScaleX(compID);
+      const UInt        uiCompH = uiHeight >> pcYuvResi->getComponentScaleY(compID);
+      for (UInt y = 0; y < uiCompH && bSameResidual; y++)
+      {
+        bSameResidual = memcmp( pcYuvResi->getAddr(compID) + y * pcYuvResi->getStride(compID), rcEntry.cResi.getAddr(compID) + y * rcEntry.cResi.getStride(compID), uiCompW * sizeof(Pel) ) == 0;
+      }
+    }
+    if ( !bSameResidual )
+    {
+      continue;
+    }
+
+    const UInt uiNumParts = pcCU->getTotalNumPart();
+    memcpy( pcCU->getTransformIdx(), rcEntry.puhTrIdx, uiNumParts * sizeof(UChar) );
+    for (UInt ch = 0; ch < pcYuvResi->getNumberValidComponents(); ch++)
+    {
+      const ComponentID compID = ComponentID(ch);
+      memcpy( pcCU->getCbf(compID),                             rcEntry.apuhCbf[ch],                uiNumParts * sizeof(UChar) );
+      memcpy( pcCU->getTransformSkip(compID),                   rcEntry.apuhTransformSkip[ch],      uiNumParts * sizeof(UChar) );
+      memcpy( pcCU->getCrossComponentPredictionAlpha(compID),   rcEntry.apcCrossComponentAlpha[ch], uiNumParts * sizeof(SChar) );
+      memcpy( pcCU->getExplicitRdpcmMode(compID),               rcEntry.apuhExplicitRdpcmMode[ch],  uiNumParts * sizeof(UChar) );
+    }
+
+    if ( pcCU->getQtRootCbf(0) )
+    {
+      for (UInt ch = 0; ch < pcYuvResi->getNumberValidComponents(); ch++)
+      {
+        const ComponentID compID      = ComponentID(ch);
+        const UInt        uiNumCoeffs = (uiWidth * uiHeight) >> (pcYuvResi->getComponentScaleX(compID) + pcYuvResi->getComponentScaleY(compID));
+        memcpy( pcCU->getCoeff(compID),    rcEntry.apcCoeff[ch],    uiNumCoeffs * sizeof(TCoeff) );
+#if ADAPTIVE_QP_SELECTION
+        memcpy( pcCU->getArlCoeff(compID), rcEntry.apcArlCoeff[ch], uiNumCoeffs * sizeof(TCoeff) );
+#endif
+      }
+      rcEntry.cResiBest.copyToPartYuv( pcYuvResiBest, 0 );
+    }
+
+    s_auiResidualCacheHits[uiDepth]++;
+    return true;
+  }
+
+  return false;
+}
+
+
+/** Store the residual quadtree decision made for the CU under test, replacing the oldest entry of its depth.
+ * \param pcCU          CU under test, with the transform data of the decision
+ * \param pcYuvResi     residual of the CU
+ * \param pcYuvResiBest coded residual of the CU
+ * \param uiHash        hash of the residual, from xLookupResidualCache
+ */
+Void TEncSearch::xStoreResidualCache( TComDataCU* pcCU, const TComYuv* pcYuvResi, const TComYuv* pcYuvResiBest, const UInt64 uiHash )
+{
+  const UInt uiDepth = pcCU->getDepth(0);
+  ResidualCacheEntry* pcEntries = (uiDepth < MAX_CU_DEPTH) ? m_apcResidualCache[uiDepth] : NULL;
+  if ( pcEntries == NULL )
+  {
+    return;
+  }
+
+  ResidualCacheEntry& rcEntry = pcEntries[m_auiResidualCacheNext[uiDepth]];
+  m_auiResidualCacheNext[uiDepth] = (m_auiResidualCacheNext[uiDepth] + 1) % RESIDUAL_CACHE_SIZE;
+
+  const UInt uiWidth    = pcCU->getWidth(0);
+  const UInt uiHeight   = pcCU->getHeight(0);
+  const UInt uiNumParts = pcCU->getTotalNumPart();
+
+  rcEntry.bValid        = true;
+  rcEntry.uiHash        = uiHash;
+  rcEntry.ePartSize     = pcCU->getPartitionSize(0);
+  rcEntry.iQP           = pcCU->getQP(0);
+  rcEntry.ucChromaQpAdj = pcCU->getChromaQpAdj(0);
+  rcEntry.bLossless     = pcCU->getCUTransquantBypass(0);
+  rcEntry.dLambda       = m_pcRdCost->getLambda();
+  pcYuvResi->copyToPartYuv( &rcEntry.cResi, 0 );
+
+  memcpy( rcEntry.puhTrIdx, pcCU->getTransformIdx(), uiNumParts * sizeof(UChar) );
+  for (UInt ch = 0; ch < pcYuvResi->getNumberValidComponents(); ch++)
+  {
+    const ComponentID compID = ComponentID(ch);
+    memcpy( rcEntry.apuhCbf[ch],                pcCU->getCbf(compID),                           uiNumParts * sizeof(UChar) );
+    memcpy( rcEntry.apuhTransformSkip[ch],      pcCU->getTransformSkip(compID),                 uiNumParts * sizeof(UChar) );
+    memcpy( rcEntry.apcCrossComponentAlpha[ch], pcCU->getCrossComponentPredictionAlpha(compID), uiNumParts * sizeof(SChar) );
+    memcpy( rcEntry.apuhExplicitRdpcmMode[ch],  pcCU->getExplicitRdpcmMode(compID),             uiNumParts * sizeof(UChar) );
+  }
+
+  if ( pcCU->getQtRootCbf(0) )
+  {
+    for (UInt ch = 0; ch < pcYuvResi->getNumberValidComponents(); ch++)
+    {
+      const ComponentID compID      = ComponentID(ch);
+      const UInt        uiNumCoeffs = (uiWidth * uiHeight) >> (pcYuvResi->getComponentScaleX(compID) + pcYuvResi->getComponentScaleY(compID));
+      memcpy( rcEntry.apcCoeff[ch],    pcCU->getCoeff(compID),    uiNumCoeffs * sizeof(TCoeff) );
+#if ADAPTIVE_QP_SELECTION
+      memcpy( rcEntry.apcArlCoeff[ch], pcCU->getArlCoeff(compID), uiNumCoeffs * sizeof(TCoeff) );
+#endif
+    }
+    pcYuvResiBest->copyToPartYuv( &rcEntry.cResiBest, 0 );
+  }
+}
+
+
+Void TEncSearch::xCopyNNState( TEncSearch* pcDst, const TEncSearch* pcSrc )
+{
+  memcpy( pcDst->m_auiNNErrors, pcSrc->m_auiNNErrors, sizeof(m_auiNNErrors) );
+  pcDst->m_uiNNCenter   = pcSrc->m_uiNNCenter;
+  pcDst->m_uiNNPUHeight = pcSrc->m_uiNNPUHeight;
+  pcDst->m_uiNNPUWidth  = pcSrc->m_uiNNPUWidth;
+}
+
+
+/** Get the integer-pel start candidate of the hierarchical motion pre-analysis for a PU
+ * \param pcCU        CU containing the PU
+ * \param uiPartAddr  Z-order offset of the PU inside the CU
+ * \param iRoiWidth   PU width
+ * \param iRoiHeight  PU height
+ * \param eRefPicList Reference picture list
+ * \param iRefIdx     Reference index
+ * \param rcMv        Candidate, scaled to the POC distance of the reference picture
+ * \returns true if a candidate is available
+ */
+Bool TEncSearch::xGetPyramidMvPred( const TComDataCU* const pcCU, const UInt uiPartAddr, const Int iRoiWidth, const Int iRoiHeight,
+                                    const RefPicList eRefPicList, const Int iRefIdx, TComMv& rcMv )
+{
+  const TEncPic* pcEPic = dynamic_cast<const TEncPic*>( pcCU->getPic() );
+  if ( pcEPic == NULL || !pcEPic->getCoarseMvValid() )
+  {
+    return false;
+  }
+
+  const Int iCurrPOC   = pcCU->getSlice()->getPOC();
+  const Int iCoarseDist = iCurrPOC - pcEPic->getCoarseMvRefPOC();
+  const Int iRefDist    = iCurrPOC - pcCU->getSlice()->getRefPOC( eRefPicList, iRefIdx );
+  if ( iCoarseDist == 0 || iRefDist == 0 )
+  {
+    return false;
+  }
+
+  // motion vector at the centre of the PU, assuming linear motion for references at other distances
+  const UInt   uiPelX = pcCU->getCUPelX() + g_auiRasterToPelX[ g_auiZscanToRaster[uiPartAddr] ] + (iRoiWidth  >> 1);
+  const UInt   uiPelY = pcCU->getCUPelY() + g_auiRasterToPelY[ g_auiZscanToRaster[uiPartAddr] ] + (iRoiHeight >> 1);
+  const TComMv cCoarseMv = pcEPic->getCoarseMv( uiPelX, uiPelY );
+
+  const Int iHor = cCoarseMv.getHor() * iRefDist;
+  const Int iVer = cCoarseMv.getVer() * iRefDist;
+  rcMv.set( (iHor + (iHor < 0 ? -(abs(iCoarseDist)>>1) : (abs(iCoarseDist)>>1))) / iCoarseDist,
+            (iVer + (iVer < 0 ? -(abs(iCoarseDist)>>1) : (abs(iCoarseDist)>>1))) / iCoarseDist );
+  return true;
+}
+
+
+/** Select how the integer motion search of a PU uses the SAD tree
+ * The 2Nx2N search of a CU records the distortion of each of its SADTREE_GRID_SIZE x SADTREE_GRID_SIZE sub-blocks for every visited
+ * position; the searches of the other partition shapes of the same CU then sum the sub-blocks covered by the PU instead of
+ * recomputing the distortion. The cache is reset (by bumping its generation) whenever the 2Nx2N search of a new CU starts.
+ * \param pcCU        CU containing the PU
+ * \param uiPartAddr  Z-order offset of the PU inside the CU
+ * \param iRoiWidth   PU width
+ * \param iRoiHeight  PU height
+ * \param eRefPicList Reference picture list
+ * \param iRefIdx     Reference index
+ */
+Void TEncSearch::xSetSADTreeMode( const TComDataCU* const pcCU, const UInt uiPartAddr, const Int iRoiWidth, const Int iRoiHeight,
+                                  const RefPicList eRefPicList, const Int iRefIdx )
+{
+  m_eSADTreeMode = SADTREE_OFF;
+  if ( m_pcSADTreeCache == NULL || m_cDistParam.bApplyWeight )
+  {
+    return;
+  }
+
+  const Bool bSameCU = m_uiSADTreeCtuRsAddr == pcCU->getCtuRsAddr() && m_uiSADTreeZorderIdx == pcCU->getZorderIdxInCtu()
+                    && m_uiSADTreeDepth == pcCU->getDepth(0) && m_iSADTreePOC == pcCU->getSlice()->getPOC();
+
+  m_iSADTreeRefList = Int(eRefPicList);
+  m_iSADTreeRefIdx  = iRefIdx;
+
+  if ( pcCU->getPartitionSize(0) == SIZE_2Nx2N )
+  {
+    if ( !bSameCU )
+    {
+      m_uiSADTreeGeneration++;
+      m_uiSADTreeCtuRsAddr = pcCU->getCtuRsAddr();
+      m_uiSADTreeZorderIdx = pcCU->getZorderIdxInCtu();
+      m_uiSADTreeDepth     = pcCU->getDepth(0);
+      m_iSADTreePOC        = pcCU->getSlice()->getPOC();
+    }
+    m_iSADTreeSubSize   = pcCU->getWidth(0) / SADTREE_GRID_SIZE;
+    // the SAD metric is only used for the 12/24/48 wide AMP partitions
+    m_bSADTreeRecordSAD = pcCU->getSlice()->getSPS()->getUseAMP() && pcCU->getWidth(0) >= 16;
+    m_eSADTreeMode      = SADTREE_RECORD;
+  }
+  else if ( bSameCU && m_iSADTreeSubSize == pcCU->getWidth(0) / SADTREE_GRID_SIZE )
+  {
+    const Int iPUX = g_auiRasterToPelX[ g_auiZscanToRaster[uiPartAddr] ];
+    const Int iPUY = g_auiRasterToPelY[ g_auiZscanToRaster[uiPartAddr] ];
+    if ( ( (iPUX | iPUY | iRoiWidth | iRoiHeight) % m_iSADTreeSubSize ) != 0 )
+    {
+      return;
+    }
+    m_iSADTreePUX0 = iPUX / m_iSADTreeSubSize;
+    m_iSADTreePUY0 = iPUY / m_iSADTreeSubSize;
+    m_iSADTreePUX1 = ( iPUX + iRoiWidth  ) / m_iSADTreeSubSize;
+    m_iSADTreePUY1 = ( iPUY + iRoiHeight ) / m_iSADTreeSubSize;
+    m_eSADTreeMode = SADTREE_QUERY;
+  }
+}
+
+
+static inline UInt getSADTreeCacheIdx( const Int iSearchX, const Int iSearchY, const Int iRefList, const Int iRefIdx )
+{
+  const Int iMask = (1 << SADTREE_CACHE_LOG2_SIZE) - 1;
+  return ( ( (iSearchY + iRefIdx * 7 + iRefList * 13) & iMask ) << SADTREE_CACHE_LOG2_SIZE ) | ( iSearchX & iMask );
+}
+
+
+/** Compute the distortion of the 2Nx2N block at an integer search position and store it per sub-block in the SAD tree
+ * \returns the distortion of the whole block, identical to the one of the SSE function used by the integer search
+ */
+Distortion TEncSearch::xSADTreeRecord( const TComPattern* const pcPatternKey, const Pel* const piRefSrch, const Int iRefStride,
+                                       const Int iSearchX, const Int iSearchY )
+{
+  SADTreeEntry& rcEntry = m_pcSADTreeCache[ getSADTreeCacheIdx( iSearchX, iSearchY, m_iSADTreeRefList, m_iSADTreeRefIdx ) ];
+
+  const Pel* piOrg      = pcPatternKey->getROIY();
+  const Pel* piCur      = piRefSrch;
+  const Int  iStrideOrg = pcPatternKey->getPatternLStride();
+  const Int  iSubSize   = m_iSADTreeSubSize;
+  const UInt uiShift    = DISTORTION_PRECISION_ADJUSTMENT((pcPatternKey->getBitDepthY()-8) << 1);
+
+  Distortion uiSum = 0;
+  for ( Int iSubY = 0; iSubY < SADTREE_GRID_SIZE; iSubY++ )
+  {
+    Distortion* puiSSE     = rcEntry.auiSSE     + iSubY * SADTREE_GRID_SIZE;
+    Distortion* puiSADEven = rcEntry.auiSADEven + iSubY * SADTREE_GRID_SIZE;
+    Distortion* puiSADOdd  = rcEntry.auiSADOdd  + iSubY * SADTREE_GRID_SIZE;
+    for ( Int iSubX = 0; iSubX < SADTREE_GRID_SIZE; iSubX++ )
+    {
+      puiSSE[iSubX] = puiSADEven[iSubX] = puiSADOdd[iSubX] = 0;
+    }
+
+    for ( Int y = 0; y < iSubSize; y++ )
+    {
+      Distortion* puiSAD = (y & 1) ? puiSADOdd : puiSADEven;
+      for ( Int iSubX = 0; iSubX < SADTREE_GRID_SIZE; iSubX++ )
+      {
+        const Pel* const pO = piOrg + iSubX * iSubSize;
+        const Pel* const pC = piCur + iSubX * iSubSize;
+        Distortion uiSSE = 0;
+        Distortion uiSAD = 0;
+        for ( Int x = 0; x < iSubSize; x++ )
+        {
+          const Intermediate_Int iTemp = pO[x] - pC[x];
+          uiSSE += Distortion(( iTemp * iTemp ) >> uiShift);
+          uiSAD += abs( iTemp );
+        }
+        puiSSE[iSubX] += uiSSE;
+        if ( m_bSADTreeRecordSAD )
+        {
+          puiSAD[iSubX] += uiSAD;
+        }
+      }
+      piOrg += iStrideOrg;
+      piCur += iRefStride;
+    }
+
+    for ( Int iSubX = 0; iSubX < SADTREE_GRID_SIZE; iSubX++ )
+    {
+      uiSum += puiSSE[iSubX];
+    }
+  }
+
+  rcEntry.uiGeneration = m_uiSADTreeGeneration;
+  rcEntry.iMvX         = iSearchX;
+  rcEntry.iMvY         = iSearchY;
+  rcEntry.iRefList     = m_iSADTreeRefList;
+  rcEntry.iRefIdx      = m_iSADTreeRefIdx;
+
+  return uiSum;
+}
+
+
+/** Look up the distortion of the current PU at an integer search position in the SAD tree
+ * Uses the same metric as the distortion function selected by setDistParam() for the PU (SSE, or SAD for the 12/24/48 wide
+ * AMP partitions, with row subsampling when enabled).
+ * \returns true if the position was visited by the 2Nx2N search of the CU
+ */
+Bool TEncSearch::xSADTreeQuery( const Int iSearchX, const Int iSearchY, Distortion& ruiDist )
+{
+  const SADTreeEntry& rcEntry = m_pcSADTreeCache[ getSADTreeCacheIdx( iSearchX, iSearchY, m_iSADTreeRefList, m_iSADTreeRefIdx ) ];
+  if ( rcEntry.uiGeneration != m_uiSADTreeGeneration || rcEntry.iMvX != iSearchX || rcEntry.iMvY != iSearchY
+    || rcEntry.iRefList != m_iSADTreeRefList || rcEntry.iRefIdx != m_iSADTreeRefIdx )
+  {
+    return false;
+  }
+
+  const Int  iCols = m_cDistParam.iCols;
+  const Bool bSAD  = iCols == 12 || iCols == 24 || iCols == 48;
+  if ( bSAD && !m_bSADTreeRecordSAD )
+  {
+    return false;
+  }
+
+  Distortion uiSum = 0;
+  for ( Int iSubY = m_iSADTreePUY0; iSubY < m_iSADTreePUY1; iSubY++ )
+  {
+    for ( Int iSubX = m_iSADTreePUX0; iSubX < m_iSADTreePUX1; iSubX++ )
+    {
+      const Int iIdx = iSubY * SADTREE_GRID_SIZE + iSubX;
+      if ( !bSAD )
+      {
+        uiSum += rcEntry.auiSSE[iIdx];
+      }
+      else if ( m_cDistParam.iSubShift == 0 )
+      {
+        uiSum += rcEntry.auiSADEven[iIdx] + rcEntry.auiSADOdd[iIdx];
+      }
+      else
+      {
+        uiSum += rcEntry.auiSADEven[iIdx];
+      }
+    }
+  }
+
+  if ( bSAD )
+  {
+    uiSum <<= m_cDistParam.iSubShift;
+    uiSum >>= DISTORTION_PRECISION_ADJUSTMENT(m_cDistParam.bitDepth-8);
+  }
+  ruiDist = uiSum;
+  return true;
+}
+
+
 Void TEncSearch::xSetSearchRange ( const TComDataCU* const pcCU, const TComMv& cMvPred, const Int iSrchRng,
                                    TComMv& rcMvSrchRngLT, TComMv& rcMvSrchRngRB )
 {
@@ -4630,7 +5377,10 @@ Void TEncSearch::xPatternSearch(const TComPattern* const pcPatternKey,
 	const TComMv* const      pcMvSrchRngLT,
 	const TComMv* const      pcMvSrchRngRB,
 	TComMv&      rcMv,
-	Distortion&  ruiSAD)
+	Distortion&  ruiSAD,
+	const TEncPic* const     pcSEARef,
+	const Int                iPelX,
+	const Int                iPelY)
 {
 	Int   iSrchRngHorLeft = pcMvSrchRngLT->getHor();
 	Int   iSrchRngHorRight = pcMvSrchRngRB->getHor();
@@ -4654,12 +5404,63 @@ Void TEncSearch::xPatternSearch(const TComPattern* const pcPatternKey,
 		}
 	}
 
+	// successive elimination: the block sums of the reference bound the distortion of a candidate from below, so candidates
+	// whose bound plus motion cost cannot beat the best cost are skipped without changing the search result.
+	// The bounds are exact only for unweighted, unshifted and non-subsampled distortions.
+	const Bool bSSE = (m_cDistParam.iCols != 12 && m_cDistParam.iCols != 24 && m_cDistParam.iCols != 48);
+	const Bool bUseSEA = pcSEARef != NULL && pcSEARef->getRecIntegralValid() && !m_cDistParam.bApplyWeight
+	                  && (bSSE ? DISTORTION_PRECISION_ADJUSTMENT((pcPatternKey->getBitDepthY() - 8) << 1) == 0
+	                           : (m_cDistParam.iSubShift == 0 && DISTORTION_PRECISION_ADJUSTMENT(pcPatternKey->getBitDepthY() - 8) == 0));
+	const Int64  iNumPels = Int64(m_cDistParam.iCols) * m_cDistParam.iRows;
+	Int64        iOrgSum = 0;
+	Int64        iOrgSumSq = 0;
+	Double       dOrgNorm = 0;
+	if (bUseSEA)
+	{
+		const Pel* piOrg = m_cDistParam.pOrg;
+		for (Int y = 0; y < m_cDistParam.iRows; y++)
+		{
+			for (Int x = 0; x < m_cDistParam.iCols; x++)
+			{
+				iOrgSum += piOrg[x];
+				iOrgSumSq += Int64(piOrg[x]) * piOrg[x];
+			}
+			piOrg += m_cDistParam.iStrideOrg;
+		}
+		dOrgNorm = sqrt(Double(iOrgSumSq));
+	}
+
 	piRefY += (iSrchRngVerTop * iRefStride);
 
 	for (Int y = iSrchRngVerTop; y <= iSrchRngVerBottom; y++)
 	{
 		for (Int x = iSrchRngHorLeft; x <= iSrchRngHorRight; x++)
 		{
+			if (bUseSEA)
+			{
+				UInt   uiRefSum;
+				UInt64 uiRefSumSq;
+				pcSEARef->getRecBlockSums(iPelX + x, iPelY + y, m_cDistParam.iCols, m_cDistParam.iRows, uiRefSum, uiRefSumSq);
+				const Int64 iDiff = iOrgSum - Int64(uiRefSum);
+				Distortion  uiBound;
+				if (bSSE)
+				{
+					// Cauchy-Schwarz on the mean difference and the triangle inequality on the block norms,
+					// the latter lowered by one to absorb the floating point rounding
+					const Double dNormDiff = dOrgNorm - sqrt(Double(uiRefSumSq));
+					const Int64  iNormBound = Int64(dNormDiff * dNormDiff) - 1;
+					uiBound = Distortion(std::max<Int64>(iDiff * iDiff / iNumPels, iNormBound));
+				}
+				else
+				{
+					uiBound = Distortion(iDiff < 0 ? -iDiff : iDiff);
+				}
+				if (uiBound + m_pcRdCost->getCostOfVectorWithPredictor(x, y) >= uiSadBest)
+				{
+					continue;
+				}
+			}
+
 			//  find min. distortion position
 			m_cDistParam.pCur = piRefY + x;
 
@@ -4703,7 +5504,8 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
                                      const TComMv* const      pcMvSrchRngRB,
                                      TComMv&                  rcMv,
                                      Distortion&              ruiSAD,
-                                     const TComMv* const      pIntegerMv2Nx2NPred )
+                                     const TComMv* const      pIntegerMv2Nx2NPred,
+                                     const TComMv* const      pPyramidMvPred )
 {
   assert (MD_LEFT < NUM_MV_PREDICTORS);
   pcCU->getMvPredLeft       ( m_acMvPredictors[MD_LEFT] );
@@ -4715,16 +5517,16 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
   switch ( m_motionEstimationSearchMethod )
   {
     case MESEARCH_DIAMOND:
-      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, false );
+      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, pPyramidMvPred, false );
 	     
       break;
 
     case MESEARCH_SELECTIVE:
-      xTZSearchSelective( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred );
+      xTZSearchSelective( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, pPyramidMvPred );
       break;
 
     case MESEARCH_DIAMOND_ENHANCED:
-      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, true );
+      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, pPyramidMvPred, true );
       break;
 
     case MESEARCH_FULL: // shouldn't get here.
@@ -4743,6 +5545,7 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
                             TComMv&                  rcMv,
                             Distortion&              ruiSAD,
                             const TComMv* const      pIntegerMv2Nx2NPred,
+                            const TComMv* const      pPyramidMvPred,
                             const Bool               bExtendedSettings)
 {
   const Bool bUseAdaptiveRaster                      = bExtendedSettings;
@@ -4755,7 +5558,7 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
   const Bool bFirstCornersForDiamondDist1            = bExtendedSettings;
   const Bool bFirstSearchStop                        = m_pcEncCfg->getFastMEAssumingSmootherMVEnabled();
   const UInt uiFirstSearchRounds                     = 3;     // first search stop X rounds after best match (must be >=1)
-  const Bool bEnableRasterSearch                     = true;
+  const Bool bEnableRasterSearch                     = (pPyramidMvPred == 0); // the pre-analysis candidate replaces the raster search
   const Bool bAlwaysRasterSearch                     = bExtendedSettings;  // true: BETTER but factor 2 slower
   const Bool bRasterRefinementEnable                 = false; // enable either raster refinement or star refinement
   const Bool bRasterRefinementDiamond                = false; // 1 = xTZ8PointDiamondSearch   0 = xTZ8PointSquareSearch
@@ -4849,6 +5652,24 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
     iSrchRngVerBottom = cMvSrchRngRB.getVer();
   }
 
+  if (pPyramidMvPred != 0)
+  {
+    TComMv pyramidMvPred = *pPyramidMvPred;
+    pyramidMvPred <<= 2;
+    pcCU->clipMv( pyramidMvPred );
+#if ME_ENABLE_ROUNDING_OF_MVS
+    pyramidMvPred.divideByPowerOf2(2);
+#else
+    pyramidMvPred >>= 2;
+#endif
+    if ((rcMv != pyramidMvPred) &&
+        (pyramidMvPred.getHor() != cStruct.iBestX || pyramidMvPred.getVer() != cStruct.iBestY))
+    {
+      // only test pyramidMvPred if not obviously previously tested.
+      xTZSearchHelp(pcPatternKey, cStruct, pyramidMvPred.getHor(), pyramidMvPred.getVer(), 0, 0);
+    }
+  }
+
   // start search
   Int  iDist = 0;
   Int  iStartX = cStruct.iBestX;
@@ -4923,7 +5744,7 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
   }
 
   // raster search if distance is too big
-  if (bUseAdaptiveRaster)
+  if (bUseAdaptiveRaster && bEnableRasterSearch)
   {
     int iWindowSize = iRaster;
     Int   iSrchRngRasterLeft   = iSrchRngHorLeft;
@@ -5059,11 +5880,12 @@ Void TEncSearch::xTZSearchSelective( const TComDataCU* const   pcCU,
                                      const TComMv* const       pcMvSrchRngRB,
                                      TComMv                   &rcMv,
                                      Distortion               &ruiSAD,
-                                     const TComMv* const       pIntegerMv2Nx2NPred )
+                                     const TComMv* const       pIntegerMv2Nx2NPred,
+                                     const TComMv* const       pPyramidMvPred )
 {
   const Bool bTestOtherPredictedMV    = true;
   const Bool bTestZeroVector          = true;
-  const Bool bEnableRasterSearch      = true;
+  const Bool bEnableRasterSearch      = (pPyramidMvPred == 0); // the pre-analysis candidate replaces the raster search
   const Bool bAlwaysRasterSearch      = false;  // 1: BETTER but factor 15x slower
   const Bool bStarRefinementEnable    = true;   // enable either star refinement or raster refinement
   const Bool bStarRefinementDiamond   = true;   // 1 = xTZ8PointDiamondSearch   0 = xTZ8PointSquareSearch
@@ -5128,6 +5950,19 @@ Void TEncSearch::xTZSearchSelective( const TComDataCU* const   pcCU,
     xTZSearchHelp( pcPatternKey, cStruct, 0, 0, 0, 0 );
   }
 
+  if ( pPyramidMvPred != 0 )
+  {
+    TComMv pyramidMvPred = *pPyramidMvPred;
+    pyramidMvPred <<= 2;
+    pcCU->clipMv( pyramidMvPred );
+#if ME_ENABLE_ROUNDING_OF_MVS
+    pyramidMvPred.divideByPowerOf2(2);
+#else
+    pyramidMvPred >>= 2;
+#endif
+    xTZSearchHelp( pcPatternKey, cStruct, pyramidMvPred.getHor(), pyramidMvPred.getVer(), 0, 0 );
+  }
+
   if ( pIntegerMv2Nx2NPred != 0 )
   {
     TComMv integerMv2Nx2NPred = *pIntegerMv2Nx2NPred;
@@ -5337,48 +6172,55 @@ Void TEncSearch::encodeResAndCalcRdInterCU( TComDataCU* pcCU, TComYuv* pcYuvOrg,
 
   TComTURecurse tuLevel0(pcCU, 0);
 
-  Double     nonZeroCost       = 0;
-  UInt       nonZeroBits       = 0;
-  Distortion nonZeroDistortion = 0;
-  Distortion zeroDistortion    = 0;
+  // an identical residual already tested for this CU (e.g. by another merge candidate or partitioning) gives the same decision
+  UInt64     residualHash      = 0;
+  const Bool bCachedResidual   = xLookupResidualCache( pcCU, pcYuvResi, pcYuvResiBest, residualHash );
 
-  m_pcRDGoOnSbacCoder->load( m_pppcRDSbacCoder[ pcCU->getDepth( 0 ) ][ CI_CURR_BEST ] );
+  if ( !bCachedResidual )
+  {
+    Double     nonZeroCost       = 0;
+    UInt       nonZeroBits       = 0;
+    Distortion nonZeroDistortion = 0;
+    Distortion zeroDistortion    = 0;
 
-  xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, tuLevel0 DEBUG_STRING_PASS_INTO(sDebug) );
+    m_pcRDGoOnSbacCoder->load( m_pppcRDSbacCoder[ pcCU->getDepth( 0 ) ][ CI_CURR_BEST ] );
 
-  // -------------------------------------------------------
-  // set the coefficients in the pcCU, and also calculates the residual data.
-  // If a block full of 0's is efficient, then just use 0's.
-  // The costs at this point do not include header bits.
+    xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, tuLevel0 DEBUG_STRING_PASS_INTO(sDebug) );
 
-  m_pcEntropyCoder->resetBits();
-  m_pcEntropyCoder->encodeQtRootCbfZero( );
-  const UInt   zeroResiBits = m_pcEntropyCoder->getNumberOfWrittenBits();
-  const Double zeroCost     = (pcCU->isLosslessCoded( 0 )) ? (nonZeroCost+1) : (m_pcRdCost->calcRdCost( zeroResiBits, zeroDistortion ));
+    // -------------------------------------------------------
+    // set the coefficients in the pcCU, and also calculates the residual data.
+    // If a block full of 0's is efficient, then just use 0's.
+    // The costs at this point do not include header bits.
 
-  if ( zeroCost < nonZeroCost || !pcCU->getQtRootCbf(0) )
-  {
-    const UInt uiQPartNum = tuLevel0.GetAbsPartIdxNumParts();
-    ::memset( pcCU->getTransformIdx()     , 0, uiQPartNum * sizeof(UChar) );
-    for (Int comp=0; comp < numValidComponents; comp++)
+    m_pcEntropyCoder->resetBits();
+    m_pcEntropyCoder->encodeQtRootCbfZero( );
+    const UInt   zeroResiBits = m_pcEntropyCoder->getNumberOfWrittenBits();
+    const Double zeroCost     = (pcCU->isLosslessCoded( 0 )) ? (nonZeroCost+1) : (m_pcRdCost->calcRdCost( zeroResiBits, zeroDistortion ));
+
+    if ( zeroCost < nonZeroCost || !pcCU->getQtRootCbf(0) )
     {
-      const ComponentID component = ComponentID(comp);
-      ::memset( pcCU->getCbf( component ) , 0, uiQPartNum * sizeof(UChar) );
-      ::memset( pcCU->getCrossComponentPredictionAlpha(component), 0, ( uiQPartNum * sizeof(SChar) ) );
-    }
-    static const UInt useTS[MAX_NUM_COMPONENT]={0,0,0};
-    pcCU->setTransformSkipSubParts ( useTS, 0, pcCU->getDepth(0) );
+      const UInt uiQPartNum = tuLevel0.GetAbsPartIdxNumParts();
+      ::memset( pcCU->getTransformIdx()     , 0, uiQPartNum * sizeof(UChar) );
+      for (Int comp=0; comp < numValidComponents; comp++)
+      {
+        const ComponentID component = ComponentID(comp);
+        ::memset( pcCU->getCbf( component ) , 0, uiQPartNum * sizeof(UChar) );
+        ::memset( pcCU->getCrossComponentPredictionAlpha(component), 0, ( uiQPartNum * sizeof(SChar) ) );
+      }
+      static const UInt useTS[MAX_NUM_COMPONENT]={0,0,0};
+      pcCU->setTransformSkipSubParts ( useTS, 0, pcCU->getDepth(0) );
 #if DEBUG_STRING
-    sDebug.clear();
-    for(UInt i=0; i<MAX_NUM_COMPONENT+1; i++)
+      sDebug.clear();
+      for(UInt i=0; i<MAX_NUM_COMPONENT+1; i++)
+      {
+        sDebug+=debug_reorder_data_inter_token[i];
+      }
+#endif
+    }
+    else
     {
-      sDebug+=debug_reorder_data_inter_token[i];
+      xSetInterResidualQTData( NULL, false, tuLevel0); // Call first time to set coefficients.
     }
-#endif
-  }
-  else
-  {
-    xSetInterResidualQTData( NULL, false, tuLevel0); // Call first time to set coefficients.
   }
 
   // all decisions now made. Fully encode the CU, including the headers:
@@ -5392,12 +6234,17 @@ Void TEncSearch::encodeResAndCalcRdInterCU( TComDataCU* pcCU, TComYuv* pcYuvOrg,
   {
     pcYuvResiBest->clear(); // Clear the residual image, if we didn't code it.
   }
-  else
+  else if ( !bCachedResidual )
   {
     xSetInterResidualQTData( pcYuvResiBest, true, tuLevel0 ); // else set the residual image data pcYUVResiBest from the various temp images.
   }
   m_pcRDGoOnSbacCoder->store( m_pppcRDSbacCoder[ pcCU->getDepth( 0 ) ][ CI_TEMP_BEST ] );
 
+  if ( !bCachedResidual )
+  {
+    xStoreResidualCache( pcCU, pcYuvResi, pcYuvResiBest, residualHash );
+  }
+
   pcYuvRec->addClip ( pcYuvPred, pcYuvResiBest, 0, cuWidthPixels, sps.getBitDepths() );
 
   // update with clipped distortion and cost (previously unclipped reconstruction values were used)
@@ -5491,6 +6338,7 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
     }
 
     Pel crossCPredictedResidualBuffer[ MAX_TU_SIZE * MAX_TU_SIZE ];
+    Bool bChromaBitsEstimated = false;
 
     for(UInt i=0; i<numValidComp; i++)
     {
@@ -5570,9 +6418,14 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
               pcCU->setTransformSkipPartRange(transformSkipModeId, compID, subTUAbsPartIdx, partIdxesPerSubTU);
               pcCU->setCrossComponentPredictionAlphaPartRange((bUseCrossCPrediction ? preCalcAlpha : 0), compID, subTUAbsPartIdx, partIdxesPerSubTU );
 
-              if ((compID != COMPONENT_Cr) && ((transformSkipModeId == 1) ? m_pcEncCfg->getUseRDOQTS() : m_pcEncCfg->getUseRDOQ()))
+              const Bool bZeroBlock = (transformSkipModeId == 0) && !bUseCrossCPrediction
+                                   && xIsZeroBlock(TUIterator, compID, pcResi->getAddrPix(compID, tuCompRect.x0, tuCompRect.y0), pcResi->getStride(compID), cQP);
+
+              // Cr reuses the chroma estimate made for Cb, unless a zero block let Cb skip it
+              if (!bZeroBlock && ((compID != COMPONENT_Cr) || !bChromaBitsEstimated) && ((transformSkipModeId == 1) ? m_pcEncCfg->getUseRDOQTS() : m_pcEncCfg->getUseRDOQ()))
               {
                 m_pcEntropyCoder->estimateBit(m_pcTrQuant->m_pcEstBitsSbac, tuCompRect.width, tuCompRect.height, toChannelType(compID));
+                bChromaBitsEstimated = bChromaBitsEstimated || isChroma(compID);
               }
 
 #if RDOQ_CHROMA_LAMBDA
@@ -5628,6 +6481,14 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
 #endif
                                           currAbsSum, cQP);
               }
+              else if (bZeroBlock)
+              {
+                m_pcTrQuant->setZeroBlock(TUIterator, compID, currentCoefficients,
+#if ADAPTIVE_QP_SELECTION
+                                          currentARLCoefficients,
+#endif
+                                          currAbsSum);
+              }
               else
               {
                 m_pcTrQuant->transformNxN(TUIterator, compID, pcResi->getAddrPix( compID, tuCompRect.x0, tuCompRect.y0 ), pcResi->getStride(compID), currentCoefficients,
@@ -6325,8 +7186,10 @@ Void  TEncSearch::xAddSymbolBitsInter( TComDataCU* pcCU, UInt& ruiBits )
 /**
  * \brief Generate half-sample interpolated block
  *
+ * The horizontal and vertical passes are fused and run strip by strip, see
+ * TComInterpolationFilter::filterSeparableStrips.
+ *
  * \param pattern Reference picture ROI
- * \param biPred    Flag indicating whether block is for biprediction
  */
 Void TEncSearch::xExtDIFUpSamplingH( TComPattern* pattern )
 {
@@ -6336,32 +7199,29 @@ Void TEncSearch::xExtDIFUpSamplingH( TComPattern* pattern )
 
   Int intStride = m_filteredBlockTmp[0].getStride(COMPONENT_Y);
   Int dstStride = m_filteredBlock[0][0].getStride(COMPONENT_Y);
-  Pel *intPtr;
-  Pel *dstPtr;
+  Pel *intPtr0  = m_filteredBlockTmp[0].getAddr(COMPONENT_Y);
+  Pel *intPtr2  = m_filteredBlockTmp[2].getAddr(COMPONENT_Y);
   Int filterSize = NTAPS_LUMA;
   Int halfFilterSize = (filterSize>>1);
   Pel *srcPtr = pattern->getROIY() - halfFilterSize*srcStride - 1;
 
   const ChromaFormat chFmt = m_filteredBlock[0][0].getChromaFormat();
 
-  m_if.filterHor(COMPONENT_Y, srcPtr, srcStride, m_filteredBlockTmp[0].getAddr(COMPONENT_Y), intStride, width+1, height+filterSize, 0, false, chFmt, pattern->getBitDepthY());
-  m_if.filterHor(COMPONENT_Y, srcPtr, srcStride, m_filteredBlockTmp[2].getAddr(COMPONENT_Y), intStride, width+1, height+filterSize, 2, false, chFmt, pattern->getBitDepthY());
-
-  intPtr = m_filteredBlockTmp[0].getAddr(COMPONENT_Y) + halfFilterSize * intStride + 1;
-  dstPtr = m_filteredBlock[0][0].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width+0, height+0, 0, false, true, chFmt, pattern->getBitDepthY());
-
-  intPtr = m_filteredBlockTmp[0].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride + 1;
-  dstPtr = m_filteredBlock[2][0].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width+0, height+1, 2, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass horPasses[2] =
+  {
+    { srcPtr, srcStride, intPtr0, intStride, width+1, height+filterSize, 0 },
+    { srcPtr, srcStride, intPtr2, intStride, width+1, height+filterSize, 2 }
+  };
 
-  intPtr = m_filteredBlockTmp[2].getAddr(COMPONENT_Y) + halfFilterSize * intStride;
-  dstPtr = m_filteredBlock[0][2].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width+1, height+0, 0, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass verPasses[4] =
+  {
+    { intPtr0 + halfFilterSize     * intStride + 1, intStride, m_filteredBlock[0][0].getAddr(COMPONENT_Y), dstStride, width+0, height+0, 0 },
+    { intPtr0 + (halfFilterSize-1) * intStride + 1, intStride, m_filteredBlock[2][0].getAddr(COMPONENT_Y), dstStride, width+0, height+1, 2 },
+    { intPtr2 + halfFilterSize     * intStride,     intStride, m_filteredBlock[0][2].getAddr(COMPONENT_Y), dstStride, width+1, height+0, 0 },
+    { intPtr2 + (halfFilterSize-1) * intStride,     intStride, m_filteredBlock[2][2].getAddr(COMPONENT_Y), dstStride, width+1, height+1, 2 }
+  };
 
-  intPtr = m_filteredBlockTmp[2].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-  dstPtr = m_filteredBlock[2][2].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width+1, height+1, 2, false, true, chFmt, pattern->getBitDepthY());
+  m_if.filterSeparableStrips(COMPONENT_Y, horPasses, 2, verPasses, 4, chFmt, pattern->getBitDepthY());
 }
 
 
@@ -6371,9 +7231,12 @@ Void TEncSearch::xExtDIFUpSamplingH( TComPattern* pattern )
 /**
  * \brief Generate quarter-sample interpolated blocks
  *
+ * The horizontal quarter-sample passes are fused with the vertical passes and run strip by strip, see
+ * TComInterpolationFilter::filterSeparableStrips. The half-sample intermediate planes are reused from
+ * xExtDIFUpSamplingH.
+ *
  * \param pattern    Reference picture ROI
  * \param halfPelRef Half-pel mv
- * \param biPred     Flag indicating whether block is for biprediction
  */
 Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
 {
@@ -6385,7 +7248,6 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
   Int intStride = m_filteredBlockTmp[0].getStride(COMPONENT_Y);
   Int dstStride = m_filteredBlock[0][0].getStride(COMPONENT_Y);
   Pel *intPtr;
-  Pel *dstPtr;
   Int filterSize = NTAPS_LUMA;
 
   Int halfFilterSize = (filterSize>>1);
@@ -6394,9 +7256,12 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
 
   const ChromaFormat chFmt = m_filteredBlock[0][0].getChromaFormat();
 
+  TComInterpolationPass horPasses[2];
+  TComInterpolationPass verPasses[8];
+  Int numVerPasses = 0;
+
   // Horizontal filter 1/4
   srcPtr = pattern->getROIY() - halfFilterSize * srcStride - 1;
-  intPtr = m_filteredBlockTmp[1].getAddr(COMPONENT_Y);
   if (halfPelRef.getVer() > 0)
   {
     srcPtr += srcStride;
@@ -6405,11 +7270,11 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
   {
     srcPtr += 1;
   }
-  m_if.filterHor(COMPONENT_Y, srcPtr, srcStride, intPtr, intStride, width, extHeight, 1, false, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass horQ1 = { srcPtr, srcStride, m_filteredBlockTmp[1].getAddr(COMPONENT_Y), intStride, width, extHeight, 1 };
+  horPasses[0] = horQ1;
 
   // Horizontal filter 3/4
   srcPtr = pattern->getROIY() - halfFilterSize*srcStride - 1;
-  intPtr = m_filteredBlockTmp[3].getAddr(COMPONENT_Y);
   if (halfPelRef.getVer() > 0)
   {
     srcPtr += srcStride;
@@ -6418,60 +7283,52 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
   {
     srcPtr += 1;
   }
-  m_if.filterHor(COMPONENT_Y, srcPtr, srcStride, intPtr, intStride, width, extHeight, 3, false, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass horQ3 = { srcPtr, srcStride, m_filteredBlockTmp[3].getAddr(COMPONENT_Y), intStride, width, extHeight, 3 };
+  horPasses[1] = horQ3;
 
   // Generate @ 1,1
   intPtr = m_filteredBlockTmp[1].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-  dstPtr = m_filteredBlock[1][1].getAddr(COMPONENT_Y);
   if (halfPelRef.getVer() == 0)
   {
     intPtr += intStride;
   }
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 1, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass ver11 = { intPtr, intStride, m_filteredBlock[1][1].getAddr(COMPONENT_Y), dstStride, width, height, 1 };
+  verPasses[numVerPasses++] = ver11;
 
   // Generate @ 3,1
   intPtr = m_filteredBlockTmp[1].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-  dstPtr = m_filteredBlock[3][1].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 3, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass ver31 = { intPtr, intStride, m_filteredBlock[3][1].getAddr(COMPONENT_Y), dstStride, width, height, 3 };
+  verPasses[numVerPasses++] = ver31;
 
   if (halfPelRef.getVer() != 0)
   {
     // Generate @ 2,1
     intPtr = m_filteredBlockTmp[1].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-    dstPtr = m_filteredBlock[2][1].getAddr(COMPONENT_Y);
-    if (halfPelRef.getVer() == 0)
-    {
-      intPtr += intStride;
-    }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 2, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver21 = { intPtr, intStride, m_filteredBlock[2][1].getAddr(COMPONENT_Y), dstStride, width, height, 2 };
+    verPasses[numVerPasses++] = ver21;
 
     // Generate @ 2,3
     intPtr = m_filteredBlockTmp[3].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-    dstPtr = m_filteredBlock[2][3].getAddr(COMPONENT_Y);
-    if (halfPelRef.getVer() == 0)
-    {
-      intPtr += intStride;
-    }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 2, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver23 = { intPtr, intStride, m_filteredBlock[2][3].getAddr(COMPONENT_Y), dstStride, width, height, 2 };
+    verPasses[numVerPasses++] = ver23;
   }
   else
   {
     // Generate @ 0,1
     intPtr = m_filteredBlockTmp[1].getAddr(COMPONENT_Y) + halfFilterSize * intStride;
-    dstPtr = m_filteredBlock[0][1].getAddr(COMPONENT_Y);
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 0, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver01 = { intPtr, intStride, m_filteredBlock[0][1].getAddr(COMPONENT_Y), dstStride, width, height, 0 };
+    verPasses[numVerPasses++] = ver01;
 
     // Generate @ 0,3
     intPtr = m_filteredBlockTmp[3].getAddr(COMPONENT_Y) + halfFilterSize * intStride;
-    dstPtr = m_filteredBlock[0][3].getAddr(COMPONENT_Y);
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 0, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver03 = { intPtr, intStride, m_filteredBlock[0][3].getAddr(COMPONENT_Y), dstStride, width, height, 0 };
+    verPasses[numVerPasses++] = ver03;
   }
 
   if (halfPelRef.getHor() != 0)
   {
     // Generate @ 1,2
     intPtr = m_filteredBlockTmp[2].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-    dstPtr = m_filteredBlock[1][2].getAddr(COMPONENT_Y);
     if (halfPelRef.getHor() > 0)
     {
       intPtr += 1;
@@ -6480,11 +7337,11 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
     {
       intPtr += intStride;
     }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 1, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver12 = { intPtr, intStride, m_filteredBlock[1][2].getAddr(COMPONENT_Y), dstStride, width, height, 1 };
+    verPasses[numVerPasses++] = ver12;
 
     // Generate @ 3,2
     intPtr = m_filteredBlockTmp[2].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-    dstPtr = m_filteredBlock[3][2].getAddr(COMPONENT_Y);
     if (halfPelRef.getHor() > 0)
     {
       intPtr += 1;
@@ -6493,42 +7350,45 @@ Void TEncSearch::xExtDIFUpSamplingQ( TComPattern* pattern, TComMv halfPelRef )
     {
       intPtr += intStride;
     }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 3, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver32 = { intPtr, intStride, m_filteredBlock[3][2].getAddr(COMPONENT_Y), dstStride, width, height, 3 };
+    verPasses[numVerPasses++] = ver32;
   }
   else
   {
     // Generate @ 1,0
     intPtr = m_filteredBlockTmp[0].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride + 1;
-    dstPtr = m_filteredBlock[1][0].getAddr(COMPONENT_Y);
     if (halfPelRef.getVer() >= 0)
     {
       intPtr += intStride;
     }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 1, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver10 = { intPtr, intStride, m_filteredBlock[1][0].getAddr(COMPONENT_Y), dstStride, width, height, 1 };
+    verPasses[numVerPasses++] = ver10;
 
     // Generate @ 3,0
     intPtr = m_filteredBlockTmp[0].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride + 1;
-    dstPtr = m_filteredBlock[3][0].getAddr(COMPONENT_Y);
     if (halfPelRef.getVer() > 0)
     {
       intPtr += intStride;
     }
-    m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 3, false, true, chFmt, pattern->getBitDepthY());
+    const TComInterpolationPass ver30 = { intPtr, intStride, m_filteredBlock[3][0].getAddr(COMPONENT_Y), dstStride, width, height, 3 };
+    verPasses[numVerPasses++] = ver30;
   }
 
   // Generate @ 1,3
   intPtr = m_filteredBlockTmp[3].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-  dstPtr = m_filteredBlock[1][3].getAddr(COMPONENT_Y);
   if (halfPelRef.getVer() == 0)
   {
     intPtr += intStride;
   }
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 1, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass ver13 = { intPtr, intStride, m_filteredBlock[1][3].getAddr(COMPONENT_Y), dstStride, width, height, 1 };
+  verPasses[numVerPasses++] = ver13;
 
   // Generate @ 3,3
   intPtr = m_filteredBlockTmp[3].getAddr(COMPONENT_Y) + (halfFilterSize-1) * intStride;
-  dstPtr = m_filteredBlock[3][3].getAddr(COMPONENT_Y);
-  m_if.filterVer(COMPONENT_Y, intPtr, intStride, dstPtr, dstStride, width, height, 3, false, true, chFmt, pattern->getBitDepthY());
+  const TComInterpolationPass ver33 = { intPtr, intStride, m_filteredBlock[3][3].getAddr(COMPONENT_Y), dstStride, width, height, 3 };
+  verPasses[numVerPasses++] = ver33;
+
+  m_if.filterSeparableStrips(COMPONENT_Y, horPasses, 2, verPasses, numVerPasses, chFmt, pattern->getBitDepthY());
 }
 
 
@@ -46,15 +46,19 @@
 #include "TLibCommon/TComTrQuant.h"
 #include "TLibCommon/TComPic.h"
 #include "TLibCommon/TComRectangle.h"
+#include "TLibCommon/TComThreadPool.h"
 #include "TEncEntropy.h"
 #include "TEncSbac.h"
 #include "TEncCfg.h"
 
+#include <atomic>
+
 
 //! \ingroup TLibEncoder
 //! \{
 
 class TEncCu;
+class TEncPic;
 
 // ====================================================================================================================
 // Class definition
@@ -64,6 +68,13 @@ static const UInt MAX_NUM_REF_LIST_ADAPT_SR=2;
 static const UInt MAX_IDX_ADAPT_SR=33;
 static const UInt NUM_MV_PREDICTORS=3;
 
+static const Int  SADTREE_GRID_SIZE=4;                                    ///< sub-blocks per CU side kept by the SAD tree (aligned with all PU boundaries, incl. AMP)
+static const Int  SADTREE_NUM_SUB_BLOCKS=SADTREE_GRID_SIZE*SADTREE_GRID_SIZE;
+static const UInt SADTREE_CACHE_LOG2_SIZE=5;                              ///< SAD tree cache is a direct-mapped (2^n x 2^n) table indexed by integer MV
+static const UInt NUM_NN_ERRORS=8;                                        ///< EMI: integer errors around the best integer position fed to the FME network
+static const UInt NUM_ZERO_BLOCK_SIZES=4;                                 ///< TU sizes counted by the zero-block detection (4x4 to 32x32)
+static const UInt RESIDUAL_CACHE_SIZE=4;                                  ///< residual quadtree decisions kept per CU depth by the inter residual cache
+
 /// encoder search class
 class TEncSearch : public TComPrediction
 {
@@ -117,6 +128,95 @@ protected:
 
   TComMv          m_integerMv2Nx2N[NUM_REF_PIC_LIST_01][MAX_NUM_REF];
 
+  // SAD tree: per sub-block integer ME distortions of the 2Nx2N search, reused by the other partition shapes of the same CU
+  enum SADTreeMode
+  {
+    SADTREE_OFF    = 0,
+    SADTREE_RECORD = 1,
+    SADTREE_QUERY  = 2
+  };
+
+  typedef struct
+  {
+    UInt        uiGeneration;                         ///< entry is valid only if it matches m_uiSADTreeGeneration
+    Int         iMvX;
+    Int         iMvY;
+    Int         iRefList;
+    Int         iRefIdx;
+    Distortion  auiSSE    [SADTREE_NUM_SUB_BLOCKS];
+    Distortion  auiSADEven[SADTREE_NUM_SUB_BLOCKS];   ///< SAD of the even rows of each sub-block (subsampled SAD)
+    Distortion  auiSADOdd [SADTREE_NUM_SUB_BLOCKS];
+  } SADTreeEntry;
+
+  SADTreeEntry*   m_pcSADTreeCache;
+  SADTreeMode     m_eSADTreeMode;
+  UInt            m_uiSADTreeGeneration;
+  UInt            m_uiSADTreeCtuRsAddr;
+  UInt            m_uiSADTreeZorderIdx;
+  UInt            m_uiSADTreeDepth;
+  Int             m_iSADTreePOC;
+  Int             m_iSADTreeRefList;
+  Int             m_iSADTreeRefIdx;
+  Int             m_iSADTreeSubSize;
+  Bool            m_bSADTreeRecordSAD;
+  Int             m_iSADTreePUX0;                     ///< PU rectangle in sub-block units, for SADTREE_QUERY
+  Int             m_iSADTreePUY0;
+  Int             m_iSADTreePUX1;
+  Int             m_iSADTreePUY1;
+
+  // parallel uni-directional motion estimation over the reference pictures of a PU
+  TComThreadPool*           m_pcMEThreadPool;       ///< thread pool of the encoder
+  std::vector<TEncSearch*>  m_apcMEWorker;          ///< search contexts of the ME jobs, each with its own TComRdCost, DistParam and filtered-block buffers
+  std::vector<TComRdCost*>  m_apcMEWorkerRdCost;
+  Bool                      m_bMEWorker;            ///< this instance is a search context of another TEncSearch
+
+  // EMI: FME network inputs of the last PU searched with this instance
+  UInt                      m_auiNNErrors[NUM_NN_ERRORS];
+  UInt                      m_uiNNCenter;
+  UInt                      m_uiNNPUHeight;
+  UInt                      m_uiNNPUWidth;
+
+  // inter residual cache: residual quadtree decisions of the CU under test at each depth, for identical residuals
+  class ResidualCacheEntry
+  {
+  public:
+    Bool        bValid;
+    UInt64      uiHash;                               ///< hash of the residual, checked before the residual itself
+    PartSize    ePartSize;
+    Int         iQP;
+    UChar       ucChromaQpAdj;
+    Bool        bLossless;
+    Double      dLambda;
+    TComYuv     cResi;                                ///< residual the decision was made for
+    TComYuv     cResiBest;                            ///< coded residual, if the CU has one
+    UChar*      puhTrIdx;
+    UChar*      apuhCbf                  [MAX_NUM_COMPONENT];
+    UChar*      apuhTransformSkip        [MAX_NUM_COMPONENT];
+    SChar*      apcCrossComponentAlpha   [MAX_NUM_COMPONENT];
+    UChar*      apuhExplicitRdpcmMode    [MAX_NUM_COMPONENT];
+    TCoeff*     apcCoeff                 [MAX_NUM_COMPONENT];
+#if ADAPTIVE_QP_SELECTION
+    TCoeff*     apcArlCoeff              [MAX_NUM_COMPONENT];
+#endif
+
+    Void create ( const ChromaFormat chFmt, const UInt uiWidth, const UInt uiHeight, const UInt uiNumPartitions );
+    Void destroy();
+  };
+
+  ResidualCacheEntry*       m_apcResidualCache[MAX_CU_DEPTH];   ///< RESIDUAL_CACHE_SIZE entries per CU depth, NULL if the cache is disabled
+  UInt                      m_auiResidualCacheNext[MAX_CU_DEPTH];
+  UInt                      m_auiResidualCacheCtuRsAddr[MAX_CU_DEPTH];
+  UInt                      m_auiResidualCacheZorderIdx[MAX_CU_DEPTH];
+  Int                       m_aiResidualCachePOC[MAX_CU_DEPTH];
+
+  // inter residual cache: lookups and hits per CU depth, over all instances
+  static std::atomic<UInt64> s_auiResidualCacheLookups[MAX_CU_DEPTH];
+  static std::atomic<UInt64> s_auiResidualCacheHits   [MAX_CU_DEPTH];
+
+  // zero-block detection: inter TUs tested and TUs short-circuited, per channel type and TU size, over all instances
+  static std::atomic<UInt64> s_auiZeroBlockTested [MAX_NUM_CHANNEL_TYPE][NUM_ZERO_BLOCK_SIZES];
+  static std::atomic<UInt64> s_auiZeroBlockSkipped[MAX_NUM_CHANNEL_TYPE][NUM_ZERO_BLOCK_SIZES];
+
   Bool            m_isInitialized;
 public:
   TEncSearch();
@@ -133,7 +233,8 @@ public:
             TEncEntropy*   pcEntropyCoder,
             TComRdCost*    pcRdCost,
             TEncSbac***    pppcRDSbacCoder,
-            TEncSbac*      pcRDGoOnSbacCoder );
+            TEncSbac*      pcRDGoOnSbacCoder,
+            TComThreadPool* pcThreadPool );
 
   Void destroy();
 
@@ -211,6 +312,15 @@ public:
   /// set ME search range
   Void setAdaptiveSearchRange   ( Int iDir, Int iRefIdx, Int iSearchRange) { assert(iDir < MAX_NUM_REF_LIST_ADAPT_SR && iRefIdx<Int(MAX_IDX_ADAPT_SR)); m_aaiAdaptSR[iDir][iRefIdx] = iSearchRange; }
 
+  /// print the hit rate of the inter residual cache per CU depth
+  static Void printResidualCacheStatistics();
+
+  /// print the number of TUs short-circuited by the zero-block detection, per channel type and TU size
+  static Void printZeroBlockStatistics( const ZeroBlockDetectionMode mode );
+
+  /// EMI: forget the FME network inputs of the previous PU, so that the search no longer depends on the coding order before this point
+  Void resetNNState             ();
+
   Void xEncPCM    (TComDataCU* pcCU, UInt uiAbsPartIdx, Pel* piOrg, Pel* piPCM, Pel* piPred, Pel* piResi, Pel* piReco, UInt uiStride, UInt uiWidth, UInt uiHeight, const ComponentID compID );
   Void IPCMSearch (TComDataCU* pcCU, TComYuv* pcOrgYuv, TComYuv* rpcPredYuv, TComYuv* rpcResiYuv, TComYuv* rpcRecoYuv );
 protected:
@@ -372,6 +482,19 @@ protected:
                                     Distortion&  ruiCost,
                                     Bool         bBi = false  );
 
+  Void xMotionEstimationRefs      ( TComDataCU*  pcCU,
+                                    TComYuv*     pcYuvOrg,
+                                    Int          iPartIdx,
+                                    Int          iNumSearches,
+                                    const Int*   piRefList,
+                                    const Int*   piRefIdx,
+                                    TComMv       cMvPred[][33],
+                                    TComMv       cMv[][33],
+                                    UInt         auiBits[][33],
+                                    Distortion   auiCost[][33] );
+
+  static Void xCopyNNState        ( TEncSearch* pcDst, const TEncSearch* pcSrc );
+
   Void xTZSearch                  ( const TComDataCU* const  pcCU,
                                     const TComPattern* const pcPatternKey,
                                     const Pel* const         piRefY,
@@ -381,6 +504,7 @@ protected:
                                     TComMv&                  rcMv,
                                     Distortion&              ruiSAD,
                                     const TComMv* const      pIntegerMv2Nx2NPred,
+                                    const TComMv* const      pPyramidMvPred,
                                     const Bool               bExtendedSettings
                                     );
 
@@ -392,9 +516,35 @@ protected:
                                     const TComMv* const      pcMvSrchRngRB,
                                     TComMv&                  rcMv,
                                     Distortion&              ruiSAD,
-                                    const TComMv* const      pIntegerMv2Nx2NPred
+                                    const TComMv* const      pIntegerMv2Nx2NPred,
+                                    const TComMv* const      pPyramidMvPred
                                     );
 
+  Bool xGetPyramidMvPred          ( const TComDataCU* const pcCU,
+                                    const UInt         uiPartAddr,
+                                    const Int          iRoiWidth,
+                                    const Int          iRoiHeight,
+                                    const RefPicList   eRefPicList,
+                                    const Int          iRefIdx,
+                                    TComMv&            rcMv );
+
+  Void xSetSADTreeMode            ( const TComDataCU* const pcCU,
+                                    const UInt         uiPartAddr,
+                                    const Int          iRoiWidth,
+                                    const Int          iRoiHeight,
+                                    const RefPicList   eRefPicList,
+                                    const Int          iRefIdx );
+
+  Distortion xSADTreeRecord       ( const TComPattern* const pcPatternKey,
+                                    const Pel* const   piRefSrch,
+                                    const Int          iRefStride,
+                                    const Int          iSearchX,
+                                    const Int          iSearchY );
+
+  Bool xSADTreeQuery              ( const Int          iSearchX,
+                                    const Int          iSearchY,
+                                    Distortion&        ruiDist );
+
   Void xSetSearchRange            ( const TComDataCU* const pcCU,
                                     const TComMv&      cMvPred,
                                     const Int          iSrchRng,
@@ -409,7 +559,8 @@ protected:
                                     const TComMv* const      pcMvSrchRngRB,
                                     TComMv&                  rcMv,
                                     Distortion&              ruiSAD,
-                                    const TComMv* const      pIntegerMv2Nx2NPred
+                                    const TComMv* const      pIntegerMv2Nx2NPred,
+                                    const TComMv* const      pPyramidMvPred
                                   );
 
   Void xPatternSearch             ( const TComPattern* const pcPatternKey,
@@ -418,7 +569,10 @@ protected:
                                     const TComMv* const      pcMvSrchRngLT,
                                     const TComMv* const      pcMvSrchRngRB,
                                     TComMv&      rcMv,
-                                    Distortion&  ruiSAD );
+                                    Distortion&  ruiSAD,
+                                    const TEncPic* const     pcSEARef,
+                                    const Int                iPelX,
+                                    const Int                iPelY );
 
   Void xPatternSearchFracDIF      (
                                     Bool         bIsLosslessCoded,
@@ -441,6 +595,11 @@ protected:
 
   Void xEncodeInterResidualQT( const ComponentID compID, TComTU &rTu );
   Void xEstimateInterResidualQT( TComYuv* pcResi, Double &rdCost, UInt &ruiBits, Distortion &ruiDist, Distortion *puiZeroDist, TComTU &rTu DEBUG_STRING_FN_DECLARE(sDebug) );
+  Bool xIsZeroBlock            ( TComTU &rTu, const ComponentID compID, const Pel* pcResidual, const UInt uiStride, const QpParam &cQP );
+
+  UInt64 xHashResidual         ( const TComYuv* pcResi, const UInt uiWidth, const UInt uiHeight ) const;
+  Bool xLookupResidualCache    ( TComDataCU* pcCU, const TComYuv* pcYuvResi, TComYuv* pcYuvResiBest, UInt64& ruiHash );
+  Void xStoreResidualCache     ( TComDataCU* pcCU, const TComYuv* pcYuvResi, const TComYuv* pcYuvResiBest, const UInt64 uiHash );
   Void xSetInterResidualQTData( TComYuv* pcResi, Bool bSpatial, TComTU &rTu  );
 
   UInt  xModeBitsIntra ( TComDataCU* pcCU, UInt uiMode, UInt uiPartOffset, UInt uiDepth, const ChannelType compID );
@@ -48,6 +48,8 @@
 
 TEncSlice::TEncSlice()
  : m_encCABACTableIdx(I_SLICE)
+ , m_pcThreadPool(NULL)
+ , m_bCtuScalingListSet(false)
 {
 }
 
@@ -74,31 +76,81 @@ Void TEncSlice::destroy()
   m_vdRdPicLambda.clear();
   m_vdRdPicQp.clear();
   m_viRdPicQp.clear();
+
+  for ( UInt i = 0; i < m_apcCtuContexts.size(); i++ )
+  {
+    delete m_apcCtuContexts[i];
+  }
+  m_apcCtuContexts.clear();
+  for ( UInt i = 0; i < m_apcWppRowSyncState.size(); i++ )
+  {
+    delete m_apcWppRowSyncState[i];
+  }
+  m_apcWppRowSyncState.clear();
 }
 
 Void TEncSlice::init( TEncTop* pcEncTop )
+{
+  init( pcEncTop, NULL );
+}
+
+/** Initialise the slice encoder
+ * \param pcEncTop  encoder
+ * \param pcModules private CTU encoding modules to compress with, or NULL to use the ones of the encoder.
+ *                  A slice encoder with private modules only compresses slices; encodeSlice is run by the one of the encoder.
+ */
+Void TEncSlice::init( TEncTop* pcEncTop, TEncWorkerContext* pcModules )
 {
   m_pcCfg             = pcEncTop;
   m_pcListPic         = pcEncTop->getListPic();
 
   m_pcGOPEncoder      = pcEncTop->getGOPEncoder();
-  m_pcCuEncoder       = pcEncTop->getCuEncoder();
-  m_pcPredSearch      = pcEncTop->getPredSearch();
-
-  m_pcEntropyCoder    = pcEncTop->getEntropyCoder();
   m_pcSbacCoder       = pcEncTop->getSbacCoder();
-  m_pcBinCABAC        = pcEncTop->getBinCABAC();
-  m_pcTrQuant         = pcEncTop->getTrQuant();
+  if ( pcModules == NULL )
+  {
+    m_pcCuEncoder       = pcEncTop->getCuEncoder();
+    m_pcPredSearch      = pcEncTop->getPredSearch();
+
+    m_pcEntropyCoder    = pcEncTop->getEntropyCoder();
+    m_pcBinCABAC        = pcEncTop->getBinCABAC();
+    m_pcTrQuant         = pcEncTop->getTrQuant();
+
+    m_pcRdCost          = pcEncTop->getRdCost();
+    m_pppcRDSbacCoder   = pcEncTop->getRDSbacCoder();
+    m_pcRDGoOnSbacCoder = pcEncTop->getRDGoOnSbacCoder();
+  }
+  else
+  {
+    m_pcCuEncoder       = &pcModules->m_cCuEncoder;
+    m_pcPredSearch      = &pcModules->m_cSearch;
 
-  m_pcRdCost          = pcEncTop->getRdCost();
-  m_pppcRDSbacCoder   = pcEncTop->getRDSbacCoder();
-  m_pcRDGoOnSbacCoder = pcEncTop->getRDGoOnSbacCoder();
+    m_pcEntropyCoder    = &pcModules->m_cEntropyCoder;
+    m_pcBinCABAC        = &pcModules->m_cBinCoderCABAC;
+    m_pcTrQuant         = &pcModules->m_cTrQuant;
+
+    m_pcRdCost          = &pcModules->m_cRdCost;
+    m_pppcRDSbacCoder   = pcModules->m_pppcRDSbacCoder;
+    m_pcRDGoOnSbacCoder = &pcModules->m_cRDGoOnSbacCoder;
+  }
 
   // create lambda and QP arrays
   m_vdRdPicLambda.resize(m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_vdRdPicQp.resize(    m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_viRdPicQp.resize(    m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_pcRateCtrl        = pcEncTop->getRateCtrl();
+  m_pcThreadPool      = pcEncTop->getThreadPool();
+
+  // modules of the parallel CTU jobs, for wavefronts or else for tiles
+  const Bool bTiles         = ( m_pcCfg->getNumColumnsMinus1() + 1 ) * ( m_pcCfg->getNumRowsMinus1() + 1 ) > 1;
+  const Int  iNumCtuThreads = m_pcCfg->getEntropyCodingSyncEnabledFlag() ? m_pcCfg->getNumWppThreads() : ( bTiles ? m_pcCfg->getNumTileThreads() : 1 );
+  if ( iNumCtuThreads > 1 )
+  {
+    for ( Int i = 0; i < iNumCtuThreads; i++ )
+    {
+      m_apcCtuContexts.push_back( new TEncWorkerContext );
+      m_apcCtuContexts[i]->create( m_pcCfg, m_pcRateCtrl, m_pcThreadPool );
+    }
+  }
 }
 
 
@@ -503,6 +555,10 @@ Void TEncSlice::setSearchRange( TComSlice* pcSlice )
       iRefPOC = pcSlice->getRefPic(e, iRefIdx)->getPOC();
       Int newSearchRange = Clip3(m_pcCfg->getMinSearchWindow(), iMaxSR, (iMaxSR*ADAPT_SR_SCALE*abs(iCurrPOC - iRefPOC)+iOffset)/iGOPSize);
       m_pcPredSearch->setAdaptiveSearchRange(iDir, iRefIdx, newSearchRange);
+      for ( UInt i = 0; i < m_apcCtuContexts.size(); i++ )
+      {
+        m_apcCtuContexts[i]->m_cSearch.setAdaptiveSearchRange(iDir, iRefIdx, newSearchRange);
+      }
     }
   }
 }
@@ -699,6 +755,22 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     xCheckWPEnable( pcSlice );
   }
 
+  // integral images of the reference pictures for the successive elimination full search, which weighted prediction disables
+  if ( m_pcCfg->getUseRecIntegralImages() && !pcSlice->isIntra() && !pcSlice->getUseWeightedPrediction() )
+  {
+    for ( UInt uiRefList = 0; uiRefList < NUM_REF_PIC_LIST_01; uiRefList++ )
+    {
+      for ( Int iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx( RefPicList(uiRefList) ); iRefIdx++ )
+      {
+        TEncPic* pcRefPic = dynamic_cast<TEncPic*>( pcSlice->getRefPic( RefPicList(uiRefList), iRefIdx ) );
+        if ( pcRefPic != NULL )
+        {
+          pcRefPic->buildRecIntegralImages();
+        }
+      }
+    }
+  }
+
 #if ADAPTIVE_QP_SELECTION
   if( m_pcCfg->getUseAdaptQpSelect() && !(pcSlice->getDependentSliceSegmentFlag()))
   {
@@ -730,6 +802,20 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     }
   }
 
+  if ( xUseCtuThreads( pcPic, pcSlice ) )
+  {
+    xInitCtuContexts( pcSlice, bFastDeltaQP );
+    if ( m_pcCfg->getEntropyCodingSyncEnabledFlag() )
+    {
+      xCompressSliceWpp( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr );
+    }
+    else
+    {
+      xCompressSliceTiles( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr );
+    }
+    return;
+  }
+
   // for every CTU in the slice segment (may terminate sooner if there is a byte limit on the slice-segment)
 
   for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
@@ -765,6 +851,14 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
       }
     }
 
+    // with wavefronts or tiles, the motion search of a CTU row or of a tile does not depend on the CTUs coded before it
+    // (see xCompressSliceWpp and xCompressSliceTiles)
+    if ( ( m_pcCfg->getEntropyCodingSyncEnabledFlag() || pcPic->getPicSym()->getNumTiles() > 1 )
+      && ( ctuTsAddr == startCtuTsAddr || ctuRsAddr == firstCtuRsAddrOfTile || ( m_pcCfg->getEntropyCodingSyncEnabledFlag() && ctuXPosInCtus == tileXPosInCtus ) ) )
+    {
+      m_pcPredSearch->resetNNState();
+    }
+
     // set go-on entropy coder (used for all trial encodings - the cu encoder and encoder search also have a copy of the same pointer)
     m_pcEntropyCoder->setEntropyCoder ( m_pcRDGoOnSbacCoder );
     m_pcEntropyCoder->setBitstream( &tempBitCounter );
@@ -925,6 +1019,376 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
   //}
 }
 
+/** Check if a slice segment can be compressed with parallel CTU jobs (wavefront CTU rows or tiles)
+ * The jobs need to be independent of everything but the CTUs they wait for, which excludes the CTU-level rate control,
+ * the byte-limited slices and the adaptive QP selection statistics. Wavefronts within tiles are compressed serially.
+ */
+Bool TEncSlice::xUseCtuThreads( const TComPic* pcPic, const TComSlice* pcSlice ) const
+{
+  const Int numTiles = pcPic->getPicSym()->getNumTiles();
+  return !m_apcCtuContexts.empty()
+      && ( m_pcCfg->getEntropyCodingSyncEnabledFlag() ? numTiles == 1 : numTiles > 1 )
+      && !m_pcCfg->getUseRateCtrl()
+#if ADAPTIVE_QP_SELECTION
+      && !m_pcCfg->getUseAdaptQpSelect()
+#endif
+      && pcSlice->getSliceMode() != FIXED_NUMBER_OF_BYTES
+      && pcSlice->getSliceSegmentMode() != FIXED_NUMBER_OF_BYTES;
+}
+
+/** Copy the per-slice state of the encoding modules of the encoder class to the modules of the CTU jobs
+ * \param pcSlice      slice segment to compress
+ * \param bFastDeltaQP fast delta-QP decision
+ */
+Void TEncSlice::xInitCtuContexts( TComSlice* pcSlice, const Bool bFastDeltaQP )
+{
+  const TComSPS* pcSPS = pcSlice->getSPS();
+  for ( UInt i = 0; i < m_apcCtuContexts.size(); i++ )
+  {
+    TEncWorkerContext* pcCtx = m_apcCtuContexts[i];
+    pcCtx->m_cRdCost = *m_pcRdCost;
+#if RDOQ_CHROMA_LAMBDA
+    pcCtx->m_cTrQuant.setLambdas( pcSlice->getLambdas() );
+#else
+    pcCtx->m_cTrQuant.setLambda( pcSlice->getLambdas()[0] );
+#endif
+    pcCtx->m_cCuEncoder.setFastDeltaQp( bFastDeltaQP );
+
+    if ( !m_bCtuScalingListSet )
+    {
+      pcCtx->initScalingList( m_pcCfg, pcSPS );
+    }
+  }
+  m_bCtuScalingListSet = true;
+}
+
+/** Start a run of CTUs of a CTU job: reset the contexts and the coding-order dependent state of the search
+ * \param pcCtx   encoding modules of the job
+ * \param pcSlice slice segment to compress
+ */
+Void TEncSlice::xStartCtuJob( TEncWorkerContext* pcCtx, TComSlice* pcSlice )
+{
+  TEncSbac*     pcRDSbacCoder = pcCtx->m_pppcRDSbacCoder[0][CI_CURR_BEST];
+  TEncBinCABAC* pRDSbacCoder  = (TEncBinCABAC *) pcRDSbacCoder->getEncBinIf();
+
+  pcCtx->m_cEntropyCoder.setEntropyCoder( pcRDSbacCoder );
+  pcCtx->m_cEntropyCoder.resetEntropy   ( pcSlice );
+  pRDSbacCoder->setBinCountingEnableFlag( false );
+  pRDSbacCoder->setBinsCoded( 0 );
+  pcCtx->m_cSearch.resetNNState();
+}
+
+Void TEncSlice::xFinishCtuJob( TEncWorkerContext* pcCtx )
+{
+  pcCtx->m_pppcRDSbacCoder[0][CI_CURR_BEST]->setBitstream( NULL );
+  pcCtx->m_cRDGoOnSbacCoder.setBitstream( NULL );
+}
+
+/** Compress and encode a CTU with the modules of a CTU job, as the serial loop of compressSlice does
+ * The RD SBAC coder of the job holds the contexts at the start of the CTU on input and the ones at its end on output.
+ * \param pcCtx encoding modules of the job
+ * \param pCtu  CTU, initialised
+ * \returns number of bits of the CTU
+ */
+Int TEncSlice::xCompressCtu( TEncWorkerContext* pcCtx, TComDataCU* pCtu )
+{
+  TEncEntropy*    pcEntropyCoder = &pcCtx->m_cEntropyCoder;
+  TEncSbac*       pcRDSbacCoder  = pcCtx->m_pppcRDSbacCoder[0][CI_CURR_BEST];
+  TEncBinCABAC*   pRDSbacCoder   = (TEncBinCABAC *) pcRDSbacCoder->getEncBinIf();
+  TComBitCounter& tempBitCounter = pcCtx->m_cBitCounter;
+
+  // CTU trial encoder with the go-on entropy coder
+  pcEntropyCoder->setEntropyCoder ( &pcCtx->m_cRDGoOnSbacCoder );
+  pcEntropyCoder->setBitstream( &tempBitCounter );
+  tempBitCounter.resetBits();
+  pcCtx->m_cRDGoOnSbacCoder.load( pcRDSbacCoder );
+  ((TEncBinCABAC*)pcCtx->m_cRDGoOnSbacCoder.getEncBinIf())->setBinCountingEnableFlag(true);
+
+  pcCtx->m_cCuEncoder.compressCtu( pCtu );
+
+  // true encode of the CTU, which updates the contexts and counts the bits
+  pcEntropyCoder->setEntropyCoder ( pcRDSbacCoder );
+  pcEntropyCoder->setBitstream( &tempBitCounter );
+  pRDSbacCoder->setBinCountingEnableFlag( true );
+  pcRDSbacCoder->resetBits();
+  pRDSbacCoder->setBinsCoded( 0 );
+
+  pcCtx->m_cCuEncoder.encodeCtu( pCtu );
+
+  pRDSbacCoder->setBinCountingEnableFlag( false );
+
+  return pcEntropyCoder->getNumberOfWrittenBits();
+}
+
+/** Add the bits and costs of the CTUs compressed by the CTU jobs to the slice and picture statistics, in coding order
+ * \param pcPic             picture class
+ * \param pcSlice           slice segment
+ * \param startCtuTsAddr    first CTU of the slice segment
+ * \param boundingCtuTsAddr CTU following the slice segment
+ * \param raiCtuBits        bits of the CTUs of the slice segment
+ */
+Void TEncSlice::xAddCtuStatistics( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const std::vector<Int>& raiCtuBits )
+{
+  for ( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    TComDataCU* pCtu = pcPic->getCtu( pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr) );
+    const Int numberOfWrittenBits = raiCtuBits[ctuTsAddr - startCtuTsAddr];
+    pcSlice->setSliceBits( (UInt)(pcSlice->getSliceBits() + numberOfWrittenBits) );
+    pcSlice->setSliceSegmentBits(pcSlice->getSliceSegmentBits()+numberOfWrittenBits);
+
+    m_uiPicTotalBits += pCtu->getTotalBits();
+    m_dPicRdCost     += pCtu->getTotalCost();
+    m_uiPicDist      += pCtu->getTotalDistortion();
+  }
+}
+
+/** Compress the CTUs of a slice segment with one job per set of encoding modules (wavefront parallel processing)
+ * Every job takes the next CTU row not started yet until all rows are taken, and starts a CTU once the row above has
+ * finished the CTU above-right of it. Rows are taken in order, so a row only waits for rows whose jobs are running. The
+ * CABAC contexts of the rows are initialised as in the serial loop of compressSlice, so the result is the same as the one
+ * of a serial wavefront encode.
+ * \param pcPic             picture class
+ * \param pcSlice           slice segment to compress
+ * \param startCtuTsAddr    first CTU of the slice segment
+ * \param boundingCtuTsAddr CTU following the slice segment
+ */
+Void TEncSlice::xCompressSliceWpp( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+  const UInt firstRow         = startCtuTsAddr / frameWidthInCtus;
+  const UInt numRows          = ( boundingCtuTsAddr - 1 ) / frameWidthInCtus + 1 - firstRow;
+
+  m_auiWppRowProgress.assign( numRows, 0 );
+  m_auiWppRowProgress[0] = startCtuTsAddr % frameWidthInCtus;
+  while ( m_apcWppRowSyncState.size() < numRows )
+  {
+    m_apcWppRowSyncState.push_back( new TEncSbac );
+  }
+  std::vector<Int> aiCtuBits( boundingCtuTsAddr - startCtuTsAddr, 0 );
+
+  UInt uiNextRow = 0;
+  m_pcThreadPool->parallelFor( std::min<Int>( Int(numRows), Int(m_apcCtuContexts.size()) ), [&]( Int iJob )
+  {
+    while ( true )
+    {
+      UInt uiRow;
+      {
+        std::lock_guard<std::mutex> cLock( m_cCtuMutex );
+        uiRow = uiNextRow++;
+      }
+      if ( uiRow >= numRows )
+      {
+        break;
+      }
+      xCompressCtuRowWpp( m_apcCtuContexts[iJob], pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, uiRow, aiCtuBits );
+    }
+  } );
+
+  xAddCtuStatistics( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, aiCtuBits );
+
+  // leave the state of the second CTU of the last row in the entropy-coding-sync storage, as the serial loop does
+  for ( Int iRow = Int(numRows) - 1; iRow >= 0 && frameWidthInCtus > 1; iRow-- )
+  {
+    const UInt secondCtuTsAddr = ( firstRow + iRow ) * frameWidthInCtus + 1;
+    if ( secondCtuTsAddr >= startCtuTsAddr && secondCtuTsAddr < boundingCtuTsAddr )
+    {
+      m_entropyCodingSyncContextState.loadContexts( m_apcWppRowSyncState[iRow] );
+      break;
+    }
+  }
+}
+
+/** Compress the CTUs of a slice segment that are in one CTU row
+ * \param pcCtx             encoding modules of the job
+ * \param pcPic             picture class
+ * \param pcSlice           slice segment to compress
+ * \param startCtuTsAddr    first CTU of the slice segment
+ * \param boundingCtuTsAddr CTU following the slice segment
+ * \param uiRow             CTU row, counted from the first row of the slice segment
+ * \param raiCtuBits        bits of the CTUs of the slice segment
+ */
+Void TEncSlice::xCompressCtuRowWpp( TEncWorkerContext* pcCtx, TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr,
+                                    const UInt uiRow, std::vector<Int>& raiCtuBits )
+{
+  const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+  const UInt row              = startCtuTsAddr / frameWidthInCtus + uiRow;
+  const UInt rowStartTsAddr   = std::max( startCtuTsAddr, row * frameWidthInCtus );
+  const UInt rowEndTsAddr     = std::min( boundingCtuTsAddr, ( row + 1 ) * frameWidthInCtus );
+  const TComTile* pCurrentTile         = pcPic->getPicSym()->getTComTile(0);
+  const UInt      firstCtuRsAddrOfTile = pCurrentTile->getFirstCtuRsAddr();
+  const UInt      tileXPosInCtus       = firstCtuRsAddrOfTile % frameWidthInCtus;
+
+  TEncSbac* pcRDSbacCoder = pcCtx->m_pppcRDSbacCoder[0][CI_CURR_BEST];
+  xStartCtuJob( pcCtx, pcSlice );
+
+  for( UInt ctuTsAddr = rowStartTsAddr; ctuTsAddr < rowEndTsAddr; ++ctuTsAddr )
+  {
+    const UInt ctuRsAddr     = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+    const UInt ctuXPosInCtus = ctuRsAddr % frameWidthInCtus;
+
+    // wait until the CTU above-right is finished
+    if ( uiRow > 0 )
+    {
+      const UInt numCtusAboveNeeded = std::min( ctuXPosInCtus + 2, frameWidthInCtus );
+      std::unique_lock<std::mutex> cLock( m_cCtuMutex );
+      m_cWppRowDone.wait( cLock, [&]{ return m_auiWppRowProgress[uiRow - 1] >= numCtusAboveNeeded; } );
+    }
+
+    // initialize CTU encoder
+    TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+    pCtu->initCtu( pcPic, ctuRsAddr );
+
+    // update CABAC state, as in compressSlice
+    if ( ctuTsAddr == startCtuTsAddr && pcSlice->getDependentSliceSegmentFlag() && ctuRsAddr != firstCtuRsAddrOfTile )
+    {
+      if( pCurrentTile->getTileWidthInCtus() >= 2 || !m_pcCfg->getEntropyCodingSyncEnabledFlag() )
+      {
+        pcRDSbacCoder->loadContexts( &m_lastSliceSegmentEndContextState );
+      }
+    }
+    if (ctuRsAddr == firstCtuRsAddrOfTile)
+    {
+      pcRDSbacCoder->resetEntropy(pcSlice);
+    }
+    else if ( ctuXPosInCtus == tileXPosInCtus )
+    {
+      pcRDSbacCoder->resetEntropy(pcSlice);
+      TComDataCU *pCtuUp = pCtu->getCtuAbove();
+      if ( pCtuUp && ((ctuRsAddr%frameWidthInCtus+1) < frameWidthInCtus)  )
+      {
+        TComDataCU *pCtuTR = pcPic->getCtu( ctuRsAddr - frameWidthInCtus + 1 );
+        if ( pCtu->CUIsFromSameSliceAndTile(pCtuTR) )
+        {
+          // the top-right CTU belongs to an earlier slice segment when it is not in the rows of this one
+          const Bool bEarlierSegment = pcPic->getPicSym()->getCtuRsToTsAddrMap( pCtuTR->getCtuRsAddr() ) < startCtuTsAddr;
+          pcRDSbacCoder->loadContexts( bEarlierSegment ? &m_entropyCodingSyncContextState : m_apcWppRowSyncState[uiRow - 1] );
+        }
+      }
+    }
+
+    raiCtuBits[ctuTsAddr - startCtuTsAddr] = xCompressCtu( pcCtx, pCtu );
+
+    // store probabilities of second CTU in line for the row below
+    if ( ctuXPosInCtus == tileXPosInCtus+1 )
+    {
+      m_apcWppRowSyncState[uiRow]->loadContexts( pcRDSbacCoder );
+    }
+    // store context state at the end of this slice-segment, in case the next slice is a dependent slice
+    if ( ctuTsAddr + 1 == boundingCtuTsAddr && pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag() )
+    {
+      m_lastSliceSegmentEndContextState.loadContexts( pcRDSbacCoder );
+    }
+
+    {
+      std::lock_guard<std::mutex> cLock( m_cCtuMutex );
+      m_auiWppRowProgress[uiRow] = ctuXPosInCtus + 1;
+    }
+    m_cWppRowDone.notify_all();
+  }
+
+  xFinishCtuJob( pcCtx );
+}
+
+/** Compress the CTUs of a slice segment with one job per set of encoding modules, each taking tiles until all are taken
+ * Tiles do not depend on each other, so the jobs only need their own sets of encoding modules. The contexts are reset at
+ * the start of each tile as in the serial loop of compressSlice, so the result is the same as the one of a serial encode.
+ * \param pcPic             picture class
+ * \param pcSlice           slice segment to compress
+ * \param startCtuTsAddr    first CTU of the slice segment
+ * \param boundingCtuTsAddr CTU following the slice segment
+ */
+Void TEncSlice::xCompressSliceTiles( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  // runs of CTUs of the slice segment that are in the same tile
+  std::vector<UInt> auiRunStartTsAddr;
+  for ( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+    if ( ctuTsAddr == startCtuTsAddr || ctuRsAddr == pcPic->getPicSym()->getTComTile(pcPic->getPicSym()->getTileIdxMap(ctuRsAddr))->getFirstCtuRsAddr() )
+    {
+      auiRunStartTsAddr.push_back( ctuTsAddr );
+    }
+  }
+  auiRunStartTsAddr.push_back( boundingCtuTsAddr );
+
+  // initialize the CTU encoders up front: the neighbour availability checks of a tile
+  // dereference the slice of the CTUs of the adjacent tiles
+  for ( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+    pcPic->getCtu( ctuRsAddr )->initCtu( pcPic, ctuRsAddr );
+  }
+
+  std::vector<Int> aiCtuBits( boundingCtuTsAddr - startCtuTsAddr, 0 );
+
+  const Int iNumRuns = Int(auiRunStartTsAddr.size()) - 1;
+  Int       iNextRun = 0;
+  m_pcThreadPool->parallelFor( std::min<Int>( iNumRuns, Int(m_apcCtuContexts.size()) ), [&]( Int iJob )
+  {
+    while ( true )
+    {
+      Int iRun;
+      {
+        std::lock_guard<std::mutex> cLock( m_cCtuMutex );
+        iRun = iNextRun++;
+      }
+      if ( iRun >= iNumRuns )
+      {
+        break;
+      }
+      xCompressCtusOfTile( m_apcCtuContexts[iJob], pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, auiRunStartTsAddr[iRun], auiRunStartTsAddr[iRun + 1], aiCtuBits );
+    }
+  } );
+
+  xAddCtuStatistics( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, aiCtuBits );
+}
+
+/** Compress a run of CTUs of a slice segment that are in one tile
+ * \param pcCtx             encoding modules of the job
+ * \param pcPic             picture class
+ * \param pcSlice           slice segment to compress
+ * \param startCtuTsAddr    first CTU of the slice segment
+ * \param boundingCtuTsAddr CTU following the slice segment
+ * \param runStartTsAddr    first CTU of the run
+ * \param runEndTsAddr      CTU following the run
+ * \param raiCtuBits        bits of the CTUs of the slice segment
+ */
+Void TEncSlice::xCompressCtusOfTile( TEncWorkerContext* pcCtx, TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr,
+                                     const UInt runStartTsAddr, const UInt runEndTsAddr, std::vector<Int>& raiCtuBits )
+{
+  TEncSbac* pcRDSbacCoder = pcCtx->m_pppcRDSbacCoder[0][CI_CURR_BEST];
+  xStartCtuJob( pcCtx, pcSlice );
+
+  for( UInt ctuTsAddr = runStartTsAddr; ctuTsAddr < runEndTsAddr; ++ctuTsAddr )
+  {
+    const UInt ctuRsAddr            = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+    const UInt firstCtuRsAddrOfTile = pcPic->getPicSym()->getTComTile(pcPic->getPicSym()->getTileIdxMap(ctuRsAddr))->getFirstCtuRsAddr();
+
+    // CTU encoder was initialized in xCompressSliceTiles
+    TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+
+    // update CABAC state, as in compressSlice
+    if ( ctuTsAddr == startCtuTsAddr && pcSlice->getDependentSliceSegmentFlag() && ctuRsAddr != firstCtuRsAddrOfTile )
+    {
+      pcRDSbacCoder->loadContexts( &m_lastSliceSegmentEndContextState );
+    }
+    if (ctuRsAddr == firstCtuRsAddrOfTile)
+    {
+      pcRDSbacCoder->resetEntropy(pcSlice);
+    }
+
+    raiCtuBits[ctuTsAddr - startCtuTsAddr] = xCompressCtu( pcCtx, pCtu );
+
+    // store context state at the end of this slice-segment, in case the next slice is a dependent slice
+    if ( ctuTsAddr + 1 == boundingCtuTsAddr && pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag() )
+    {
+      m_lastSliceSegmentEndContextState.loadContexts( pcRDSbacCoder );
+    }
+  }
+
+  xFinishCtuJob( pcCtx );
+}
+
 Void TEncSlice::encodeSlice   ( TComPic* pcPic, TComOutputBitstream* pcSubstreams, UInt &numBinsCoded )
 {
   TComSlice *const pcSlice           = pcPic->getSlice(getSliceIdx());
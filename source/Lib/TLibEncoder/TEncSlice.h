@@ -46,6 +46,11 @@
 #include "TEncCu.h"
 #include "WeightPredAnalysis.h"
 #include "TEncRateCtrl.h"
+#include "TEncWorkerContext.h"
+#include "TLibCommon/TComThreadPool.h"
+
+#include <mutex>
+#include <condition_variable>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -99,7 +104,28 @@ private:
   TEncSbac                m_entropyCodingSyncContextState;      ///< context storate for state of contexts at the wavefront/WPP/entropy-coding-sync second CTU of tile-row
   SliceType               m_encCABACTableIdx;
 
+  // parallel CTU compression (wavefront CTU rows or tiles)
+  TComThreadPool*                 m_pcThreadPool;                 ///< thread pool of the encoder
+  std::vector<TEncWorkerContext*> m_apcCtuContexts;               ///< module sets of the CTU jobs, one per job
+  std::vector<TEncSbac*>          m_apcWppRowSyncState;           ///< context state after the second CTU of each CTU row of the slice segment
+  std::vector<UInt>               m_auiWppRowProgress;            ///< number of finished CTUs of each CTU row, counted from the left picture border
+  std::mutex                      m_cCtuMutex;
+  std::condition_variable         m_cWppRowDone;
+  Bool                            m_bCtuScalingListSet;
+
   Void     setUpLambda(TComSlice* slice, const Double dLambda, Int iQP);
+  Bool     xUseCtuThreads          ( const TComPic* pcPic, const TComSlice* pcSlice ) const;
+  Void     xInitCtuContexts        ( TComSlice* pcSlice, const Bool bFastDeltaQP );
+  Void     xStartCtuJob            ( TEncWorkerContext* pcCtx, TComSlice* pcSlice );
+  Void     xFinishCtuJob           ( TEncWorkerContext* pcCtx );
+  Int      xCompressCtu            ( TEncWorkerContext* pcCtx, TComDataCU* pCtu );
+  Void     xAddCtuStatistics       ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const std::vector<Int>& raiCtuBits );
+  Void     xCompressSliceWpp       ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Void     xCompressCtuRowWpp      ( TEncWorkerContext* pcCtx, TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr,
+                                     const UInt uiRow, std::vector<Int>& raiCtuBits );
+  Void     xCompressSliceTiles     ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Void     xCompressCtusOfTile     ( TEncWorkerContext* pcCtx, TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr,
+                                     const UInt runStartTsAddr, const UInt runEndTsAddr, std::vector<Int>& raiCtuBits );
   Void     calculateBoundingCtuTsAddrForSlice(UInt &startCtuTSAddrSlice, UInt &boundingCtuTSAddrSlice, Bool &haveReachedTileBoundary, TComPic* pcPic, const Int sliceMode, const Int sliceArgument);
 
 public:
@@ -109,6 +135,7 @@ public:
   Void    create              ( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt iMaxCUWidth, UInt iMaxCUHeight, UChar uhTotalDepth );
   Void    destroy             ();
   Void    init                ( TEncTop* pcEncTop );
+  Void    init                ( TEncTop* pcEncTop, TEncWorkerContext* pcModules );
 
   /// preparation of slice encoding (reference marking, QP and lambda)
   Void    initEncSlice        ( TComPic*  pcPic, const Int pocLast, const Int pocCurr,
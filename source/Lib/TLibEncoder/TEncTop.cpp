@@ -55,9 +55,6 @@ TEncTop::TEncTop()
   m_iPOCLast          = -1;
   m_iNumPicRcvd       =  0;
   m_uiNumAllPicCoded  =  0;
-  m_pppcRDSbacCoder   =  NULL;
-  m_pppcBinCoderCABAC =  NULL;
-  m_cRDGoOnSbacCoder.init( &m_cRDGoOnBinCoderCABAC );
 #if ENC_DEC_TRACE
   if (g_hTrace == NULL)
   {
@@ -92,18 +89,11 @@ Void TEncTop::create ()
   // create processing unit classes
   m_cGOPEncoder.        create( );
   m_cSliceEncoder.      create( getSourceWidth(), getSourceHeight(), m_chromaFormatIDC, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth );
-  m_cCuEncoder.         create( m_maxTotalCUDepth, m_maxCUWidth, m_maxCUHeight, m_chromaFormatIDC );
   if (m_bUseSAO)
   {
     m_cEncSAO.create( getSourceWidth(), getSourceHeight(), m_chromaFormatIDC, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth, m_log2SaoOffsetScale[CHANNEL_TYPE_LUMA], m_log2SaoOffsetScale[CHANNEL_TYPE_CHROMA] );
     m_cEncSAO.createEncData(getSaoCtuBoundary());
   }
-#if ADAPTIVE_QP_SELECTION
-  if (m_bUseAdaptQpSelect)
-  {
-    m_cTrQuant.initSliceQpDelta();
-  }
-#endif
 
   m_cLoopFilter.create( m_maxTotalCUDepth );
 
@@ -113,33 +103,12 @@ Void TEncTop::create ()
                       m_maxCUWidth, m_maxCUHeight,m_RCKeepHierarchicalBit, m_RCUseLCUSeparateModel, m_GOPList );
   }
 
-  m_pppcRDSbacCoder = new TEncSbac** [m_maxTotalCUDepth+1];
-#if FAST_BIT_EST
-  m_pppcBinCoderCABAC = new TEncBinCABACCounter** [m_maxTotalCUDepth+1];
-#else
-  m_pppcBinCoderCABAC = new TEncBinCABAC** [m_maxTotalCUDepth+1];
-#endif
-
-  for ( Int iDepth = 0; iDepth < m_maxTotalCUDepth+1; iDepth++ )
-  {
-    m_pppcRDSbacCoder[iDepth] = new TEncSbac* [CI_NUM];
-#if FAST_BIT_EST
-    m_pppcBinCoderCABAC[iDepth] = new TEncBinCABACCounter* [CI_NUM];
-#else
-    m_pppcBinCoderCABAC[iDepth] = new TEncBinCABAC* [CI_NUM];
-#endif
-
-    for (Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx ++ )
-    {
-      m_pppcRDSbacCoder[iDepth][iCIIdx] = new TEncSbac;
-#if FAST_BIT_EST
-      m_pppcBinCoderCABAC [iDepth][iCIIdx] = new TEncBinCABACCounter;
-#else
-      m_pppcBinCoderCABAC [iDepth][iCIIdx] = new TEncBinCABAC;
-#endif
-      m_pppcRDSbacCoder   [iDepth][iCIIdx]->init( m_pppcBinCoderCABAC [iDepth][iCIIdx] );
-    }
-  }
+  // the thread pool is shared by the wavefront, tile, frame-parallel and motion estimation jobs, which use worker contexts
+  // of their own; the encoding modules of the encoder are the worker context of the serial compression
+  m_cThreadPool.create( m_iNumThreads );
+  m_cModules.create( this, &m_cRateCtrl, &m_cThreadPool );
+  m_cLoopFilter.setThreadPool( &m_cThreadPool );
+  m_cEncSAO.setThreadPool( &m_cThreadPool );
 }
 
 Void TEncTop::destroy ()
@@ -147,30 +116,12 @@ Void TEncTop::destroy ()
   // destroy processing unit classes
   m_cGOPEncoder.        destroy();
   m_cSliceEncoder.      destroy();
-  m_cCuEncoder.         destroy();
   m_cEncSAO.            destroyEncData();
   m_cEncSAO.            destroy();
   m_cLoopFilter.        destroy();
   m_cRateCtrl.          destroy();
-  m_cSearch.            destroy();
-  Int iDepth;
-  for ( iDepth = 0; iDepth < m_maxTotalCUDepth+1; iDepth++ )
-  {
-    for (Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx ++ )
-    {
-      delete m_pppcRDSbacCoder[iDepth][iCIIdx];
-      delete m_pppcBinCoderCABAC[iDepth][iCIIdx];
-    }
-  }
-
-  for ( iDepth = 0; iDepth < m_maxTotalCUDepth+1; iDepth++ )
-  {
-    delete [] m_pppcRDSbacCoder[iDepth];
-    delete [] m_pppcBinCoderCABAC[iDepth];
-  }
-
-  delete [] m_pppcRDSbacCoder;
-  delete [] m_pppcBinCoderCABAC;
+  m_cModules.           destroy();
+  m_cThreadPool.        destroy();
 
   // destroy ROM
   destroyROM();
@@ -190,8 +141,6 @@ Void TEncTop::init(Bool isFieldCoding)
     m_cRateCtrl.initHrdParam(m_cSPS.getVuiParameters()->getHrdParameters(), m_iFrameRate, m_RCInitialCpbFullness);
   }
 #endif
-  m_cRdCost.setCostMode(m_costMode);
-
   // initialize PPS
   xInitPPS();
   xInitRPS(isFieldCoding);
@@ -201,27 +150,9 @@ Void TEncTop::init(Bool isFieldCoding)
   // initialize processing unit classes
   m_cGOPEncoder.  init( this );
   m_cSliceEncoder.init( this );
-  m_cCuEncoder.   init( this );
 
-  // initialize transform & quantization class
   m_pcCavlcCoder = getCavlcCoder();
 
-  m_cTrQuant.init( 1 << m_uiQuadtreeTULog2MaxSize,
-                   m_useRDOQ,
-                   m_useRDOQTS,
-#if T0196_SELECTIVE_RDOQ
-                   m_useSelectiveRDOQ,
-#endif
-                   true
-                  ,m_useTransformSkipFast
-#if ADAPTIVE_QP_SELECTION
-                  ,m_bUseAdaptQpSelect
-#endif
-                  );
-
-  // initialize encoder search class
-  m_cSearch.init( this, &m_cTrQuant, m_iSearchRange, m_bipredSearchRange, m_motionEstimationSearchMethod, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth, &m_cEntropyCoder, &m_cRdCost, getRDSbacCoder(), getRDGoOnSbacCoder() );
-
   m_iMaxRefPicNum = 0;
 
   xInitScalingLists();
@@ -336,6 +267,10 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
     {
       m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcPicCurr ) );
     }
+    if ( getUsePyramidME() )
+    {
+      m_cPreanalyzer.xPreanalyzeMotion( dynamic_cast<TEncPic*>( pcPicCurr ), getSearchRange() );
+    }
   }
 
   if ((m_iNumPicRcvd == 0) || (!flush && (m_iPOCLast != 0) && (m_iNumPicRcvd != m_iGOPSize) && (m_iGOPSize != 0)))
@@ -447,6 +382,10 @@ Void TEncTop::encode(Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvTr
       {
         m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcField ) );
       }
+      if ( getUsePyramidME() )
+      {
+        m_cPreanalyzer.xPreanalyzeMotion( dynamic_cast<TEncPic*>( pcField ), getSearchRange() );
+      }
     }
 
     if ( m_iNumPicRcvd && ((flush&&fieldNum==1) || (m_iPOCLast/2)==0 || m_iNumPicRcvd==m_iGOPSize ) )
@@ -494,10 +433,14 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic )
   }
   else
   {
-    if ( getUseAdaptiveQP() )
+    if ( getUseAdaptiveQP() || getUsePyramidME() || getUseRecIntegralImages() )
     {
       TEncPic* pcEPic = new TEncPic;
-      pcEPic->create( m_cSPS, m_cPPS, m_cPPS.getMaxCuDQPDepth()+1, false);
+      pcEPic->create( m_cSPS, m_cPPS, getUseAdaptiveQP() ? m_cPPS.getMaxCuDQPDepth()+1 : 0, false);
+      if ( getUsePyramidME() )
+      {
+        pcEPic->createCoarseMvField( COARSE_MV_BLOCK_SIZE );
+      }
       rpcPic = pcEPic;
     }
     else
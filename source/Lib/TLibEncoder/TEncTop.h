@@ -54,6 +54,7 @@
 #include "TEncCavlc.h"
 #include "TEncSbac.h"
 #include "TEncSearch.h"
+#include "TEncWorkerContext.h"
 #include "TEncSampleAdaptiveOffset.h"
 #include "TEncPreanalyzer.h"
 #include "TEncRateCtrl.h"
@@ -74,37 +75,22 @@ private:
   UInt                    m_uiNumAllPicCoded;             ///< number of coded pictures
   TComList<TComPic*>      m_cListPic;                     ///< dynamic list of pictures
 
-  // encoder search
-  TEncSearch              m_cSearch;                      ///< encoder search class
   //TEncEntropy*            m_pcEntropyCoder;                     ///< entropy encoder
   TEncCavlc*              m_pcCavlcCoder;                       ///< CAVLC encoder
   // coding tool
-  TComTrQuant             m_cTrQuant;                     ///< transform & quantization class
   TComLoopFilter          m_cLoopFilter;                  ///< deblocking filter class
   TEncSampleAdaptiveOffset m_cEncSAO;                     ///< sample adaptive offset class
-  TEncEntropy             m_cEntropyCoder;                ///< entropy encoder
   TEncCavlc               m_cCavlcCoder;                  ///< CAVLC encoder
   TEncSbac                m_cSbacCoder;                   ///< SBAC encoder
-  TEncBinCABAC            m_cBinCoderCABAC;               ///< bin coder CABAC
 
   // processing unit
   TEncGOP                 m_cGOPEncoder;                  ///< GOP encoder
   TEncSlice               m_cSliceEncoder;                ///< slice encoder
-  TEncCu                  m_cCuEncoder;                   ///< CU encoder
+  TEncWorkerContext       m_cModules;                     ///< CU encoder, search, transform & quantization, entropy coder, RD cost and RD coders
+  TComThreadPool          m_cThreadPool;                  ///< threads of the parallel compression, shared by all its workers
   // SPS
   TComSPS                 m_cSPS;                         ///< SPS. This is the base value. This is copied to TComPicSym
   TComPPS                 m_cPPS;                         ///< PPS. This is the base value. This is copied to TComPicSym
-  // RD cost computation
-  TComRdCost              m_cRdCost;                      ///< RD cost computation class
-  TEncSbac***             m_pppcRDSbacCoder;              ///< temporal storage for RD computation
-  TEncSbac                m_cRDGoOnSbacCoder;             ///< going on SBAC model for RD stage
-#if FAST_BIT_EST
-  TEncBinCABACCounter***  m_pppcBinCoderCABAC;            ///< temporal CABAC state storage for RD computation
-  TEncBinCABACCounter     m_cRDGoOnBinCoderCABAC;         ///< going on bin coder CABAC for RD stage
-#else
-  TEncBinCABAC***         m_pppcBinCoderCABAC;            ///< temporal CABAC state storage for RD computation
-  TEncBinCABAC            m_cRDGoOnBinCoderCABAC;         ///< going on bin coder CABAC for RD stage
-#endif
 
   // quality control
   TEncPreanalyzer         m_cPreanalyzer;                 ///< image characteristics analyzer for TM5-step3-like adaptive QP
@@ -136,23 +122,24 @@ public:
   // -------------------------------------------------------------------------------------------------------------------
 
   TComList<TComPic*>*     getListPic            () { return  &m_cListPic;             }
-  TEncSearch*             getPredSearch         () { return  &m_cSearch;              }
+  TEncSearch*             getPredSearch         () { return  &m_cModules.m_cSearch;   }
 
-  TComTrQuant*            getTrQuant            () { return  &m_cTrQuant;             }
+  TComTrQuant*            getTrQuant            () { return  &m_cModules.m_cTrQuant;  }
   TComLoopFilter*         getLoopFilter         () { return  &m_cLoopFilter;          }
   TEncSampleAdaptiveOffset* getSAO              () { return  &m_cEncSAO;              }
   TEncGOP*                getGOPEncoder         () { return  &m_cGOPEncoder;          }
   TEncSlice*              getSliceEncoder       () { return  &m_cSliceEncoder;        }
-  TEncCu*                 getCuEncoder          () { return  &m_cCuEncoder;           }
-  TEncEntropy*            getEntropyCoder       () { return  &m_cEntropyCoder;        }
+  TEncCu*                 getCuEncoder          () { return  &m_cModules.m_cCuEncoder; }
+  TEncEntropy*            getEntropyCoder       () { return  &m_cModules.m_cEntropyCoder; }
   TEncCavlc*              getCavlcCoder         () { return  &m_cCavlcCoder;          }
   TEncSbac*               getSbacCoder          () { return  &m_cSbacCoder;           }
-  TEncBinCABAC*           getBinCABAC           () { return  &m_cBinCoderCABAC;       }
+  TEncBinCABAC*           getBinCABAC           () { return  &m_cModules.m_cBinCoderCABAC; }
 
-  TComRdCost*             getRdCost             () { return  &m_cRdCost;              }
-  TEncSbac***             getRDSbacCoder        () { return  m_pppcRDSbacCoder;       }
-  TEncSbac*               getRDGoOnSbacCoder    () { return  &m_cRDGoOnSbacCoder;     }
+  TComRdCost*             getRdCost             () { return  &m_cModules.m_cRdCost;   }
+  TEncSbac***             getRDSbacCoder        () { return  m_cModules.m_pppcRDSbacCoder; }
+  TEncSbac*               getRDGoOnSbacCoder    () { return  &m_cModules.m_cRDGoOnSbacCoder; }
   TEncRateCtrl*           getRateCtrl           () { return &m_cRateCtrl;             }
+  TComThreadPool*         getThreadPool         () { return  &m_cThreadPool;         }
   Void selectReferencePictureSet(TComSlice* slice, Int POCCurr, Int GOPid );
   Int getReferencePictureSetIdxForSOP(Int POCCurr, Int GOPid );
   // -------------------------------------------------------------------------------------------------------------------
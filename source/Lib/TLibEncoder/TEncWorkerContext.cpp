@@ -0,0 +1,173 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncWorkerContext.cpp
+    \brief    set of CTU encoding modules
+*/
+
+#include "TEncWorkerContext.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Constructor / destructor / create / destroy
+// ====================================================================================================================
+
+TEncWorkerContext::TEncWorkerContext()
+: m_pppcRDSbacCoder  (NULL)
+, m_pppcBinCoderCABAC(NULL)
+, m_uiNumDepths      (0)
+{
+  m_cRDGoOnSbacCoder.init( &m_cRDGoOnBinCoderCABAC );
+}
+
+TEncWorkerContext::~TEncWorkerContext()
+{
+  destroy();
+}
+
+/** Create and initialise the modules
+ * \param pcCfg        encoder configuration
+ * \param pcRateCtrl   rate control of the encoder
+ * \param pcThreadPool thread pool of the encoder, on which the search runs its motion estimation jobs
+ */
+Void TEncWorkerContext::create( TEncCfg* pcCfg, TEncRateCtrl* pcRateCtrl, TComThreadPool* pcThreadPool )
+{
+  m_uiNumDepths = pcCfg->getMaxTotalCUDepth() + 1;
+
+  m_pppcRDSbacCoder = new TEncSbac** [m_uiNumDepths];
+#if FAST_BIT_EST
+  m_pppcBinCoderCABAC = new TEncBinCABACCounter** [m_uiNumDepths];
+#else
+  m_pppcBinCoderCABAC = new TEncBinCABAC** [m_uiNumDepths];
+#endif
+  for ( UInt uiDepth = 0; uiDepth < m_uiNumDepths; uiDepth++ )
+  {
+    m_pppcRDSbacCoder[uiDepth] = new TEncSbac* [CI_NUM];
+#if FAST_BIT_EST
+    m_pppcBinCoderCABAC[uiDepth] = new TEncBinCABACCounter* [CI_NUM];
+#else
+    m_pppcBinCoderCABAC[uiDepth] = new TEncBinCABAC* [CI_NUM];
+#endif
+    for ( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+    {
+      m_pppcRDSbacCoder[uiDepth][iCIIdx] = new TEncSbac;
+#if FAST_BIT_EST
+      m_pppcBinCoderCABAC[uiDepth][iCIIdx] = new TEncBinCABACCounter;
+#else
+      m_pppcBinCoderCABAC[uiDepth][iCIIdx] = new TEncBinCABAC;
+#endif
+      m_pppcRDSbacCoder[uiDepth][iCIIdx]->init( m_pppcBinCoderCABAC[uiDepth][iCIIdx] );
+    }
+  }
+
+  m_cCuEncoder.create( pcCfg->getMaxTotalCUDepth(), pcCfg->getMaxCUWidth(), pcCfg->getMaxCUHeight(), pcCfg->getChromaFormatIdc() );
+  m_cRdCost.setCostMode( pcCfg->getCostMode() );
+#if ADAPTIVE_QP_SELECTION
+  if ( pcCfg->getUseAdaptQpSelect() )
+  {
+    m_cTrQuant.initSliceQpDelta();
+  }
+#endif
+
+  m_cTrQuant.init( 1 << pcCfg->getQuadtreeTULog2MaxSize(),
+                   pcCfg->getUseRDOQ(),
+                   pcCfg->getUseRDOQTS(),
+#if T0196_SELECTIVE_RDOQ
+                   pcCfg->getUseSelectiveRDOQ(),
+#endif
+                   true
+                  ,pcCfg->getUseTransformSkipFast()
+#if ADAPTIVE_QP_SELECTION
+                  ,pcCfg->getUseAdaptQpSelect()
+#endif
+                  );
+  m_cTrQuant.setUseFastRDOQ( pcCfg->getUseFastRDOQ() );
+
+  m_cSearch.init( pcCfg, &m_cTrQuant, pcCfg->getSearchRange(), pcCfg->getBipredSearchRange(), pcCfg->getMotionEstimationSearchMethod(),
+                  pcCfg->getMaxCUWidth(), pcCfg->getMaxCUHeight(), pcCfg->getMaxTotalCUDepth(), &m_cEntropyCoder, &m_cRdCost,
+                  m_pppcRDSbacCoder, &m_cRDGoOnSbacCoder, pcThreadPool );
+  m_cCuEncoder.init( pcCfg, &m_cSearch, &m_cTrQuant, &m_cRdCost, &m_cEntropyCoder, &m_cBinCoderCABAC,
+                     m_pppcRDSbacCoder, &m_cRDGoOnSbacCoder, pcRateCtrl );
+}
+
+/** Set up the scaling lists of the transform module in the same way as the encoder does for its own one
+ * \param pcCfg encoder configuration
+ * \param pcSPS SPS holding the scaling lists
+ */
+Void TEncWorkerContext::initScalingList( TEncCfg* pcCfg, const TComSPS* pcSPS )
+{
+  const Int maxLog2TrDynamicRange[MAX_NUM_CHANNEL_TYPE] =
+  {
+    pcSPS->getMaxLog2TrDynamicRange(CHANNEL_TYPE_LUMA),
+    pcSPS->getMaxLog2TrDynamicRange(CHANNEL_TYPE_CHROMA)
+  };
+  if ( pcCfg->getUseScalingListId() == SCALING_LIST_OFF )
+  {
+    m_cTrQuant.setFlatScalingList( maxLog2TrDynamicRange, pcSPS->getBitDepths() );
+    m_cTrQuant.setUseScalingList( false );
+  }
+  else
+  {
+    TComScalingList cScalingList = pcSPS->getScalingList();
+    m_cTrQuant.setScalingList( &cScalingList, maxLog2TrDynamicRange, pcSPS->getBitDepths() );
+    m_cTrQuant.setUseScalingList( true );
+  }
+}
+
+Void TEncWorkerContext::destroy()
+{
+  if ( m_pppcRDSbacCoder == NULL )
+  {
+    return;
+  }
+  m_cCuEncoder.destroy();
+  m_cSearch.destroy();
+  for ( UInt uiDepth = 0; uiDepth < m_uiNumDepths; uiDepth++ )
+  {
+    for ( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+    {
+      delete m_pppcRDSbacCoder[uiDepth][iCIIdx];
+      delete m_pppcBinCoderCABAC[uiDepth][iCIIdx];
+    }
+    delete [] m_pppcRDSbacCoder[uiDepth];
+    delete [] m_pppcBinCoderCABAC[uiDepth];
+  }
+  delete [] m_pppcRDSbacCoder;
+  delete [] m_pppcBinCoderCABAC;
+  m_pppcRDSbacCoder   = NULL;
+  m_pppcBinCoderCABAC = NULL;
+}
+
+//! \}
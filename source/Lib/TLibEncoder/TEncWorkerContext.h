@@ -0,0 +1,90 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncWorkerContext.h
+    \brief    set of CTU encoding modules (header)
+*/
+
+#ifndef __TENCWORKERCONTEXT__
+#define __TENCWORKERCONTEXT__
+
+// Include files
+#include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComThreadPool.h"
+#include "TEncCu.h"
+#include "TEncRateCtrl.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// full set of CTU encoding modules: the one of the encoder, or a private one of a worker of the parallel compression
+/// (wavefront CTU row or tile job, picture encoder of the frame-parallel compression)
+class TEncWorkerContext
+{
+public:
+  TEncCu                  m_cCuEncoder;
+  TEncSearch              m_cSearch;
+  TComTrQuant             m_cTrQuant;
+  TComRdCost              m_cRdCost;
+  TEncEntropy             m_cEntropyCoder;
+  TEncBinCABAC            m_cBinCoderCABAC;
+  TEncSbac***             m_pppcRDSbacCoder;
+  TEncSbac                m_cRDGoOnSbacCoder;
+#if FAST_BIT_EST
+  TEncBinCABACCounter***  m_pppcBinCoderCABAC;
+  TEncBinCABACCounter     m_cRDGoOnBinCoderCABAC;
+#else
+  TEncBinCABAC***         m_pppcBinCoderCABAC;
+  TEncBinCABAC            m_cRDGoOnBinCoderCABAC;
+#endif
+  TComBitCounter          m_cBitCounter;
+
+  TEncWorkerContext();
+  virtual ~TEncWorkerContext();
+
+  Void create ( TEncCfg* pcCfg, TEncRateCtrl* pcRateCtrl, TComThreadPool* pcThreadPool );
+  Void destroy();
+  Void initScalingList( TEncCfg* pcCfg, const TComSPS* pcSPS );
+
+private:
+  UInt                    m_uiNumDepths;
+};
+
+
+//! \}
+
+#endif // __TENCWORKERCONTEXT__
@@ -42,6 +42,18 @@
 #include <fstream>
 #include <iostream>
 #include <memory.h>
+#include <sstream>
+#include <ctype.h>
+#include <stdio.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#if defined(__SSE2__) && !RExt__HIGH_BIT_DEPTH_SUPPORT
+#include <emmintrin.h>
+#endif
 
 #include "TLibCommon/TComRom.h"
 #include "TVideoIOYuv.h"
@@ -117,7 +129,7 @@ copyPlane(const TComPicYuv &src, const ComponentID srcPlane, TComPicYuv &dest, c
  * \param MSBExtendedBitDepth
  * \param internalBitDepth bit-depth array to scale image data to/from when reading/writing.
  */
-Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE] )
+Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE], Bool bMemoryMapped )
 {
   //NOTE: files cannot have bit depth greater than 16
   for(UInt ch=0; ch<MAX_NUM_CHANNEL_TYPE; ch++)
@@ -140,6 +152,12 @@ Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int
     }
   }
 
+  if ( !bWriteMode && isStreaming() )
+  {
+    // already opened by openStreaming(), only the bit depths are set here
+    return;
+  }
+
   if ( bWriteMode )
   {
     m_cHandle.open( fileName.c_str(), ios::binary | ios::out );
@@ -152,6 +170,36 @@ Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int
   }
   else
   {
+#ifndef _WIN32
+    // map regular files into memory, so that frames are read in place and skipping frames is a pointer offset;
+    // anything that cannot be mapped (pipes, devices, empty files) is read through the file stream
+    if ( bMemoryMapped )
+    {
+      const Int fd = ::open( fileName.c_str(), O_RDONLY );
+      struct stat fileStat;
+      if ( fd >= 0 && fstat( fd, &fileStat ) == 0 && S_ISREG( fileStat.st_mode ) && fileStat.st_size > 0 )
+      {
+        void* pMapped = mmap( NULL, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( pMapped != MAP_FAILED )
+        {
+          madvise( pMapped, size_t(fileStat.st_size), MADV_SEQUENTIAL );
+          m_pMappedFile    = static_cast<const UChar*>( pMapped );
+          m_mappedFileSize = size_t(fileStat.st_size);
+          m_mappedFilePos  = 0;
+          m_mappedFileEof  = false;
+        }
+      }
+      if ( fd >= 0 )
+      {
+        ::close( fd );
+      }
+      if ( m_pMappedFile != NULL )
+      {
+        return;
+      }
+    }
+#endif
+
     m_cHandle.open( fileName.c_str(), ios::binary | ios::in );
 
     if( m_cHandle.fail() )
@@ -164,21 +212,241 @@ Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int
   return;
 }
 
+/**
+ * Open an input for forward-only reading: a file, a named pipe, or stdin if fileName is "-".
+ * The input is never seeked, skipped frames are read and discarded.
+ * If the input starts with a Y4M stream header, the header is parsed into y4mInfo and the FRAME header
+ * preceding each picture is consumed by read() and skipFrames(). open() is still called to set the bit depths.
+ *
+ * \param fileName         file name string, "-" for stdin
+ * \param y4mInfo          geometry and format of a Y4M input
+ * \return true if the input is a Y4M stream
+ */
+Bool TVideoIOYuv::openStreaming( const std::string &fileName, TVideoIOY4MInfo &y4mInfo )
+{
+  if ( fileName == "-" )
+  {
+#ifdef _WIN32
+    _setmode( _fileno( stdin ), _O_BINARY );
+#endif
+    m_pcInputStream = &std::cin;
+  }
+  else
+  {
+    m_cHandle.open( fileName.c_str(), ios::binary | ios::in );
+
+    if( m_cHandle.fail() )
+    {
+      printf("\nfailed to open Input YUV file\n");
+      exit(0);
+    }
+    m_pcInputStream = &m_cHandle;
+  }
+
+  static const TChar y4mSignature[] = "YUV4MPEG2";
+  const size_t signatureLength = sizeof(y4mSignature) - 1;
+  TChar signature[sizeof(y4mSignature)];
+  m_pcInputStream->read( signature, signatureLength );
+  const size_t probedBytes = size_t( m_pcInputStream->gcount() );
+  m_bY4M = probedBytes == signatureLength && memcmp( signature, y4mSignature, signatureLength ) == 0;
+  if ( !m_bY4M )
+  {
+    // raw input: the probed bytes are the start of the first picture
+    m_streamPrefix.assign( signature, probedBytes );
+    return false;
+  }
+
+  y4mInfo.width        = 0;
+  y4mInfo.height       = 0;
+  y4mInfo.frameRateNum = 0;
+  y4mInfo.frameRateDen = 1;
+  y4mInfo.chromaFormat = CHROMA_420;
+  y4mInfo.bitDepth     = 8;
+
+  std::string header;
+  std::getline( *m_pcInputStream, header );
+  std::istringstream tokens( header );
+  std::string token;
+  while ( tokens >> token )
+  {
+    const std::string value = token.substr( 1 );
+    switch ( token[0] )
+    {
+      case 'W':
+        y4mInfo.width  = atoi( value.c_str() );
+        break;
+      case 'H':
+        y4mInfo.height = atoi( value.c_str() );
+        break;
+      case 'F':
+        if ( sscanf( value.c_str(), "%d:%d", &y4mInfo.frameRateNum, &y4mInfo.frameRateDen ) != 2 || y4mInfo.frameRateDen <= 0 )
+        {
+          y4mInfo.frameRateNum = 0;
+          y4mInfo.frameRateDen = 1;
+        }
+        break;
+      case 'C':
+        // mono, mono16, 420, 420jpeg, 420paldv, 420mpeg2, 420p10, 422, 422p12, 444, 444p16, ...
+        if ( value.compare( 0, 4, "mono" ) == 0 )
+        {
+          y4mInfo.chromaFormat = CHROMA_400;
+          y4mInfo.bitDepth     = value.size() > 4 ? atoi( value.c_str() + 4 ) : 8;
+        }
+        else
+        {
+          const Int chromaFormat = atoi( value.c_str() );
+          if ( ( chromaFormat != 420 && chromaFormat != 422 && chromaFormat != 444 ) || value.compare( 3, std::string::npos, "alpha" ) == 0 )
+          {
+            std::cerr << "\nERROR: unsupported Y4M colour space C" << value << "\n" << std::endl;
+            exit(EXIT_FAILURE);
+          }
+          y4mInfo.chromaFormat = chromaFormat == 444 ? CHROMA_444 : ( chromaFormat == 422 ? CHROMA_422 : CHROMA_420 );
+          if ( value.size() > 4 && value[3] == 'p' && isdigit( value[4] ) )
+          {
+            y4mInfo.bitDepth = atoi( value.c_str() + 4 );
+          }
+        }
+        break;
+      default:
+        // I (interlacing), A (pixel aspect ratio) and X (application data) do not affect the encoder input
+        break;
+    }
+  }
+
+  if ( y4mInfo.width <= 0 || y4mInfo.height <= 0 )
+  {
+    std::cerr << "\nERROR: Y4M stream header without picture size\n" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+/**
+ * Consume the "FRAME" header line preceding each picture of a Y4M stream.
+ *
+ * \return false at the end of the stream
+ */
+Bool TVideoIOYuv::xReadY4MFrameHeader()
+{
+  std::string header;
+  if ( !std::getline( *m_pcInputStream, header ) )
+  {
+    return false;
+  }
+  if ( header.compare( 0, 5, "FRAME" ) != 0 )
+  {
+    std::cerr << "\nERROR: missing FRAME header in Y4M input\n" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
 Void TVideoIOYuv::close()
 {
+  if ( m_pcInputStream != NULL )
+  {
+    m_pcInputStream = NULL;
+    m_streamPrefix.clear();
+    m_bY4M          = false;
+  }
+#ifndef _WIN32
+  if ( m_pMappedFile != NULL )
+  {
+    munmap( const_cast<UChar*>( m_pMappedFile ), m_mappedFileSize );
+    m_pMappedFile    = NULL;
+    m_mappedFileSize = 0;
+    return;
+  }
+#endif
   m_cHandle.close();
 }
 
 Bool TVideoIOYuv::isEof()
 {
+  if ( m_pMappedFile != NULL )
+  {
+    return m_mappedFileEof;
+  }
+  if ( m_pcInputStream != NULL )
+  {
+    return m_streamPrefix.empty() && m_pcInputStream->eof();
+  }
   return m_cHandle.eof();
 }
 
 Bool TVideoIOYuv::isFail()
 {
+  if ( m_pMappedFile != NULL )
+  {
+    return m_mappedFileEof;
+  }
+  if ( m_pcInputStream != NULL )
+  {
+    return m_pcInputStream->fail();
+  }
   return m_cHandle.fail();
 }
 
+/// Input of readPlane(): a file stream, or a memory-mapped file that is read in place
+struct InputFile
+{
+  istream&     fd;
+  const UChar* mapped;                                      ///< memory-mapped file, NULL to read from fd
+  size_t       mappedSize;
+  size_t&      mappedPos;
+  Bool&        mappedEof;
+  Bool         seekable;                                    ///< fd may be seeked, otherwise skipped bytes are read and discarded
+  std::string& prefix;                                      ///< bytes already taken from fd, read before fd
+
+  /// read numBytes bytes, into buf when reading from fd; returns the bytes read, or NULL at the end of the file
+  const UChar* read(UChar* buf, size_t numBytes)
+  {
+    if (mapped == NULL)
+    {
+      const size_t prefixBytes = std::min(numBytes, prefix.size());
+      if (prefixBytes > 0)
+      {
+        memcpy(buf, prefix.data(), prefixBytes);
+        prefix.erase(0, prefixBytes);
+      }
+      fd.read(reinterpret_cast<TChar*>(buf) + prefixBytes, numBytes - prefixBytes);
+      return (fd.eof() || fd.fail()) ? NULL : buf;
+    }
+    if (mappedPos + numBytes > mappedSize)
+    {
+      mappedEof = true;
+      return NULL;
+    }
+    const UChar* bytes = mapped + mappedPos;
+    mappedPos += numBytes;
+    return bytes;
+  }
+
+  /// skip numBytes bytes; false at the end of the file
+  Bool skip(size_t numBytes)
+  {
+    if (mapped == NULL && !seekable)
+    {
+      UChar buf[4096];
+      for (size_t i = 0; i < numBytes; i += sizeof(buf))
+      {
+        if (read(buf, std::min(numBytes - i, sizeof(buf))) == NULL)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (mapped == NULL)
+    {
+      fd.seekg(numBytes, ios::cur);
+      return !(fd.eof() || fd.fail());
+    }
+    mappedPos += numBytes;
+    return true;
+  }
+};
+
 /**
  * Skip numFrames in input.
  *
@@ -208,8 +476,29 @@ Void TVideoIOYuv::skipFrames(UInt numFrames, UInt width, UInt height, ChromaForm
   frameSize *= wordsize;
   //------------------
 
+  /* forward-only input stream: read and discard the frames, including their Y4M frame headers */
+  if (isStreaming())
+  {
+    InputFile inputFile = { *m_pcInputStream, NULL, 0, m_mappedFilePos, m_mappedFileEof, false, m_streamPrefix };
+    for (UInt frame = 0; frame < numFrames; frame++)
+    {
+      if ((m_bY4M && !xReadY4MFrameHeader()) || !inputFile.skip(size_t(frameSize)))
+      {
+        return;
+      }
+    }
+    return;
+  }
+
   const streamoff offset = frameSize * numFrames;
 
+  /* memory-mapped file: move the read position */
+  if (m_pMappedFile != NULL)
+  {
+    m_mappedFilePos += size_t(offset);
+    return;
+  }
+
   /* attempt to seek */
   if (!!m_cHandle.seekg(offset, ios::cur))
   {
@@ -227,13 +516,34 @@ Void TVideoIOYuv::skipFrames(UInt numFrames, UInt width, UInt height, ChromaForm
   m_cHandle.read(buf, offset_mod_bufsize);
 }
 
+/**
+ * Widen a line of 8-bit samples to Pel.
+ */
+static inline Void widenLine8(Pel* dst, const UChar* src, const UInt width)
+{
+  UInt x = 0;
+#if defined(__SSE2__) && !RExt__HIGH_BIT_DEPTH_SUPPORT
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 16 <= width; x += 16)
+  {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x    ), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 8), _mm_unpackhi_epi8(bytes, zero));
+  }
+#endif
+  for (; x < width; x++)
+  {
+    dst[x] = src[x];
+  }
+}
+
 /**
  * Read width*height pixels from fd into dst, optionally
  * padding the left and right edges by edge-extension.  Input may be
  * either 8bit or 16bit little-endian lsb-aligned words.
  *
  * @param dst          destination image plane
- * @param fd           input file stream
+ * @param fd           input file stream or memory-mapped file
  * @param is16bit      true if input file carries > 8bit data, false otherwise.
  * @param stride444    distance between vertically adjacent pixels of dst.
  * @param width444     width of active area in dst.
@@ -247,7 +557,7 @@ Void TVideoIOYuv::skipFrames(UInt numFrames, UInt width, UInt height, ChromaForm
  * @return true for success, false in case of error
  */
 static Bool readPlane(Pel* dst,
-                      istream& fd,
+                      InputFile& fd,
                       Bool is16bit,
                       UInt stride444,
                       UInt width444,
@@ -275,7 +585,7 @@ static Bool readPlane(Pel* dst,
 
   const UInt stride_file      = (width444 * (is16bit ? 2 : 1)) >> csx_file;
   std::vector<UChar> bufVec(stride_file);
-  UChar *buf=&(bufVec[0]);
+  const UChar *buf=&(bufVec[0]);
 
   if (compID!=COMPONENT_Y && (fileFormat==CHROMA_400 || destFormat==CHROMA_400))
   {
@@ -295,8 +605,7 @@ static Bool readPlane(Pel* dst,
     if (fileFormat!=CHROMA_400)
     {
       const UInt height_file      = height444>>csy_file;
-      fd.seekg(height_file*stride_file, ios::cur);
-      if (fd.eof() || fd.fail() )
+      if (!fd.skip(height_file*stride_file))
       {
         return false;
       }
@@ -310,9 +619,9 @@ static Bool readPlane(Pel* dst,
     {
       if ((y444&mask_y_file)==0)
       {
-        // read a new line
-        fd.read(reinterpret_cast<TChar*>(buf), stride_file);
-        if (fd.eof() || fd.fail() )
+        // read a new line, in place when the file is memory-mapped
+        buf = fd.read(&(bufVec[0]), stride_file);
+        if (buf == NULL)
         {
           return false;
         }
@@ -344,7 +653,11 @@ static Bool readPlane(Pel* dst,
         {
           // eg file is 422, dest is 444.
           const UInt sx=csx_file-csx_dest;
-          if (!is16bit)
+          if (!is16bit && sx == 0)
+          {
+            widenLine8(dst, buf, width_dest);
+          }
+          else if (!is16bit)
           {
             for (UInt x = 0; x < width_dest; x++)
             {
@@ -707,6 +1020,14 @@ Bool TVideoIOYuv::read ( TComPicYuv*  pPicYuvUser, TComPicYuv* pPicYuvTrueOrg, c
   const UInt width444       = width_full444 - pad_h444;
   const UInt height444      = height_full444 - pad_v444;
 
+  // a Y4M stream has a FRAME header in front of each picture
+  if ( m_bY4M && !xReadY4MFrameHeader() )
+  {
+    return false;
+  }
+
+  InputFile inputFile = { isStreaming() ? *m_pcInputStream : m_cHandle, m_pMappedFile, m_mappedFileSize, m_mappedFilePos, m_mappedFileEof, !isStreaming(), m_streamPrefix };
+
   for(UInt comp=0; comp<MAX_NUM_COMPONENT; comp++)
   {
     const ComponentID compID = ComponentID(comp);
@@ -718,7 +1039,7 @@ Bool TVideoIOYuv::read ( TComPicYuv*  pPicYuvUser, TComPicYuv* pPicYuvTrueOrg, c
     const Pel minval = b709Compliance? ((   1 << (desired_bitdepth - 8))   ) : 0;
     const Pel maxval = b709Compliance? ((0xff << (desired_bitdepth - 8)) -1) : (1 << desired_bitdepth) - 1;
 
-    if (! readPlane(pPicYuv->getAddr(compID), m_cHandle, is16bit, stride444, width444, height444, pad_h444, pad_v444, compID, pPicYuv->getChromaFormat(), format, m_fileBitdepth[chType]))
+    if (! readPlane(pPicYuv->getAddr(compID), inputFile, is16bit, stride444, width444, height444, pad_h444, pad_v444, compID, pPicYuv->getChromaFormat(), format, m_fileBitdepth[chType]))
     {
       return false;
     }
@@ -50,6 +50,17 @@ using namespace std;
 // Class definition
 // ====================================================================================================================
 
+/// picture geometry and format given by the stream header of a Y4M input
+struct TVideoIOY4MInfo
+{
+  Int          width;                                       ///< picture width (W)
+  Int          height;                                      ///< picture height (H)
+  Int          frameRateNum;                                ///< frame rate numerator (F)
+  Int          frameRateDen;                                ///< frame rate denominator (F)
+  ChromaFormat chromaFormat;                                ///< chroma format (C)
+  Int          bitDepth;                                    ///< sample bit depth (C, e.g. 420p10)
+};
+
 /// YUV file I/O class
 class TVideoIOYuv
 {
@@ -59,11 +70,24 @@ private:
   Int       m_MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE];  ///< bitdepth after addition of MSBs (with value 0)
   Int       m_bitdepthShift[MAX_NUM_CHANNEL_TYPE];  ///< number of bits to increase or decrease image by before/after write/read
 
+  const UChar* m_pMappedFile;                               ///< memory-mapped input file, NULL when reading through m_cHandle
+  size_t    m_mappedFileSize;                               ///< size of the memory-mapped input file
+  size_t    m_mappedFilePos;                                ///< read position in the memory-mapped input file
+  Bool      m_mappedFileEof;                                ///< end of the memory-mapped input file reached
+
+  istream*  m_pcInputStream;                                ///< forward-only input stream (m_cHandle or stdin), NULL unless opened by openStreaming
+  std::string m_streamPrefix;                               ///< bytes read while probing the input stream for a Y4M header, read before the stream
+  Bool      m_bY4M;                                         ///< input stream carries Y4M stream and frame headers
+
+  Bool  xReadY4MFrameHeader();                              ///< consume the FRAME header preceding each picture of a Y4M stream
+
 public:
-  TVideoIOYuv()           {}
-  virtual ~TVideoIOYuv()  {}
+  TVideoIOYuv() : m_pMappedFile(NULL), m_mappedFileSize(0), m_mappedFilePos(0), m_mappedFileEof(false), m_pcInputStream(NULL), m_bY4M(false) {}
+  virtual ~TVideoIOYuv()  { close(); }
 
-  Void  open  ( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE] ); ///< open or create file
+  Void  open  ( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE], Bool bMemoryMapped=false ); ///< open or create file, memory-mapped if possible when bMemoryMapped is set in read mode
+  Bool  openStreaming ( const std::string &fileName, TVideoIOY4MInfo &y4mInfo ); ///< open a pipe, a file or stdin ("-") for forward-only reading; true if it starts with a Y4M stream header, which is returned in y4mInfo
+  Bool  isStreaming () const { return m_pcInputStream != NULL; }
   Void  close ();                                           ///< close file
 
   Void skipFrames(UInt numFrames, UInt width, UInt height, ChromaFormat format);
@@ -0,0 +1,237 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvReader.cpp
+    \brief    prefetching YUV file reader class
+*/
+
+#include <assert.h>
+
+#include "TVideoIOYuvReader.h"
+
+TVideoIOYuvReader::TVideoIOYuvReader()
+: m_pcFile         ( NULL )
+, m_iPrefetchDepth ( 0 )
+, m_iReadSlot      ( -1 )
+, m_iNumFramesLeft ( 0 )
+, m_bEof           ( false )
+, m_bStop          ( false )
+{
+}
+
+TVideoIOYuvReader::~TVideoIOYuvReader()
+{
+  destroy();
+}
+
+/**
+ * Allocate the pictures of the reader: one frame for the caller and iPrefetchDepth frames read ahead.
+ *
+ * @param pcFile           opened input file
+ * @param iPrefetchDepth   number of frames read ahead by the reader thread (0: no thread, read() reads from the file)
+ */
+Void TVideoIOYuvReader::create( TVideoIOYuv* pcFile, Int iPrefetchDepth, Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth )
+{
+  destroy();
+
+  m_pcFile         = pcFile;
+  m_iPrefetchDepth = iPrefetchDepth;
+
+  for ( Int iSlot = 0; iSlot <= iPrefetchDepth; iSlot++ )
+  {
+    m_apcPicYuv.push_back( new TComPicYuv );
+    m_apcPicYuv.back()->create( iWidth, iHeight, chromaFormat, uiMaxCUWidth, uiMaxCUHeight, uiMaxCUDepth, true );
+    m_apcPicYuvTrueOrg.push_back( new TComPicYuv );
+    m_apcPicYuvTrueOrg.back()->create( iWidth, iHeight, chromaFormat, uiMaxCUWidth, uiMaxCUHeight, uiMaxCUDepth, true );
+    m_aiFreeSlots.push_back( iSlot );
+  }
+}
+
+Void TVideoIOYuvReader::destroy()
+{
+  if ( m_cThread.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> cLock( m_cMutex );
+      m_bStop = true;
+    }
+    m_cCond.notify_all();
+    m_cThread.join();
+  }
+
+  for ( UInt uiSlot = 0; uiSlot < m_apcPicYuv.size(); uiSlot++ )
+  {
+    m_apcPicYuv[uiSlot]->destroy();
+    delete m_apcPicYuv[uiSlot];
+    m_apcPicYuvTrueOrg[uiSlot]->destroy();
+    delete m_apcPicYuvTrueOrg[uiSlot];
+  }
+  m_apcPicYuv.clear();
+  m_apcPicYuvTrueOrg.clear();
+  m_aiFreeSlots.clear();
+  m_aiFilledSlots.clear();
+  m_iReadSlot = -1;
+  m_bEof      = false;
+  m_bStop     = false;
+}
+
+Void TVideoIOYuvReader::start( Int iNumFrames, UInt uiSkipFrames, UInt uiSkipWidth, UInt uiSkipHeight, const InputColourSpaceConversion ipcsc, const Int aiPad[2], ChromaFormat fileFormat, const Bool bClipToRec709 )
+{
+  m_iNumFramesLeft = iNumFrames;
+  m_uiSkipFrames   = uiSkipFrames;
+  m_uiSkipWidth    = uiSkipWidth;
+  m_uiSkipHeight   = uiSkipHeight;
+  m_ipCSC          = ipcsc;
+  m_aiPad[0]       = aiPad[0];
+  m_aiPad[1]       = aiPad[1];
+  m_fileFormat     = fileFormat;
+  m_bClipToRec709  = bClipToRec709;
+
+  if ( m_iPrefetchDepth > 0 )
+  {
+    m_cThread = std::thread( &TVideoIOYuvReader::xReaderThread, this );
+  }
+}
+
+Bool TVideoIOYuvReader::xReadFrame( Int iSlot )
+{
+  if ( m_iNumFramesLeft <= 0 )
+  {
+    return false;
+  }
+
+  // the end of the file is only detected on a read failure
+  m_pcFile->read( m_apcPicYuv[iSlot], m_apcPicYuvTrueOrg[iSlot], m_ipCSC, m_aiPad, m_fileFormat, m_bClipToRec709 );
+  if ( m_pcFile->isEof() )
+  {
+    return false;
+  }
+  m_iNumFramesLeft--;
+
+  // temporally skip frames
+  if ( m_uiSkipFrames > 0 )
+  {
+    m_pcFile->skipFrames( m_uiSkipFrames, m_uiSkipWidth, m_uiSkipHeight, m_fileFormat );
+  }
+  return true;
+}
+
+Void TVideoIOYuvReader::xReaderThread()
+{
+  while ( true )
+  {
+    Int iSlot;
+    {
+      std::unique_lock<std::mutex> cLock( m_cMutex );
+      m_cCond.wait( cLock, [&]{ return m_bStop || !m_aiFreeSlots.empty(); } );
+      if ( m_bStop )
+      {
+        return;
+      }
+      iSlot = m_aiFreeSlots.front();
+      m_aiFreeSlots.pop_front();
+    }
+
+    const Bool bRead = xReadFrame( iSlot );
+    {
+      std::lock_guard<std::mutex> cLock( m_cMutex );
+      if ( bRead )
+      {
+        m_aiFilledSlots.push_back( iSlot );
+      }
+      else
+      {
+        m_aiFreeSlots.push_front( iSlot );
+        m_bEof = true;
+      }
+    }
+    m_cCond.notify_all();
+    if ( !bRead )
+    {
+      return;
+    }
+  }
+}
+
+/**
+ * Get the next frame of the file, waiting for the reader thread if it has not been read yet.
+ *
+ * @param rpcPicYuv         picture converted to the internal format
+ * @param rpcPicYuvTrueOrg  picture as read from the file
+ * @return false at the end of the file or once all frames given to start() are read
+ */
+Bool TVideoIOYuvReader::read( TComPicYuv*& rpcPicYuv, TComPicYuv*& rpcPicYuvTrueOrg )
+{
+  assert( m_iReadSlot < 0 );
+
+  if ( m_iPrefetchDepth == 0 )
+  {
+    if ( !xReadFrame( 0 ) )
+    {
+      return false;
+    }
+    m_iReadSlot = 0;
+  }
+  else
+  {
+    std::unique_lock<std::mutex> cLock( m_cMutex );
+    m_cCond.wait( cLock, [&]{ return m_bEof || !m_aiFilledSlots.empty(); } );
+    if ( m_aiFilledSlots.empty() )
+    {
+      return false;
+    }
+    m_iReadSlot = m_aiFilledSlots.front();
+    m_aiFilledSlots.pop_front();
+  }
+
+  rpcPicYuv        = m_apcPicYuv       [m_iReadSlot];
+  rpcPicYuvTrueOrg = m_apcPicYuvTrueOrg[m_iReadSlot];
+  return true;
+}
+
+Void TVideoIOYuvReader::release()
+{
+  if ( m_iReadSlot < 0 )
+  {
+    return;
+  }
+  if ( m_iPrefetchDepth > 0 )
+  {
+    {
+      std::lock_guard<std::mutex> cLock( m_cMutex );
+      m_aiFreeSlots.push_back( m_iReadSlot );
+    }
+    m_cCond.notify_all();
+  }
+  m_iReadSlot = -1;
+}
@@ -0,0 +1,99 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvReader.h
+    \brief    prefetching YUV file reader class (header)
+*/
+
+#ifndef __TVIDEOIOYUVREADER__
+#define __TVIDEOIOYUVREADER__
+
+#include "TVideoIOYuv.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// YUV file reader reading the next frames of a TVideoIOYuv file ahead on its own thread
+class TVideoIOYuvReader
+{
+private:
+  TVideoIOYuv*               m_pcFile;                      ///< input file, only accessed by the reader thread once started
+  Int                        m_iPrefetchDepth;              ///< number of frames read ahead (0: read in read())
+  std::vector<TComPicYuv*>   m_apcPicYuv;                   ///< [slot] pictures converted to the internal format
+  std::vector<TComPicYuv*>   m_apcPicYuvTrueOrg;            ///< [slot] pictures as read from the file
+  std::deque<Int>            m_aiFreeSlots;                 ///< slots that can be filled
+  std::deque<Int>            m_aiFilledSlots;               ///< slots holding the next frames, in display order
+  Int                        m_iReadSlot;                   ///< slot returned by the last read(), -1 if released
+  Int                        m_iNumFramesLeft;              ///< number of frames still to be read from the file
+  Bool                       m_bEof;                        ///< the reader has reached the end of the file
+  Bool                       m_bStop;                       ///< the reader thread has to stop
+
+  // read parameters
+  UInt                       m_uiSkipFrames;                ///< number of frames skipped after every frame read
+  UInt                       m_uiSkipWidth;
+  UInt                       m_uiSkipHeight;
+  InputColourSpaceConversion m_ipCSC;
+  Int                        m_aiPad[2];
+  ChromaFormat               m_fileFormat;
+  Bool                       m_bClipToRec709;
+
+  std::thread                m_cThread;
+  std::mutex                 m_cMutex;
+  std::condition_variable    m_cCond;
+
+  Bool  xReadFrame( Int iSlot );                            ///< read the next frame into a slot, false at the end
+  Void  xReaderThread();
+
+public:
+  TVideoIOYuvReader();
+  virtual ~TVideoIOYuvReader();
+
+  Void  create  ( TVideoIOYuv* pcFile, Int iPrefetchDepth, Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth );
+  Void  destroy ();
+
+  /// start reading iNumFrames frames, skipping uiSkipFrames frames of size uiSkipWidth x uiSkipHeight after every frame
+  Void  start   ( Int iNumFrames, UInt uiSkipFrames, UInt uiSkipWidth, UInt uiSkipHeight, const InputColourSpaceConversion ipcsc, const Int aiPad[2], ChromaFormat fileFormat, const Bool bClipToRec709 );
+
+  /// get the next frame, false at the end of the file; the pictures stay valid until release()
+  Bool  read    ( TComPicYuv*& rpcPicYuv, TComPicYuv*& rpcPicYuvTrueOrg );
+  Void  release ();                                         ///< give back the pictures of the last read() for prefetching
+};
+
+#endif // __TVIDEOIOYUVREADER__